@@ -17,7 +17,12 @@ static constexpr XMVECTOR KNegativeZAxis{ 0, 0, -1.0f, 0 };
 
 static std::string GetIdentifierString(const SObjectIdentifier& Identifier)
 {
-	return (to_string((size_t)Identifier.Object3D) + Identifier.InstanceName);
+	if (!Identifier.IsInstance()) return to_string((size_t)Identifier.Object3D);
+
+	// @important: name-based and handle-based identifiers of the same instance must share the key
+	SInstanceHandle InstanceHandle{ Identifier.InstanceHandle };
+	if (InstanceHandle.IsNull()) InstanceHandle = Identifier.Object3D->GetInstanceHandle(Identifier.InstanceName);
+	return (to_string((size_t)Identifier.Object3D) + ':' + to_string(InstanceHandle.Slot) + ':' + to_string(InstanceHandle.Generation));
 }
 
 CIntelligence::CIntelligence(ID3D11Device* const PtrDevice, ID3D11DeviceContext* const PtrDeviceContext) :
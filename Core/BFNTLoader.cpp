@@ -13,7 +13,7 @@ CBFNTLoader::~CBFNTLoader()
 void CBFNTLoader::Load(const char* BFNTFileName)
 {
 	CBinaryData BinaryData{};
-	BinaryData.LoadFromFile(BFNTFileName);
+	BinaryData.MapFile(BFNTFileName);
 	
 	BinaryData.ReadSkip(8); // KJW_BFNT
 
@@ -1,14 +1,24 @@
 #include "BinaryData.h"
 #include <fstream>
+#include <Windows.h>
+
+CBinaryData::~CBinaryData()
+{
+	Unmap();
+}
 
 void CBinaryData::Clear()
 {
+	Unmap();
+
 	m_vBytes.clear();
 	m_ReadByteOffset = 0;
 }
 
 bool CBinaryData::LoadFromFile(const std::string FileName)
 {
+	Unmap();
+
 	m_ReadByteOffset = 0;
 
 	std::ifstream ifs{ FileName, std::ios::binary };
@@ -27,6 +37,36 @@ bool CBinaryData::LoadFromFile(const std::string FileName)
 	return false;
 }
 
+bool CBinaryData::MapFile(const std::string& FileName)
+{
+	Clear();
+
+	HANDLE hFile{ CreateFileA(FileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+	if (hFile == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER FileSize{};
+	if (!GetFileSizeEx(hFile, &FileSize) || FileSize.QuadPart == 0)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	// @important: the view keeps the mapping and the file open, so their handles can be closed right away
+	HANDLE hMapping{ CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+	CloseHandle(hFile);
+	if (!hMapping) return false;
+
+	const void* const PtrView{ MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0) };
+	CloseHandle(hMapping);
+	if (!PtrView) return false;
+
+	m_PtrMappedView = PtrView;
+	m_PtrViewBytes = static_cast<const byte*>(PtrView);
+	m_ViewByteCount = (size_t)FileSize.QuadPart;
+	return true;
+}
+
 bool CBinaryData::SaveToFile(const std::string FileName)
 {
 	m_ReadByteOffset = 0;
@@ -42,6 +82,11 @@ bool CBinaryData::SaveToFile(const std::string FileName)
 	return false;
 }
 
+bool CBinaryData::IsReadOnlyView() const
+{
+	return (m_PtrViewBytes != nullptr);
+}
+
 void CBinaryData::WriteBool(bool Value)
 {
 	m_vBytes.emplace_back((Value == true) ? 0xBB : 0x00);
@@ -212,7 +257,7 @@ void CBinaryData::WriteNullTerminatedString(const std::string& String)
 
 bool CBinaryData::ReadSkip(size_t SkippingByteCount)
 {
-	if (m_ReadByteOffset + SkippingByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + SkippingByteCount - 1 >= GetReadByteCount()) return false;
 
 	m_ReadByteOffset += SkippingByteCount;
 	return true;
@@ -225,14 +270,10 @@ bool CBinaryData::ReadByte(byte& Out)
 
 bool CBinaryData::ReadBytes(size_t ByteCount, std::vector<byte>& Out)
 {
-	if (m_ReadByteOffset + ByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + ByteCount - 1 >= GetReadByteCount()) return false;
 
-	Out.clear();
-	Out.reserve(ByteCount);
-	for (size_t iByte = 0; iByte < ByteCount; ++iByte)
-	{
-		Out.emplace_back(m_vBytes[m_ReadByteOffset + iByte]);
-	}
+	const byte* const PtrBytes{ GetReadBytes() + m_ReadByteOffset };
+	Out.assign(PtrBytes, PtrBytes + ByteCount);
 	m_ReadByteOffset += ByteCount;
 
 	return true;
@@ -240,9 +281,9 @@ bool CBinaryData::ReadBytes(size_t ByteCount, std::vector<byte>& Out)
 
 bool CBinaryData::ReadBool(bool& Out)
 {
-	if (m_ReadByteOffset >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset >= GetReadByteCount()) return false;
 
-	Out = (m_vBytes[m_ReadByteOffset] == 0) ? false : true;
+	Out = (GetReadBytes()[m_ReadByteOffset] == 0) ? false : true;
 	m_ReadByteOffset += KBoolByteCount;
 	return true;
 }
@@ -254,9 +295,9 @@ bool CBinaryData::ReadChar(char& Out)
 
 bool CBinaryData::ReadInt8(int8_t& Out)
 {
-	if (m_ReadByteOffset >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KInt8ByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KInt8ByteCount);
 
 	m_ReadByteOffset += KInt8ByteCount;
 	return true;
@@ -264,9 +305,9 @@ bool CBinaryData::ReadInt8(int8_t& Out)
 
 bool CBinaryData::ReadInt16(int16_t& Out)
 {
-	if (m_ReadByteOffset + KInt16ByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KInt16ByteCount - 1 >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KInt16ByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KInt16ByteCount);
 
 	m_ReadByteOffset += KInt16ByteCount;
 	return true;
@@ -274,9 +315,9 @@ bool CBinaryData::ReadInt16(int16_t& Out)
 
 bool CBinaryData::ReadInt32(int32_t& Out)
 {
-	if (m_ReadByteOffset + KInt32ByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KInt32ByteCount - 1 >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KInt32ByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KInt32ByteCount);
 
 	m_ReadByteOffset += KInt32ByteCount;
 	return true;
@@ -284,18 +325,18 @@ bool CBinaryData::ReadInt32(int32_t& Out)
 
 bool CBinaryData::ReadUint8(uint8_t& Out)
 {
-	if (m_ReadByteOffset >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset >= GetReadByteCount()) return false;
 
-	Out = m_vBytes[m_ReadByteOffset];
+	Out = GetReadBytes()[m_ReadByteOffset];
 	m_ReadByteOffset += KUint8ByteCount;
 	return true;
 }
 
 bool CBinaryData::ReadUint16(uint16_t& Out)
 {
-	if (m_ReadByteOffset + KUint16ByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KUint16ByteCount - 1 >= GetReadByteCount()) return false;
 	
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KUint16ByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KUint16ByteCount);
 	
 	m_ReadByteOffset += KUint16ByteCount;
 	return true;
@@ -303,9 +344,9 @@ bool CBinaryData::ReadUint16(uint16_t& Out)
 
 bool CBinaryData::ReadUint32(uint32_t& Out)
 {
-	if (m_ReadByteOffset + KUint32ByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KUint32ByteCount - 1 >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KUint32ByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KUint32ByteCount);
 
 	m_ReadByteOffset += KUint32ByteCount;
 	return true;
@@ -313,9 +354,9 @@ bool CBinaryData::ReadUint32(uint32_t& Out)
 
 bool CBinaryData::ReadFloat(float& Out)
 {
-	if (m_ReadByteOffset + KFloatByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KFloatByteCount - 1 >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KFloatByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KFloatByteCount);
 
 	m_ReadByteOffset += KFloatByteCount;
 	return true;
@@ -323,9 +364,9 @@ bool CBinaryData::ReadFloat(float& Out)
 
 bool CBinaryData::ReadXMFLOAT2(XMFLOAT2& Out)
 {
-	if (m_ReadByteOffset + KXMFLOAT2ByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KXMFLOAT2ByteCount - 1 >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KXMFLOAT2ByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KXMFLOAT2ByteCount);
 
 	m_ReadByteOffset += KXMFLOAT2ByteCount;
 	return true;
@@ -333,9 +374,9 @@ bool CBinaryData::ReadXMFLOAT2(XMFLOAT2& Out)
 
 bool CBinaryData::ReadXMFLOAT3(XMFLOAT3& Out)
 {
-	if (m_ReadByteOffset + KXMFLOAT3ByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KXMFLOAT3ByteCount - 1 >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KXMFLOAT3ByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KXMFLOAT3ByteCount);
 
 	m_ReadByteOffset += KXMFLOAT3ByteCount;
 	return true;
@@ -343,9 +384,9 @@ bool CBinaryData::ReadXMFLOAT3(XMFLOAT3& Out)
 
 bool CBinaryData::ReadXMFLOAT4(XMFLOAT4& Out)
 {
-	if (m_ReadByteOffset + KXMFLOAT4ByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KXMFLOAT4ByteCount - 1 >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KXMFLOAT4ByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KXMFLOAT4ByteCount);
 
 	m_ReadByteOffset += KXMFLOAT4ByteCount;
 	return true;
@@ -353,9 +394,9 @@ bool CBinaryData::ReadXMFLOAT4(XMFLOAT4& Out)
 
 bool CBinaryData::ReadXMVECTOR(XMVECTOR& Out)
 {
-	if (m_ReadByteOffset + KXMVECTORByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KXMVECTORByteCount - 1 >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KXMVECTORByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KXMVECTORByteCount);
 
 	m_ReadByteOffset += KXMVECTORByteCount;
 	return true;
@@ -363,9 +404,9 @@ bool CBinaryData::ReadXMVECTOR(XMVECTOR& Out)
 
 bool CBinaryData::ReadXMMATRIX(XMMATRIX& Out)
 {
-	if (m_ReadByteOffset + KXMMATRIXByteCount - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + KXMMATRIXByteCount - 1 >= GetReadByteCount()) return false;
 
-	memcpy(&Out, &m_vBytes[m_ReadByteOffset], KXMMATRIXByteCount);
+	memcpy(&Out, GetReadBytes() + m_ReadByteOffset, KXMMATRIXByteCount);
 
 	m_ReadByteOffset += KXMMATRIXByteCount;
 	return true;
@@ -379,14 +420,9 @@ bool CBinaryData::ReadString(std::string& Out, uint32_t Length)
 		Out.clear();
 		return false;
 	}
-	if (m_ReadByteOffset + Length - 1 >= m_vBytes.size()) return false;
+	if (m_ReadByteOffset + Length - 1 >= GetReadByteCount()) return false;
 
-	Out.clear();
-	Out.reserve(Length);
-	for (uint32_t iPosition = 0; iPosition < Length; ++iPosition)
-	{
-		Out += m_vBytes[m_ReadByteOffset + iPosition];
-	}
+	Out.assign(reinterpret_cast<const char*>(GetReadBytes() + m_ReadByteOffset), Length);
 
 	m_ReadByteOffset += Length;
 	return true;
@@ -414,9 +450,9 @@ bool CBinaryData::ReadNullTerminatedString(std::string& Out)
 	size_t At{};
 	while (true)
 	{
-		if (m_vBytes[m_ReadByteOffset + At] == '\0') break;
+		if (GetReadBytes()[m_ReadByteOffset + At] == '\0') break;
 
-		Out += m_vBytes[m_ReadByteOffset + At];
+		Out += GetReadBytes()[m_ReadByteOffset + At];
 
 		++At;
 	}
@@ -426,6 +462,15 @@ bool CBinaryData::ReadNullTerminatedString(std::string& Out)
 	return true;
 }
 
+bool CBinaryData::ReadSpan(size_t ByteCount, const byte*& OutPtrBytes)
+{
+	if (!CanRead(ByteCount)) return false;
+
+	OutPtrBytes = GetReadBytes() + m_ReadByteOffset;
+	m_ReadByteOffset += ByteCount;
+	return true;
+}
+
 byte CBinaryData::ReadByte()
 {
 	return ReadUint8();
@@ -503,5 +548,30 @@ void CBinaryData::AppendBytes(const std::vector<byte>& SrcBytes)
 
 const std::vector<byte> CBinaryData::GetBytes() const
 {
+	if (IsReadOnlyView()) return std::vector<byte>(m_PtrViewBytes, m_PtrViewBytes + m_ViewByteCount);
 	return m_vBytes;
 }
+
+void CBinaryData::Unmap()
+{
+	if (m_PtrMappedView) UnmapViewOfFile(m_PtrMappedView);
+
+	m_PtrMappedView = nullptr;
+	m_PtrViewBytes = nullptr;
+	m_ViewByteCount = 0;
+}
+
+bool CBinaryData::CanRead(size_t ByteCount) const
+{
+	return (m_ReadByteOffset <= GetReadByteCount() && ByteCount <= GetReadByteCount() - m_ReadByteOffset);
+}
+
+const byte* CBinaryData::GetReadBytes() const
+{
+	return (m_PtrViewBytes) ? m_PtrViewBytes : m_vBytes.data();
+}
+
+size_t CBinaryData::GetReadByteCount() const
+{
+	return (m_PtrViewBytes) ? m_ViewByteCount : m_vBytes.size();
+}
@@ -1,18 +1,28 @@
 #pragma once
 
 #include "SharedHeader.h"
+#include <type_traits>
 
+// Bytes to write or read
+// It either owns its bytes, or is a read-only view (of a memory-mapped file or of external bytes) that is parsed in place.
 class CBinaryData
 {
 public:
 	CBinaryData() {}
 	CBinaryData(const std::vector<byte>& vBytes) : m_vBytes{ vBytes } {}
-	~CBinaryData() {}
+	// Read-only view, the bytes must outlive this
+	CBinaryData(const byte* const PtrBytes, size_t ByteCount) : m_PtrViewBytes{ PtrBytes }, m_ViewByteCount{ ByteCount } {}
+	CBinaryData(const CBinaryData& b) = delete;
+	~CBinaryData();
 
 public:
 	void Clear();
 	bool LoadFromFile(const std::string FileName);
+	// Maps the file into memory as a read-only view, instead of copying it into the owned bytes
+	// @important: Write*() must not be called until Clear()
+	bool MapFile(const std::string& FileName);
 	bool SaveToFile(const std::string FileName);
+	bool IsReadOnlyView() const;
 
 public:
 	void WriteBool(bool Value);
@@ -34,6 +44,15 @@ public:
 	// @important: string length is written in <uint32_t>
 	void WriteStringWithPrefixedLength(const std::string& String);
 	void WriteNullTerminatedString(const std::string& String);
+	// Writes the in-memory layout of the elements as one contiguous block (no count is written)
+	template <typename T>
+	void WriteArray(const T* const PtrElements, size_t Count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+		const byte* const PtrBytes{ reinterpret_cast<const byte*>(PtrElements) };
+		m_vBytes.insert(m_vBytes.end(), PtrBytes, PtrBytes + sizeof(T) * Count);
+	}
 
 public:
 	bool ReadSkip(size_t SkippingByteCount);
@@ -57,6 +76,36 @@ public:
 	bool ReadStringWithPrefixedLength(std::string& OutString);
 	bool ReadStringWithPrefixedLength(uint32_t& OutLength, std::string& OutString);
 	bool ReadNullTerminatedString(std::string& Out);
+	// Reads a block written by WriteArray() with a single copy
+	template <typename T>
+	bool ReadArray(T* const OutPtrElements, size_t Count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+		const size_t KByteCount{ sizeof(T) * Count };
+		if (!CanRead(KByteCount)) return false;
+		if (KByteCount) memcpy(OutPtrElements, GetReadBytes() + m_ReadByteOffset, KByteCount);
+
+		m_ReadByteOffset += KByteCount;
+		return true;
+	}
+
+// @important: zero-copy reads, OutPtr stays valid until the data is modified or cleared
+	bool ReadSpan(size_t ByteCount, const byte*& OutPtrBytes);
+	// Fails if the bytes are not aligned for T, then the caller should copy them instead
+	template <typename T>
+	bool ReadSpan(size_t Count, const T*& OutPtr)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+		if (!CanRead(sizeof(T) * Count)) return false;
+		const byte* const PtrBytes{ GetReadBytes() + m_ReadByteOffset };
+		if ((uintptr_t)PtrBytes % alignof(T)) return false;
+
+		OutPtr = reinterpret_cast<const T*>(PtrBytes);
+		m_ReadByteOffset += sizeof(T) * Count;
+		return true;
+	}
 
 // @important: below are for more convenient reading of built-in types, though less safer
 	byte ReadByte();
@@ -74,6 +123,12 @@ public:
 	void AppendBytes(const std::vector<byte>& SrcBytes);
 	const std::vector<byte> GetBytes() const;
 
+private:
+	void Unmap();
+	bool CanRead(size_t ByteCount) const;
+	const byte* GetReadBytes() const;
+	size_t GetReadByteCount() const;
+
 private:
 	static constexpr size_t KBoolByteCount{ 1 };
 	static constexpr size_t KInt8ByteCount{ 1 };
@@ -92,4 +147,10 @@ private:
 private:
 	std::vector<byte>	m_vBytes{};
 	size_t				m_ReadByteOffset{};
+
+// Read-only view
+private:
+	const byte*			m_PtrViewBytes{};
+	size_t				m_ViewByteCount{};
+	const void*			m_PtrMappedView{}; // only when a file is mapped
 };
\ No newline at end of file
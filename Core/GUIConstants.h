@@ -202,6 +202,8 @@ static const char* KGUIString_Content[][2]
 	{ "Ambient light intensity",				u8"ںƮ Ʈ "				},
 	{ "Exposure (HDR)",							u8" (HDR)"							},
 	{ "Frames per second (FPS)",				u8"ʴ  (FPS)"					},
+	{ "Instance upload (bytes/frame)",			u8"νϽ ε (Ʈ/)"		},
+	{ "Skipped animation evaluations",			u8" ִϸ̼ "				},
 	{ "Editor flags",							u8" ÷"						},
 	{ "Wire frame",								u8"̾ "						},
 	{ "Draw normals",							u8" ǥ"							},
@@ -586,6 +588,8 @@ enum class EGUIString_Content
 	AmbientLightIntensity,
 	Exposure_HDR,
 	FramesPerSecond_FPS,
+	InstanceUpload_BytesPerFrame,
+	AnimationLOD_SkippedEvaluationsPerFrame,
 	EditorFlags,
 	WireFrame,
 	DrawNormals,
@@ -35,6 +35,8 @@ void CGame::CreateWin32(WNDPROC const WndProc, const std::string& WindowName, bo
 
 	InitializeGameData();
 
+	ShouldUseParallelAnimationUpdate(true);
+
 	InitializeEditorAssets(bCreateEditor);
 	if (bCreateEditor) InitializeImGui("Asset\\D2Coding.ttc", 15.0f);
 	
@@ -53,6 +55,8 @@ void CGame::Destroy()
 		ImGui::DestroyContext();
 	}
 
+	m_AnimationWorkerPool.Destroy();
+
 	DestroyWindow(m_hWnd);
 	
 	m_bIsDestroyed = true;
@@ -1106,7 +1110,7 @@ void CGame::LoadScene(const std::string& FileName, const std::string& SceneConte
 			eObjectRole = (EObjectRole)SceneBinaryData.ReadUint8();
 
 			{
-				Object3DBinary.LoadFromFile(ReadString);
+				Object3DBinary.MapFile(ReadString);
 				Object3DBinary.ReadSkip(8 + 4); // @important: Signature + Version
 				Object3DBinary.ReadStringWithPrefixedLength(Object3DName);
 			}
@@ -1123,12 +1127,12 @@ void CGame::LoadScene(const std::string& FileName, const std::string& SceneConte
 				bool bIsInstanced{ SceneBinaryData.ReadBool() };
 				if (bIsInstanced)
 				{
-					for (const auto& InstanceCPUData : Object3D->GetInstanceCPUDataVector())
+					for (size_t iInstance = 0; iInstance < Object3D->GetInstanceCount(); ++iInstance)
 					{
 						bool bHasPattern{ SceneBinaryData.ReadBool() };
 						if (bHasPattern)
 						{
-							SObjectIdentifier Identifier{ Object3D, InstanceCPUData.Name };
+							SObjectIdentifier Identifier{ Object3D, Object3D->GetInstanceHandle(iInstance) };
 
 							SceneBinaryData.ReadStringWithPrefixedLength(ReadString);
 							m_Intelligence->RegisterPattern(Identifier, GetPattern(ReadString));
@@ -1374,9 +1378,9 @@ void CGame::SaveScene(const string& FileName, const std::string& SceneContentDir
 					SceneBinaryData.WriteBool(Object3D->IsInstanced());
 					if (Object3D->IsInstanced())
 					{
-						for (const auto& InstanceCPUData : Object3D->GetInstanceCPUDataVector())
+						for (size_t iInstance = 0; iInstance < Object3D->GetInstanceCount(); ++iInstance)
 						{
-							SObjectIdentifier Identifier{ Object3D.get(), InstanceCPUData.Name };
+							SObjectIdentifier Identifier{ Object3D.get(), Object3D->GetInstanceHandle(iInstance) };
 
 							bool bHasPattern{ m_Intelligence->HasPattern(Identifier) };
 							SceneBinaryData.WriteBool(bHasPattern);
@@ -1537,6 +1541,30 @@ CGame::EFlagsRendering CGame::GetRenderingFlags() const
 	return m_eFlagsRendering;
 }
 
+void CGame::SetAnimationLODData(const SAnimationLODData& Data)
+{
+	m_AnimationLODData = Data;
+}
+
+const CGame::SAnimationLODData& CGame::GetAnimationLODData() const
+{
+	return m_AnimationLODData;
+}
+
+void CGame::ShouldUseParallelAnimationUpdate(bool Value, size_t WorkerCount)
+{
+	m_bShouldUseParallelAnimationUpdate = Value;
+
+	if (m_bShouldUseParallelAnimationUpdate)
+	{
+		m_AnimationWorkerPool.Create(WorkerCount);
+	}
+	else
+	{
+		m_AnimationWorkerPool.Destroy();
+	}
+}
+
 void CGame::SetUniversalRSState()
 {
 	switch (m_eRasterizerState)
@@ -1848,6 +1876,7 @@ void CGame::CreateTerrain(const XMFLOAT2& TerrainSize, uint32_t MaskingDetail, f
 	m_Terrain->Create(TerrainSize, *m_TerrainMaterialDefault, MaskingDetail, UniformScaling);
 	UpdateCBTerrainData(m_Terrain->GetTerrainData());
 	UpdateCBTerrainMaskingSpace(m_Terrain->GetMaskingSpaceData());
+	m_PhysicsEngine.SetTerrain(m_Terrain->GetTerrainFileData());
 	
 	ID3D11ShaderResourceView* NullSRVs[20]{};
 	m_DeviceContext->DSSetShaderResources(0, 1, NullSRVs);
@@ -1859,6 +1888,7 @@ void CGame::LoadTerrain(const string& TerrainFileName)
 	if (TerrainFileName.empty())
 	{
 		m_Terrain.release();
+		m_PhysicsEngine.ClearTerrain();
 		return;
 	}
 
@@ -1866,6 +1896,7 @@ void CGame::LoadTerrain(const string& TerrainFileName)
 	m_Terrain->Load(TerrainFileName);
 	UpdateCBTerrainData(m_Terrain->GetTerrainData());
 	UpdateCBTerrainMaskingSpace(m_Terrain->GetMaskingSpaceData());
+	m_PhysicsEngine.SetTerrain(m_Terrain->GetTerrainFileData());
 }
 
 void CGame::SaveTerrain(const string& TerrainFileName)
@@ -3436,19 +3467,31 @@ void CGame::PickBoundingSphere(ESelectionMode eSelectionMode)
 	}
 	if (bIsSelectionAdded) return;
 
-	// Pick Light
+	// Pick Light (4 instances at a time)
 	for (const auto& Light : m_LightArray)
 	{
 		CLight::EType eType{ Light->GetType() };
-		for (const auto& LightPair : Light->GetInstanceNameToIndexMap())
-		{
-			const auto& Instance{ Light->GetInstanceGPUData(LightPair.first) };
+		const auto& mapInstanceNameToIndex{ Light->GetInstanceNameToIndexMap() };
+		auto iterLightPair{ mapInstanceNameToIndex.begin() };
+		while (iterLightPair != mapInstanceNameToIndex.end())
+		{
+			SSpherePack4 Pack{};
+			const std::string* LaneInstanceNames[SSpherePack4::KLaneCount]{};
+			uint32_t LaneCount{};
+			for (; iterLightPair != mapInstanceNameToIndex.end() && LaneCount < SSpherePack4::KLaneCount; ++iterLightPair, ++LaneCount)
+			{
+				LaneInstanceNames[LaneCount] = &iterLightPair->first;
+				SetSpherePackLane(Pack, LaneCount, Light->GetInstanceGPUData(iterLightPair->first).Position, Light->GetBoundingSphereRadius());
+			}
 
-			XMVECTOR NewT{ KVectorGreatest };
-			if (IntersectRaySphere(m_PickingRayWorldSpaceOrigin, m_PickingRayWorldSpaceDirection,
-				Light->GetBoundingSphereRadius(), Instance.Position, &NewT))
+			uint32_t HitMask{ IntersectRaySpheres4(m_PickingRayWorldSpaceOrigin, m_PickingRayWorldSpaceDirection, Pack, nullptr) & GetLaneMask(LaneCount) };
+			if (HitMask)
 			{
-				SelectObject(SSelectionData(EObjectType::Light, LightPair.first, (uint32_t)eType), eSelectionMode);
+				// @important: the first instance in order is selected
+				uint32_t iLane{};
+				while ((HitMask & (1u << iLane)) == 0) ++iLane;
+
+				SelectObject(SSelectionData(EObjectType::Light, *LaneInstanceNames[iLane], (uint32_t)eType), eSelectionMode);
 				bIsSelectionAdded = true;
 				break;
 			}
@@ -3464,14 +3507,28 @@ void CGame::PickBoundingSphere(ESelectionMode eSelectionMode)
 		{
 			if (Object3D->IsInstanced())
 			{
-				for (const auto& InstanceCPUData : Object3D->GetInstanceCPUDataVector())
+				// 4 instances at a time
+				const auto& vInstanceCPUData{ Object3D->GetInstanceCPUDataVector() };
+				for (size_t iFirst = 0; iFirst < vInstanceCPUData.size(); iFirst += SSpherePack4::KLaneCount)
 				{
-					XMVECTOR NewT{ KVectorGreatest };
-					if (IntersectRaySphere(m_PickingRayWorldSpaceOrigin, m_PickingRayWorldSpaceDirection,
-						InstanceCPUData.EditorBoundingSphere.Data.BS.Radius, 
-						InstanceCPUData.Transform.Translation + InstanceCPUData.EditorBoundingSphere.Center, &NewT))
+					uint32_t LaneCount{ (uint32_t)min(vInstanceCPUData.size() - iFirst, (size_t)SSpherePack4::KLaneCount) };
+
+					SSpherePack4 Pack{};
+					for (uint32_t iLane = 0; iLane < LaneCount; ++iLane)
 					{
-						m_vObject3DPickingCandidates.emplace_back(Object3D.get(), InstanceCPUData.Name, NewT);
+						const auto& InstanceCPUData{ vInstanceCPUData[iFirst + iLane] };
+						SetSpherePackLane(Pack, iLane, InstanceCPUData.Transform.Translation + InstanceCPUData.EditorBoundingSphere.Center,
+							InstanceCPUData.EditorBoundingSphere.Data.BS.Radius);
+					}
+
+					XMVECTOR NewTs{ KVectorGreatest };
+					uint32_t HitMask{ IntersectRaySpheres4(m_PickingRayWorldSpaceOrigin, m_PickingRayWorldSpaceDirection, Pack, &NewTs) & GetLaneMask(LaneCount) };
+					for (uint32_t iLane = 0; iLane < LaneCount; ++iLane)
+					{
+						if ((HitMask & (1u << iLane)) == 0) continue;
+
+						m_vObject3DPickingCandidates.emplace_back(Object3D.get(), vInstanceCPUData[iFirst + iLane].Name,
+							XMVectorReplicate(XMVectorGetByIndex(NewTs, iLane)));
 					}
 				}
 			}
@@ -3510,36 +3567,26 @@ bool CGame::PickObject3DTriangle(ESelectionMode eSelectionMode)
 			{
 				WorldMatrix = Candidate.PtrObject3D->GetInstanceWorldMatrix(Candidate.InstanceName);
 			}
-			for (const SMesh& Mesh : Candidate.PtrObject3D->GetModel().vMeshes)
+
+			// @important: the ray is transformed into model space and traverses the triangle BVHs,
+			// so only the picked triangle is transformed to world space
+			XMVECTOR NewT{};
+			XMVECTOR TriangleVertices[3]{};
+			if (Candidate.PtrObject3D->RayCastTriangles(WorldMatrix,
+				m_PickingRayWorldSpaceOrigin, m_PickingRayWorldSpaceDirection, &NewT, TriangleVertices))
 			{
-				for (const STriangle& Triangle : Mesh.vTriangles)
+				if (XMVector3Less(NewT, T))
 				{
-					XMVECTOR V0{ Mesh.vVertices[Triangle.I0].Position };
-					XMVECTOR V1{ Mesh.vVertices[Triangle.I1].Position };
-					XMVECTOR V2{ Mesh.vVertices[Triangle.I2].Position };
-					V0 = XMVector3TransformCoord(V0, WorldMatrix);
-					V1 = XMVector3TransformCoord(V1, WorldMatrix);
-					V2 = XMVector3TransformCoord(V2, WorldMatrix);
-
-					XMVECTOR NewT{};
-					if (IntersectRayTriangle(m_PickingRayWorldSpaceOrigin, m_PickingRayWorldSpaceDirection, V0, V1, V2, &NewT))
-					{
-						if (XMVector3Less(NewT, T))
-						{
-							T = NewT;
+					T = NewT;
 
-							Candidate.bHasFailedPickingTest = false;
-							Candidate.T = NewT;
+					Candidate.bHasFailedPickingTest = false;
+					Candidate.T = NewT;
 
-							XMVECTOR N{ CalculateTriangleNormal(V0, V1, V2) };
+					XMVECTOR N{ CalculateTriangleNormal(TriangleVertices[0], TriangleVertices[1], TriangleVertices[2]) };
 
-							m_PickedTriangleV0 = V0 + N * 0.01f;
-							m_PickedTriangleV1 = V1 + N * 0.01f;
-							m_PickedTriangleV2 = V2 + N * 0.01f;
-
-							continue;
-						}
-					}
+					m_PickedTriangleV0 = TriangleVertices[0] + N * 0.01f;
+					m_PickedTriangleV1 = TriangleVertices[1] + N * 0.01f;
+					m_PickedTriangleV2 = TriangleVertices[2] + N * 0.01f;
 				}
 			}
 		}
@@ -3635,6 +3682,16 @@ void CGame::SelectTerrain(bool bShouldEdit, bool bIsLeftButton)
 	CastPickingRay();
 
 	m_Terrain->Select(m_PickingRayWorldSpaceOrigin, m_PickingRayWorldSpaceDirection, bShouldEdit, bIsLeftButton);
+
+	if (bShouldEdit)
+	{
+		CTerrain::EEditMode eEditMode{ m_Terrain->GetEditMode() };
+		if (eEditMode != CTerrain::EEditMode::Masking && eEditMode != CTerrain::EEditMode::FoliagePlacing)
+		{
+			// @important: heights have been changed
+			m_PhysicsEngine.SetTerrain(m_Terrain->GetTerrainFileData());
+		}
+	}
 }
 
 bool CGame::IsInsideSelectionRegion(const XMFLOAT2& ProjectionSpacePosition)
@@ -4050,6 +4107,15 @@ void CGame::Update()
 
 	m_TimePrev_ms = m_TimeNow_ms;
 	++m_FrameCounter;
+
+	// Instance buffer uploads (per frame)
+	m_InstanceUploadedByteCountPerFrame = 0;
+	for (auto& Object3D : m_vObject3Ds)
+	{
+		m_InstanceUploadedByteCountPerFrame += Object3D->GetInstanceUploadStatistics().UploadedByteCount;
+		Object3D->ResetInstanceUploadStatistics();
+	}
+	if (m_Terrain) m_InstanceUploadedByteCountPerFrame += m_Terrain->ConsumeFoliageInstanceUploadedByteCount();
 	
 	// In [Test] or [Play] mode
 	if (GetMode() != EMode::Edit)
@@ -4075,9 +4141,10 @@ void CGame::Update()
 				XMVECTOR Offset{ X, Y, Z, 0 };
 
 				Object3D->InsertInstance();
-				Object3D->TranslateInstanceTo(Object3D->GetLastInstanceName(), Object3D->GetTransform().Translation + Offset);
+				SInstanceHandle InstanceHandle{ Object3D->GetLastInstanceHandle() };
+				Object3D->TranslateInstanceTo(InstanceHandle, Object3D->GetTransform().Translation + Offset);
 
-				m_Intelligence->RegisterPattern(SObjectIdentifier(Object3D, Object3D->GetLastInstanceName()), Pattern);
+				m_Intelligence->RegisterPattern(SObjectIdentifier(Object3D, InstanceHandle), Pattern);
 			}
 		}
 
@@ -4094,6 +4161,9 @@ void CGame::Update()
 			m_PhysicsEngine.Update(m_DeltaTime_s);
 		}
 	}
+
+	// Animation (after everything that may change animations or transforms, before any drawing)
+	UpdateAnimations();
 }
 
 void CGame::Draw()
@@ -4368,8 +4438,16 @@ void CGame::Draw()
 		for (auto& Object3D : m_vObject3Ds)
 		{
 			if (!Object3D->IsTransparent()) continue;
+			if (Object3D->IsRigged())
+			{
+				UpdateCBAnimationData(Object3D->GetAnimationData());
+
+				if (!Object3D->HasBakedAnimationTexture())
+				{
+					UpdateCBAnimationBoneMatrices(Object3D->GetAnimationBoneMatrices());
+				}
+			}
 
-			Object3D->Animate(m_DeltaTime_s);
 			Object3D->UpdateWorldMatrix();
 			DrawObject3D(Object3D.get());
 
@@ -4444,6 +4522,113 @@ void CGame::Draw()
 	}
 }
 
+void CGame::UpdateAnimations()
+{
+	// @important: before evaluating the poses of this frame
+	UpdateAnimationLOD();
+
+	m_vAnimatedObject3Ds.clear();
+	for (auto& Object3D : m_vObject3Ds)
+	{
+		if (!Object3D->IsRigged() || !Object3D->HasAnimations()) continue;
+
+		m_vAnimatedObject3Ds.emplace_back(Object3D.get());
+	}
+
+	// Ticks & poses are per object, so objects are independent of each other here
+	if (m_bShouldUseParallelAnimationUpdate && m_AnimationWorkerPool.IsCreated() &&
+		m_vAnimatedObject3Ds.size() >= KParallelAnimationUpdateMinObjectCount)
+	{
+		m_AnimationWorkerPool.ParallelFor(m_vAnimatedObject3Ds.size(), KParallelAnimationUpdateGrainSize, UpdateAnimationsJob, this);
+	}
+	else
+	{
+		UpdateAnimationsJob(this, 0, m_vAnimatedObject3Ds.size(), 0);
+	}
+
+	// @important: the device context is not thread-safe, so uploads stay on this thread
+	for (CObject3D* const Object3D : m_vAnimatedObject3Ds)
+	{
+		if (Object3D->IsInstanced()) Object3D->UpdateInstanceBuffers();
+	}
+}
+
+void CGame::UpdateAnimationsJob(void* Context, size_t Begin, size_t End, size_t WorkerIndex)
+{
+	CGame* const Game{ static_cast<CGame*>(Context) };
+	for (size_t iObject3D = Begin; iObject3D < End; ++iObject3D)
+	{
+		Game->m_vAnimatedObject3Ds[iObject3D]->Animate(Game->m_DeltaTime_s);
+	}
+}
+
+void CGame::UpdateAnimationLOD()
+{
+	m_AnimationEvaluationSkippedCountPerFrame = 0;
+	for (auto& Object3D : m_vObject3Ds)
+	{
+		// Baked animations are evaluated on GPU
+		if (!Object3D->IsRigged() || !Object3D->HasAnimations() || Object3D->HasBakedAnimationTexture()) continue;
+
+		Object3D->UpdateAnimationLOD((m_AnimationLODData.bIsEnabled) ? GetAnimationLODFrameInterval(Object3D.get()) : 1);
+		if (!Object3D->ShouldEvaluateAnimationPose()) ++m_AnimationEvaluationSkippedCountPerFrame;
+	}
+}
+
+uint32_t CGame::GetAnimationLODFrameInterval(const CObject3D* const Object3D) const
+{
+	// The nearest visible instance decides
+	const XMVECTOR KEyePosition{ m_PtrCurrentCamera->GetEyePosition() };
+	bool bIsVisible{ false };
+	float MinDistance{ FLT_MAX };
+	if (Object3D->IsInstanced())
+	{
+		for (const auto& Instance : Object3D->GetInstanceCPUDataVector())
+		{
+			const XMVECTOR KCenter{ Instance.Transform.Translation + Instance.EditorBoundingSphere.Center };
+			if (!IsSphereInViewFrustum(KCenter, Instance.EditorBoundingSphere.Data.BS.Radius)) continue;
+
+			bIsVisible = true;
+			MinDistance = min(MinDistance, XMVectorGetX(XMVector3Length(KCenter - KEyePosition)));
+		}
+	}
+	else
+	{
+		const XMVECTOR KCenter{ Object3D->GetTransform().Translation + Object3D->GetOuterBoundingSphereCenterOffset() };
+		if (IsSphereInViewFrustum(KCenter, Object3D->GetOuterBoundingSphereRadius()))
+		{
+			bIsVisible = true;
+			MinDistance = XMVectorGetX(XMVector3Length(KCenter - KEyePosition));
+		}
+	}
+
+	if (!bIsVisible) return max(m_AnimationLODData.OffScreenFrameInterval, (uint32_t)1);
+
+	uint32_t FrameInterval{ 1 };
+	for (size_t iBand = 0; iBand < SAnimationLODData::KBandCount; ++iBand)
+	{
+		if (MinDistance < m_AnimationLODData.BandDistances[iBand]) break;
+		FrameInterval *= 2;
+	}
+	return FrameInterval;
+}
+
+bool CGame::IsSphereInViewFrustum(const XMVECTOR& Center, float Radius) const
+{
+	const XMVECTOR KViewCenter{ XMVector3TransformCoord(Center, m_MatrixView) };
+	const float KX{ XMVectorGetX(KViewCenter) };
+	const float KY{ XMVectorGetY(KViewCenter) };
+	const float KZ{ XMVectorGetZ(KViewCenter) };
+	if (KZ + Radius < m_NearZ || KZ - Radius > m_FarZ) return false;
+
+	// Side planes of the perspective projection: |X| * ScaleX = Z, |Y| * ScaleY = Z
+	const float KScaleX{ XMVectorGetX(m_MatrixProjection.r[0]) };
+	const float KScaleY{ XMVectorGetY(m_MatrixProjection.r[1]) };
+	if (fabs(KX) * KScaleX - KZ > Radius * sqrt(KScaleX * KScaleX + 1.0f)) return false;
+	if (fabs(KY) * KScaleY - KZ > Radius * sqrt(KScaleY * KScaleY + 1.0f)) return false;
+	return true;
+}
+
 void CGame::DrawOpaqueObject3Ds(bool bIgnoreOwnTexture, bool bUseVoidPS)
 {
 	// Opaque Object3Ds
@@ -4458,8 +4643,6 @@ void CGame::DrawOpaqueObject3Ds(bool bIgnoreOwnTexture, bool bUseVoidPS)
 			{
 				UpdateCBAnimationBoneMatrices(Object3D->GetAnimationBoneMatrices());
 			}
-
-			Object3D->Animate(m_DeltaTime_s);
 		}
 
 		// For MonsterSpawner,
@@ -5065,6 +5248,16 @@ void CGame::DrawEditorGUI()
 				ImGui::Text(GUI_STRING_CONTENT(EGUIString_Content::FramesPerSecond_FPS));
 				ImGui::SameLine(KLabelWidth);
 				ImGui::Text(to_string(m_FPS).c_str());
+
+				ImGui::AlignTextToFramePadding();
+				ImGui::Text(GUI_STRING_CONTENT(EGUIString_Content::InstanceUpload_BytesPerFrame));
+				ImGui::SameLine(KLabelWidth);
+				ImGui::Text(to_string(m_InstanceUploadedByteCountPerFrame).c_str());
+
+				ImGui::AlignTextToFramePadding();
+				ImGui::Text(GUI_STRING_CONTENT(EGUIString_Content::AnimationLOD_SkippedEvaluationsPerFrame));
+				ImGui::SameLine(KLabelWidth);
+				ImGui::Text(to_string(m_AnimationEvaluationSkippedCountPerFrame).c_str());
 			}
 
 
@@ -8908,7 +9101,6 @@ void CGame::EndRendering()
 
 					if (Object3D->IsRigged())
 					{
-						Object3D->Animate(0);
 						UpdateCBAnimationBoneMatrices(Object3D->GetAnimationBoneMatrices());
 						UpdateCBAnimationData(Object3D->GetAnimationData());
 					}
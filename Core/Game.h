@@ -22,6 +22,7 @@
 #include "BFNTBaker.h"
 #include "BFNTRenderer.h"
 #include "DynamicPool.h"
+#include "WorkerPool.h"
 #include "../Model/Object3D.h"
 #include "../Model/Object3DLine.h"
 #include "../Model/Object2D.h"
@@ -238,6 +239,17 @@ public:
 		SSkyObjectData	Cloud{};
 	};
 
+	// Bone matrices of rigged objects (CPU skinning) are evaluated every 1, 2, 4 or 8 frames
+	// depending on the distance band of their nearest instance, and every OffScreenFrameInterval frames when off-screen
+	struct SAnimationLODData
+	{
+		static constexpr size_t KBandCount{ 3 };
+
+		bool		bIsEnabled{ true };
+		float		BandDistances[KBandCount]{ 30.0f, 60.0f, 120.0f }; // ascending, the last band extends to infinity
+		uint32_t	OffScreenFrameInterval{ 8 };
+	};
+
 	struct SEditorGUIBools
 	{
 		bool bShowWindowPropertyEditor{ true };
@@ -420,6 +432,10 @@ public:
 	EFlagsRendering GetRenderingFlags() const;
 	void SetUniversalRSState();
 	CommonStates* GetCommonStates() const { return m_CommonStates.get(); }
+	void SetAnimationLODData(const SAnimationLODData& Data);
+	const SAnimationLODData& GetAnimationLODData() const;
+	// WorkerCount == 0 means (hardware concurrency - 1)
+	void ShouldUseParallelAnimationUpdate(bool Value, size_t WorkerCount = 0);
 
 private:
 	void UpdateCBSpace(const XMMATRIX& World = KMatrixIdentity);
@@ -606,6 +622,12 @@ public:
 	auto GetDeltaTime() const->float;
 
 private:
+	// @important: advances every animated object once per frame, Draw() only consumes the results
+	void UpdateAnimations();
+	static void UpdateAnimationsJob(void* Context, size_t Begin, size_t End, size_t WorkerIndex);
+	void UpdateAnimationLOD();
+	uint32_t GetAnimationLODFrameInterval(const CObject3D* const Object3D) const;
+	bool IsSphereInViewFrustum(const XMVECTOR& Center, float Radius) const;
 	void DrawOpaqueObject3Ds(bool bIgnoreOwnTexture = false, bool bUseVoidPS = false);
 	void DrawObject3D(CObject3D* const PtrObject3D,
 		EFlagsObject3DRendering eFlagsRendering = EFlagsObject3DRendering::None, size_t OneInstanceIndex = 0);
@@ -702,6 +724,8 @@ private:
 	static constexpr int KEditorCameraID{ -999 };
 	static constexpr float KEditorCameraDefaultMovementFactor{ 3.0f };
 	static constexpr size_t KInvalidIndex{ SIZE_T_MAX };
+	static constexpr size_t KParallelAnimationUpdateGrainSize{ 1 }; // an object is already a coarse job
+	static constexpr size_t KParallelAnimationUpdateMinObjectCount{ 2 };
 
 	static constexpr char KTextureDialogFilter[45]{ "JPG \0*.jpg\0PNG \0*.png\0 \0*.*\0" };
 	static constexpr char KTextureDialogTitle[16]{ "ؽ ҷ" };
@@ -821,6 +845,9 @@ private:
 
 private:
 	CPhysicsEngine							m_PhysicsEngine{};
+	CWorkerPool								m_AnimationWorkerPool{};
+	std::vector<CObject3D*>					m_vAnimatedObject3Ds{};
+	bool									m_bShouldUseParallelAnimationUpdate{};
 	std::unique_ptr<CObject3D>				m_AClosestPointRep{};
 	std::unique_ptr<CObject3D>				m_BClosestPointRep{};
 	std::unique_ptr<CObject3D>				m_PickedPointRep{};
@@ -933,6 +960,8 @@ private:
 	long long								m_Timer_Test_ms{};
 	long long								m_FPS{};
 	long long								m_FrameCounter{};
+	size_t									m_InstanceUploadedByteCountPerFrame{};
+	size_t									m_AnimationEvaluationSkippedCountPerFrame{};
 	float									m_DeltaTime_s{};
 	float									m_Test_DeltaTime_s{ 0.02f };
 	float									m_Test_SlowFactor{ 1.0f };
@@ -943,6 +972,7 @@ private:
 private:
 	ERasterizerState						m_eRasterizerState{ ERasterizerState::CullCounterClockwise };
 	EFlagsRendering							m_eFlagsRendering{};
+	SAnimationLODData						m_AnimationLODData{};
 	bool									m_bIsDeferredRenderTargetsSet{ false };
 	bool									m_bIsDestroyed{ false };
 	CMeshPorter								m_MeshPorter{};
@@ -342,6 +342,29 @@ void CTexture::UpdateTextureRawData(const SPixel32Uint* const PtrData)
 	}
 }
 
+void CTexture::UpdateTextureRawData(const SPixel64Float* const PtrData)
+{
+	D3D11_MAPPED_SUBRESOURCE MappedSubresource{};
+	if (SUCCEEDED(m_PtrDeviceContext->Map(m_Texture2D.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &MappedSubresource)))
+	{
+		size_t SrcRowPixelCount{ (size_t)m_TextureSize.x };
+		size_t SrcRowCount{ (size_t)m_TextureSize.y };
+		uint8_t* PtrDest{ (uint8_t*)MappedSubresource.pData };
+
+		UINT RowCount{ (MappedSubresource.DepthPitch) ?
+			MappedSubresource.DepthPitch / MappedSubresource.RowPitch :
+			static_cast<UINT>(SrcRowCount) };
+		for (UINT iRow = 0; iRow < RowCount; ++iRow)
+		{
+			memcpy(PtrDest + (static_cast<size_t>(iRow) * MappedSubresource.RowPitch),
+				PtrData + (static_cast<size_t>(iRow) * SrcRowPixelCount),
+				SrcRowPixelCount * sizeof(SPixel64Float));
+		}
+
+		m_PtrDeviceContext->Unmap(m_Texture2D.Get(), 0);
+	}
+}
+
 void CTexture::UpdateTextureRawData(const SPixel128Float* const PtrData)
 {
 	D3D11_MAPPED_SUBRESOURCE MappedSubresource{};
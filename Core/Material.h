@@ -15,6 +15,14 @@ struct SPixel32Uint
 	uint8_t A{};
 };
 
+struct alignas(2) SPixel64Float // IEEE half floats (DirectX::PackedVector::HALF)
+{
+	uint16_t R{};
+	uint16_t G{};
+	uint16_t B{};
+	uint16_t A{};
+};
+
 struct alignas(4) SPixel128Float
 {
 	float R{};
@@ -170,6 +178,7 @@ private:
 public:
 	void UpdateTextureRawData(const SPixel8Uint* const PtrData);
 	void UpdateTextureRawData(const SPixel32Uint* const PtrData);
+	void UpdateTextureRawData(const SPixel64Float* const PtrData);
 	void UpdateTextureRawData(const SPixel128Float* const PtrData);
 	void SetSlot(UINT Slot);
 	void SetShaderType(EShaderType eShaderType);
@@ -9,6 +9,46 @@ using std::min;
 static const XMVECTOR KVectorZero{ XMVectorZero() };
 static const XMVECTOR KVectorGreatest{ XMVectorSet(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX) };
 
+// Structure-of-arrays packs of 4 volumes for the batch intersection kernels (one SIMD lane per volume)
+// @important: the kernels return a bitmask (bit i == lane i), lanes that are not in use must be masked out by the caller
+struct SSpherePack4
+{
+	static constexpr uint32_t KLaneCount{ 4 };
+
+	float	CenterX[KLaneCount]{};
+	float	CenterY[KLaneCount]{};
+	float	CenterZ[KLaneCount]{};
+	float	Radius[KLaneCount]{};
+};
+
+struct SAABBPack4
+{
+	static constexpr uint32_t KLaneCount{ 4 };
+
+	float	CenterX[KLaneCount]{};
+	float	CenterY[KLaneCount]{};
+	float	CenterZ[KLaneCount]{};
+	float	HalfSizeX[KLaneCount]{};
+	float	HalfSizeY[KLaneCount]{};
+	float	HalfSizeZ[KLaneCount]{};
+};
+
+// Structure-of-arrays pack of 4 transforms for the batch world matrix kernel
+struct STransformPack4
+{
+	static constexpr uint32_t KLaneCount{ 4 };
+
+	float	TranslationX[KLaneCount]{};
+	float	TranslationY[KLaneCount]{};
+	float	TranslationZ[KLaneCount]{};
+	float	ScalingX[KLaneCount]{};
+	float	ScalingY[KLaneCount]{};
+	float	ScalingZ[KLaneCount]{};
+	float	Pitch[KLaneCount]{};
+	float	Yaw[KLaneCount]{};
+	float	Roll[KLaneCount]{};
+};
+
 static float Lerp(float a, float b, float t);
 static XMVECTOR Lerp(const XMVECTOR& a, const XMVECTOR& b, float t);
 static XMVECTOR Slerp(const XMVECTOR& P0, const XMVECTOR& P1, float t);
@@ -33,9 +73,26 @@ static bool IntersectSphereSphere(const XMVECTOR& CenterA, float RadiusA, const
 static bool IntersectSphereAABB(const XMVECTOR& SphereCenter, float SphereRadius, const XMVECTOR& AABBCenter, float HalfSizeX, float HalfSizeY, float HalfSizeZ);
 static bool IntersectAABBAABB(const XMVECTOR& ACenter, float AHalfSizeX, float AHalfSizeY, float AHalfSizeZ,
 	const XMVECTOR& BCenter, float BHalfSizeX, float BHalfSizeY, float BHalfSizeZ);
+static void SetSpherePackLane(SSpherePack4& Pack, uint32_t Lane, const XMVECTOR& Center, float Radius);
+static void SetAABBPackLane(SAABBPack4& Pack, uint32_t Lane, const XMVECTOR& Center, float HalfSizeX, float HalfSizeY, float HalfSizeZ);
+static uint32_t GetLaneMask(uint32_t LaneCount);
+static uint32_t GetVectorControlMask(const XMVECTOR& Control);
+static uint32_t IntersectRaySpheres4(const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection, const SSpherePack4& Pack, XMVECTOR* const OutPtrTs);
+static uint32_t IntersectSphereSpheres4(const XMVECTOR& Center, float Radius, const SSpherePack4& Pack);
+static uint32_t IntersectSphereAABBs4(const XMVECTOR& SphereCenter, float SphereRadius, const SAABBPack4& Pack);
+static uint32_t IntersectAABBAABBs4(const XMVECTOR& Center, float HalfSizeX, float HalfSizeY, float HalfSizeZ, const SAABBPack4& Pack);
+static void SetTransformPackLane(STransformPack4& Pack, uint32_t Lane, const XMVECTOR& Translation, const XMVECTOR& Scaling, float Pitch, float Yaw, float Roll);
+static void ComposeWorldMatrices4(const STransformPack4& Pack, const XMVECTOR& Pivot, XMMATRIX* const OutMatrices, uint32_t LaneCount);
+static bool SweepSphereSphere(const XMVECTOR& CenterA, float RadiusA, const XMVECTOR& DisplacementA,
+	const XMVECTOR& CenterB, float RadiusB, float* const OutPtrTOI);
+static bool SweepSphereAABB(const XMVECTOR& SphereCenter, float SphereRadius, const XMVECTOR& Displacement,
+	const XMVECTOR& AABBCenter, float HalfSizeX, float HalfSizeY, float HalfSizeZ, float* const OutPtrTOI);
+static float GetSweptSphereAABBDistance(const XMVECTOR& SphereCenter, float SphereRadius, const XMVECTOR& Displacement,
+	const XMVECTOR& AABBMin, const XMVECTOR& AABBMax, float t);
 static XMVECTOR GetCloesetPointLine(const XMVECTOR& Point, const XMVECTOR& LineA, const XMVECTOR& LineB);
 static XMVECTOR GetClosestPointSphere(const XMVECTOR& Point, const XMVECTOR& SphereCenter, float SphereRadius);
 static XMVECTOR GetClosestPointAABB(const XMVECTOR& Point, const XMVECTOR& AABBCenter, float HalfSizeX, float HalfSizeY, float HalfSizeZ);
+static XMVECTOR GetClosestPointTriangle(const XMVECTOR& Point, const XMVECTOR& TriangleV0, const XMVECTOR& TriangleV1, const XMVECTOR& TriangleV2);
 static XMVECTOR GetAABBAABBCollisionNormal(
 	const XMVECTOR& DynamicAABBDir, const XMVECTOR& DynamicAABBClosestPoint,
 	const XMVECTOR& StaticAABBCenter, float StaticAABBHalfSizeX, float StaticAABBHalfSizeY, float StaticAABBHalfSizeZ);
@@ -427,6 +484,307 @@ static bool IntersectAABBAABB(
 	return XMVector3LessOrEqual(DifferenceAbs, HalfSizeSum);
 }
 
+static void SetSpherePackLane(SSpherePack4& Pack, uint32_t Lane, const XMVECTOR& Center, float Radius)
+{
+	Pack.CenterX[Lane] = XMVectorGetX(Center);
+	Pack.CenterY[Lane] = XMVectorGetY(Center);
+	Pack.CenterZ[Lane] = XMVectorGetZ(Center);
+	Pack.Radius[Lane] = Radius;
+}
+
+static void SetAABBPackLane(SAABBPack4& Pack, uint32_t Lane, const XMVECTOR& Center, float HalfSizeX, float HalfSizeY, float HalfSizeZ)
+{
+	Pack.CenterX[Lane] = XMVectorGetX(Center);
+	Pack.CenterY[Lane] = XMVectorGetY(Center);
+	Pack.CenterZ[Lane] = XMVectorGetZ(Center);
+	Pack.HalfSizeX[Lane] = HalfSizeX;
+	Pack.HalfSizeY[Lane] = HalfSizeY;
+	Pack.HalfSizeZ[Lane] = HalfSizeZ;
+}
+
+static uint32_t GetLaneMask(uint32_t LaneCount)
+{
+	return (1u << LaneCount) - 1;
+}
+
+static uint32_t GetVectorControlMask(const XMVECTOR& Control)
+{
+#if defined(_XM_SSE_INTRINSICS_)
+	return (uint32_t)_mm_movemask_ps(Control);
+#else
+	uint32_t Mask{};
+	for (uint32_t iLane = 0; iLane < 4; ++iLane)
+	{
+		if (XMVectorGetIntByIndex(Control, iLane)) Mask |= (1u << iLane);
+	}
+	return Mask;
+#endif
+}
+
+// Same as IntersectRaySphere() for 4 spheres, OutPtrTs receives T of each lane
+static uint32_t IntersectRaySpheres4(const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection, const SSpherePack4& Pack, XMVECTOR* const OutPtrTs)
+{
+	XMVECTOR Radius{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.Radius)) };
+	XMVECTOR COX{ XMVectorSplatX(RayOrigin) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterX)) };
+	XMVECTOR COY{ XMVectorSplatY(RayOrigin) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterY)) };
+	XMVECTOR COZ{ XMVectorSplatZ(RayOrigin) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterZ)) };
+	XMVECTOR DX{ XMVectorSplatX(RayDirection) };
+	XMVECTOR DY{ XMVectorSplatY(RayDirection) };
+	XMVECTOR DZ{ XMVectorSplatZ(RayDirection) };
+
+	XMVECTOR a{ XMVector3Dot(RayDirection, RayDirection) };
+	XMVECTOR b{ 2.0f * (DX * COX + DY * COY + DZ * COZ) };
+	XMVECTOR c{ (COX * COX + COY * COY + COZ * COZ) - Radius * Radius };
+	XMVECTOR Discriminant{ b * b - 4.0f * a * c };
+	XMVECTOR HitControl{ XMVectorGreaterOrEqual(Discriminant, KVectorZero) };
+
+	if (OutPtrTs)
+	{
+		XMVECTOR DiscriminantSqrt{ XMVectorSqrt(XMVectorMax(Discriminant, KVectorZero)) };
+		XMVECTOR TPlus{ (-b + DiscriminantSqrt) / 2.0f * a };
+		XMVECTOR TMinus{ (-b - DiscriminantSqrt) / 2.0f * a };
+		*OutPtrTs = XMVectorSelect(TMinus, TPlus, XMVectorLess(TMinus, KVectorZero));
+	}
+
+	return GetVectorControlMask(HitControl);
+}
+
+static uint32_t IntersectSphereSpheres4(const XMVECTOR& Center, float Radius, const SSpherePack4& Pack)
+{
+	XMVECTOR DX{ XMVectorSplatX(Center) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterX)) };
+	XMVECTOR DY{ XMVectorSplatY(Center) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterY)) };
+	XMVECTOR DZ{ XMVectorSplatZ(Center) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterZ)) };
+	XMVECTOR DistanceSquare{ DX * DX + DY * DY + DZ * DZ };
+	XMVECTOR RadiusSum{ XMVectorReplicate(Radius) + XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.Radius)) };
+
+	return GetVectorControlMask(XMVectorLess(DistanceSquare, RadiusSum * RadiusSum));
+}
+
+static uint32_t IntersectSphereAABBs4(const XMVECTOR& SphereCenter, float SphereRadius, const SAABBPack4& Pack)
+{
+	XMVECTOR CenterX{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterX)) };
+	XMVECTOR CenterY{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterY)) };
+	XMVECTOR CenterZ{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterZ)) };
+	XMVECTOR HalfSizeX{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.HalfSizeX)) };
+	XMVECTOR HalfSizeY{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.HalfSizeY)) };
+	XMVECTOR HalfSizeZ{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.HalfSizeZ)) };
+
+	XMVECTOR SX{ XMVectorSplatX(SphereCenter) };
+	XMVECTOR SY{ XMVectorSplatY(SphereCenter) };
+	XMVECTOR SZ{ XMVectorSplatZ(SphereCenter) };
+	XMVECTOR DX{ SX - XMVectorMin(XMVectorMax(SX, CenterX - HalfSizeX), CenterX + HalfSizeX) };
+	XMVECTOR DY{ SY - XMVectorMin(XMVectorMax(SY, CenterY - HalfSizeY), CenterY + HalfSizeY) };
+	XMVECTOR DZ{ SZ - XMVectorMin(XMVectorMax(SZ, CenterZ - HalfSizeZ), CenterZ + HalfSizeZ) };
+	XMVECTOR DistanceSquare{ DX * DX + DY * DY + DZ * DZ };
+
+	return GetVectorControlMask(XMVectorLess(DistanceSquare, XMVectorReplicate(SphereRadius * SphereRadius)));
+}
+
+static uint32_t IntersectAABBAABBs4(const XMVECTOR& Center, float HalfSizeX, float HalfSizeY, float HalfSizeZ, const SAABBPack4& Pack)
+{
+	XMVECTOR DifferenceAbsX{ XMVectorAbs(XMVectorSplatX(Center) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterX))) };
+	XMVECTOR DifferenceAbsY{ XMVectorAbs(XMVectorSplatY(Center) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterY))) };
+	XMVECTOR DifferenceAbsZ{ XMVectorAbs(XMVectorSplatZ(Center) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.CenterZ))) };
+	XMVECTOR HalfSizeSumX{ XMVectorReplicate(HalfSizeX) + XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.HalfSizeX)) };
+	XMVECTOR HalfSizeSumY{ XMVectorReplicate(HalfSizeY) + XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.HalfSizeY)) };
+	XMVECTOR HalfSizeSumZ{ XMVectorReplicate(HalfSizeZ) + XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.HalfSizeZ)) };
+
+	XMVECTOR Control{ XMVectorAndInt(XMVectorLessOrEqual(DifferenceAbsX, HalfSizeSumX),
+		XMVectorAndInt(XMVectorLessOrEqual(DifferenceAbsY, HalfSizeSumY), XMVectorLessOrEqual(DifferenceAbsZ, HalfSizeSumZ))) };
+	return GetVectorControlMask(Control);
+}
+
+static void SetTransformPackLane(STransformPack4& Pack, uint32_t Lane, const XMVECTOR& Translation, const XMVECTOR& Scaling, float Pitch, float Yaw, float Roll)
+{
+	Pack.TranslationX[Lane] = XMVectorGetX(Translation);
+	Pack.TranslationY[Lane] = XMVectorGetY(Translation);
+	Pack.TranslationZ[Lane] = XMVectorGetZ(Translation);
+	Pack.ScalingX[Lane] = XMVectorGetX(Scaling);
+	Pack.ScalingY[Lane] = XMVectorGetY(Scaling);
+	Pack.ScalingZ[Lane] = XMVectorGetZ(Scaling);
+	Pack.Pitch[Lane] = Pitch;
+	Pack.Yaw[Lane] = Yaw;
+	Pack.Roll[Lane] = Roll;
+}
+
+// World = Scaling * Translation(-Pivot) * RotationRollPitchYaw * Translation * Translation(+Pivot)
+// @important: only the first LaneCount matrices are written
+static void ComposeWorldMatrices4(const STransformPack4& Pack, const XMVECTOR& Pivot, XMMATRIX* const OutMatrices, uint32_t LaneCount)
+{
+	XMVECTOR SinP{}, CosP{}, SinY{}, CosY{}, SinR{}, CosR{};
+	XMVectorSinCos(&SinP, &CosP, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.Pitch)));
+	XMVectorSinCos(&SinY, &CosY, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.Yaw)));
+	XMVectorSinCos(&SinR, &CosR, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.Roll)));
+
+	// Same as XMMatrixRotationRollPitchYaw(), one lane per matrix
+	XMVECTOR R00{ CosR * CosY + SinR * SinP * SinY };
+	XMVECTOR R01{ SinR * CosP };
+	XMVECTOR R02{ SinR * SinP * CosY - CosR * SinY };
+	XMVECTOR R10{ CosR * SinP * SinY - SinR * CosY };
+	XMVECTOR R11{ CosR * CosP };
+	XMVECTOR R12{ SinR * SinY + CosR * SinP * CosY };
+	XMVECTOR R20{ CosP * SinY };
+	XMVECTOR R21{ -SinP };
+	XMVECTOR R22{ CosP * CosY };
+
+	// Translation row = Pivot - Pivot * Rotation + Translation
+	XMVECTOR PX{ XMVectorSplatX(Pivot) };
+	XMVECTOR PY{ XMVectorSplatY(Pivot) };
+	XMVECTOR PZ{ XMVectorSplatZ(Pivot) };
+	XMVECTOR T0{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.TranslationX)) + PX - (PX * R00 + PY * R10 + PZ * R20) };
+	XMVECTOR T1{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.TranslationY)) + PY - (PX * R01 + PY * R11 + PZ * R21) };
+	XMVECTOR T2{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.TranslationZ)) + PZ - (PX * R02 + PY * R12 + PZ * R22) };
+
+	XMVECTOR SX{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.ScalingX)) };
+	XMVECTOR SY{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.ScalingY)) };
+	XMVECTOR SZ{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pack.ScalingZ)) };
+
+	// @important: transposing a group of 4 lanes turns the k-th row of every lane into a row of its own
+	XMMATRIX Row0s{ XMMatrixTranspose(XMMATRIX{ SX * R00, SX * R01, SX * R02, KVectorZero }) };
+	XMMATRIX Row1s{ XMMatrixTranspose(XMMATRIX{ SY * R10, SY * R11, SY * R12, KVectorZero }) };
+	XMMATRIX Row2s{ XMMatrixTranspose(XMMATRIX{ SZ * R20, SZ * R21, SZ * R22, KVectorZero }) };
+	XMMATRIX Row3s{ XMMatrixTranspose(XMMATRIX{ T0, T1, T2, XMVectorReplicate(1.0f) }) };
+	for (uint32_t iLane = 0; iLane < LaneCount; ++iLane)
+	{
+		OutMatrices[iLane].r[0] = Row0s.r[iLane];
+		OutMatrices[iLane].r[1] = Row1s.r[iLane];
+		OutMatrices[iLane].r[2] = Row2s.r[iLane];
+		OutMatrices[iLane].r[3] = Row3s.r[iLane];
+	}
+}
+
+// @important: B is static, A moves by DisplacementA during [0, 1]
+static bool SweepSphereSphere(const XMVECTOR& CenterA, float RadiusA, const XMVECTOR& DisplacementA,
+	const XMVECTOR& CenterB, float RadiusB, float* const OutPtrTOI)
+{
+	// |BToA + tD| = r_a + r_b
+	// (D.D)t^2 + 2(BToA.D)t + BToA.BToA - (r_a + r_b)^2 = 0
+	XMVECTOR BToA{ CenterA - CenterB };
+	float RadiusSum{ RadiusA + RadiusB };
+
+	float c{ XMVectorGetX(XMVector3Dot(BToA, BToA)) - RadiusSum * RadiusSum };
+	if (c < 0.0f)
+	{
+		// Already overlapping
+		if (OutPtrTOI) *OutPtrTOI = 0.0f;
+		return true;
+	}
+
+	float a{ XMVectorGetX(XMVector3Dot(DisplacementA, DisplacementA)) };
+	if (a <= FLT_EPSILON) return false;
+
+	float b{ XMVectorGetX(XMVector3Dot(BToA, DisplacementA)) };
+	if (b >= 0.0f) return false; // Moving away
+
+	float discriminant{ b * b - a * c };
+	if (discriminant < 0.0f) return false;
+
+	float t{ (-b - sqrt(discriminant)) / a };
+	if (t > 1.0f) return false;
+
+	if (OutPtrTOI) *OutPtrTOI = t;
+	return true;
+}
+
+// @important: the AABB is static, the sphere moves by Displacement during [0, 1]
+static bool SweepSphereAABB(const XMVECTOR& SphereCenter, float SphereRadius, const XMVECTOR& Displacement,
+	const XMVECTOR& AABBCenter, float HalfSizeX, float HalfSizeY, float HalfSizeZ, float* const OutPtrTOI)
+{
+	static constexpr int KIterationCount{ 24 };
+
+	if (IntersectSphereAABB(SphereCenter, SphereRadius, AABBCenter, HalfSizeX, HalfSizeY, HalfSizeZ))
+	{
+		// Already overlapping
+		if (OutPtrTOI) *OutPtrTOI = 0.0f;
+		return true;
+	}
+
+	// Slab test against the AABB expanded by the radius (a lower bound of TOI)
+	const float Start[3]{ XMVectorGetX(SphereCenter), XMVectorGetY(SphereCenter), XMVectorGetZ(SphereCenter) };
+	const float Direction[3]{ XMVectorGetX(Displacement), XMVectorGetY(Displacement), XMVectorGetZ(Displacement) };
+	const float Center[3]{ XMVectorGetX(AABBCenter), XMVectorGetY(AABBCenter), XMVectorGetZ(AABBCenter) };
+	const float ExpandedHalfSize[3]{ HalfSizeX + SphereRadius, HalfSizeY + SphereRadius, HalfSizeZ + SphereRadius };
+	float TMin{ 0.0f };
+	float TMax{ 1.0f };
+	for (int iAxis = 0; iAxis < 3; ++iAxis)
+	{
+		float SlabMin{ Center[iAxis] - ExpandedHalfSize[iAxis] };
+		float SlabMax{ Center[iAxis] + ExpandedHalfSize[iAxis] };
+		if (abs(Direction[iAxis]) <= FLT_EPSILON)
+		{
+			if (Start[iAxis] < SlabMin || Start[iAxis] > SlabMax) return false;
+			continue;
+		}
+
+		float T0{ (SlabMin - Start[iAxis]) / Direction[iAxis] };
+		float T1{ (SlabMax - Start[iAxis]) / Direction[iAxis] };
+		if (T0 > T1) std::swap(T0, T1);
+		TMin = max(TMin, T0);
+		TMax = min(TMax, T1);
+		if (TMin > TMax) return false;
+	}
+
+	// @important: the distance between the moving sphere and the AABB is convex in t,
+	// so we find its minimum first and then the first root before the minimum
+	XMVECTOR AABBHalfSizes{ XMVectorSet(HalfSizeX, HalfSizeY, HalfSizeZ, 0) };
+	XMVECTOR AABBMin{ AABBCenter - AABBHalfSizes };
+	XMVECTOR AABBMax{ AABBCenter + AABBHalfSizes };
+	float DistanceAtTMin{ GetSweptSphereAABBDistance(SphereCenter, SphereRadius, Displacement, AABBMin, AABBMax, TMin) };
+	if (DistanceAtTMin <= 0.0f)
+	{
+		// Hit on a face
+		if (OutPtrTOI) *OutPtrTOI = TMin;
+		return true;
+	}
+
+	// Golden-section search for the closest approach (rounded edges & corners)
+	float Lo{ TMin };
+	float Hi{ TMax };
+	for (int iIteration = 0; iIteration < KIterationCount; ++iIteration)
+	{
+		float M0{ Lo + (Hi - Lo) * 0.381966f };
+		float M1{ Lo + (Hi - Lo) * 0.618034f };
+		if (GetSweptSphereAABBDistance(SphereCenter, SphereRadius, Displacement, AABBMin, AABBMax, M0) <
+			GetSweptSphereAABBDistance(SphereCenter, SphereRadius, Displacement, AABBMin, AABBMax, M1))
+		{
+			Hi = M1;
+		}
+		else
+		{
+			Lo = M0;
+		}
+	}
+	float TClosest{ (Lo + Hi) * 0.5f };
+	if (GetSweptSphereAABBDistance(SphereCenter, SphereRadius, Displacement, AABBMin, AABBMax, TClosest) > 0.0f) return false;
+
+	// Bisection for the time of impact
+	Lo = TMin;
+	Hi = TClosest;
+	for (int iIteration = 0; iIteration < KIterationCount; ++iIteration)
+	{
+		float M{ (Lo + Hi) * 0.5f };
+		if (GetSweptSphereAABBDistance(SphereCenter, SphereRadius, Displacement, AABBMin, AABBMax, M) > 0.0f)
+		{
+			Lo = M;
+		}
+		else
+		{
+			Hi = M;
+		}
+	}
+
+	if (OutPtrTOI) *OutPtrTOI = Hi;
+	return true;
+}
+
+static float GetSweptSphereAABBDistance(const XMVECTOR& SphereCenter, float SphereRadius, const XMVECTOR& Displacement,
+	const XMVECTOR& AABBMin, const XMVECTOR& AABBMax, float t)
+{
+	XMVECTOR SphereCenterAtT{ SphereCenter + Displacement * t };
+	XMVECTOR AABBClosestPoint{ XMVectorMin(XMVectorMax(SphereCenterAtT, AABBMin), AABBMax) };
+	return XMVectorGetX(XMVector3Length(SphereCenterAtT - AABBClosestPoint)) - SphereRadius;
+}
+
 static XMVECTOR GetCloesetPointLine(const XMVECTOR& Point, const XMVECTOR& LineA, const XMVECTOR& LineB)
 {
 	XMVECTOR Direction{ XMVector3Normalize(LineB - LineA) };
@@ -463,6 +821,43 @@ static XMVECTOR GetClosestPointAABB(const XMVECTOR& Point, const XMVECTOR& AABBC
 	return XMVectorSet(PointX, PointY, PointZ, 1);
 }
 
+static XMVECTOR GetClosestPointTriangle(const XMVECTOR& Point, const XMVECTOR& TriangleV0, const XMVECTOR& TriangleV1, const XMVECTOR& TriangleV2)
+{
+	// Voronoi regions of the triangle (vertices, edges, face)
+	XMVECTOR Edge01{ TriangleV1 - TriangleV0 };
+	XMVECTOR Edge02{ TriangleV2 - TriangleV0 };
+
+	XMVECTOR V0P{ Point - TriangleV0 };
+	float D1{ XMVectorGetX(XMVector3Dot(Edge01, V0P)) };
+	float D2{ XMVectorGetX(XMVector3Dot(Edge02, V0P)) };
+	if (D1 <= 0.0f && D2 <= 0.0f) return TriangleV0;
+
+	XMVECTOR V1P{ Point - TriangleV1 };
+	float D3{ XMVectorGetX(XMVector3Dot(Edge01, V1P)) };
+	float D4{ XMVectorGetX(XMVector3Dot(Edge02, V1P)) };
+	if (D3 >= 0.0f && D4 <= D3) return TriangleV1;
+
+	float VC{ D1 * D4 - D3 * D2 };
+	if (VC <= 0.0f && D1 >= 0.0f && D3 <= 0.0f) return TriangleV0 + Edge01 * (D1 / (D1 - D3));
+
+	XMVECTOR V2P{ Point - TriangleV2 };
+	float D5{ XMVectorGetX(XMVector3Dot(Edge01, V2P)) };
+	float D6{ XMVectorGetX(XMVector3Dot(Edge02, V2P)) };
+	if (D6 >= 0.0f && D5 <= D6) return TriangleV2;
+
+	float VB{ D5 * D2 - D1 * D6 };
+	if (VB <= 0.0f && D2 >= 0.0f && D6 <= 0.0f) return TriangleV0 + Edge02 * (D2 / (D2 - D6));
+
+	float VA{ D3 * D6 - D5 * D4 };
+	if (VA <= 0.0f && (D4 - D3) >= 0.0f && (D5 - D6) >= 0.0f)
+	{
+		return TriangleV1 + (TriangleV2 - TriangleV1) * ((D4 - D3) / ((D4 - D3) + (D5 - D6)));
+	}
+
+	float Denominator{ 1.0f / (VA + VB + VC) };
+	return TriangleV0 + Edge01 * (VB * Denominator) + Edge02 * (VC * Denominator);
+}
+
 static XMVECTOR GetAABBAABBCollisionNormal(
 	const XMVECTOR& DynamicAABBDir, const XMVECTOR& DynamicAABBClosestPoint,
 	const XMVECTOR& StaticAABBCenter, float StaticAABBHalfSizeX, float StaticAABBHalfSizeY, float StaticAABBHalfSizeZ)
@@ -609,6 +609,9 @@ void CTerrain::UpdateFoliagePlacing(bool bErase)
 	const int KCenterU{ static_cast<int>((+m_TerrainFileData->SizeX / 2.0f + XMVectorGetX(LocalSelectionPosition)) * m_TerrainFileData->FoliagePlacingDetail) };
 	const int KCenterV{ static_cast<int>(-(-m_TerrainFileData->SizeZ / 2.0f + XMVectorGetZ(LocalSelectionPosition)) * m_TerrainFileData->FoliagePlacingDetail) };
 
+	// Placed foliages are inserted in bulk after the loop
+	vector<string> vPlacedInstanceNames{};
+	vector<XMVECTOR> vPlacedPositions{};
 	for (int iPixel = 0; iPixel < (int)m_TerrainFileData->vFoliagePlacingTextureRawData.size(); ++iPixel)
 	{
 		int U{ iPixel % (int)(m_FoliagePlacingTextureSize.x) };
@@ -643,35 +646,37 @@ void CTerrain::UpdateFoliagePlacing(bool bErase)
 				{
 					m_TerrainFileData->vFoliagePlacingTextureRawData[iPixel].R = 255;
 
-					const string KInstanceName{ "Fol_" + to_string(U) + "_" + to_string(V) };
 					const float Interval{ 1.0f / (float)m_TerrainFileData->FoliagePlacingDetail };
-					for (auto& Foliage : m_vFoliages)
-					{
-						if (Foliage->InsertInstance(KInstanceName))
-						{
-							float XDisplacement{ GetRandom(-0.2f, +0.2f) };
-							float YDisplacement{ GetRandom(-0.1f, 0.0f) };
-							float ZDisplacement{ GetRandom(-0.2f, +0.2f) };
-
-							Foliage->TranslateInstanceTo(
-								KInstanceName,
-								XMVectorSet
-								(
-									XDisplacement + (U - (int)(m_FoliagePlacingTextureSize.x * 0.5f)) * KScalingX * Interval,
-									YDisplacement,
-									ZDisplacement - (V - (int)(m_FoliagePlacingTextureSize.y * 0.5f)) * KScalingZ * Interval,
-									1
-								));
-
-							float YRotationAngle{ GetRandom(0.0f, XM_2PI) };
-							Foliage->RotateInstanceYawTo(KInstanceName, YRotationAngle);
-							Foliage->UpdateInstanceWorldMatrix(KInstanceName);
-						}
-					}
+					vPlacedInstanceNames.emplace_back("Fol_" + to_string(U) + "_" + to_string(V));
+					vPlacedPositions.emplace_back(XMVectorSet(
+						(U - (int)(m_FoliagePlacingTextureSize.x * 0.5f)) * KScalingX * Interval,
+						0,
+						-(V - (int)(m_FoliagePlacingTextureSize.y * 0.5f)) * KScalingZ * Interval,
+						1));
 				}
 			}
 		}
 	}
+
+	if (vPlacedInstanceNames.size())
+	{
+		vector<SComponentTransform> vTransforms(vPlacedInstanceNames.size());
+		for (auto& Foliage : m_vFoliages)
+		{
+			for (size_t iPlaced = 0; iPlaced < vPlacedInstanceNames.size(); ++iPlaced)
+			{
+				float XDisplacement{ GetRandom(-0.2f, +0.2f) };
+				float YDisplacement{ GetRandom(-0.1f, 0.0f) };
+				float ZDisplacement{ GetRandom(-0.2f, +0.2f) };
+
+				auto& Transform{ vTransforms[iPlaced] };
+				Transform = Foliage->GetTransform();
+				Transform.Translation = vPlacedPositions[iPlaced] + XMVectorSet(XDisplacement, YDisplacement, ZDisplacement, 0);
+				Transform.Yaw = GetRandom(0.0f, XM_2PI);
+			}
+			Foliage->InsertInstances(vTransforms, vPlacedInstanceNames);
+		}
+	}
 	
 	// Update Foliage Placing Texture
 	m_FoliagePlacingTexture->UpdateTextureRawData(&m_TerrainFileData->vFoliagePlacingTextureRawData[0]);
@@ -850,6 +855,11 @@ const string& CTerrain::GetFileName() const
 	return m_TerrainFileData->FileName;
 }
 
+const STERRData& CTerrain::GetTerrainFileData() const
+{
+	return *m_TerrainFileData;
+}
+
 const XMFLOAT2& CTerrain::GetSelectionPosition() const
 {
 	return m_CBTerrainSelectionData.Position;
@@ -959,6 +969,17 @@ const DirectX::XMMATRIX& CTerrain::GetWindRepresentationWorldMatrix() const
 	return m_Object3DWindRep->GetWorldMatrix();
 }
 
+size_t CTerrain::ConsumeFoliageInstanceUploadedByteCount()
+{
+	size_t UploadedByteCount{};
+	for (auto& Foliage : m_vFoliages)
+	{
+		UploadedByteCount += Foliage->GetInstanceUploadStatistics().UploadedByteCount;
+		Foliage->ResetInstanceUploadStatistics();
+	}
+	return UploadedByteCount;
+}
+
 void CTerrain::UpdateWind(float DeltaTime)
 {
 	XMVECTOR xmvPosition{ XMLoadFloat3(&m_CBWindData.Position) };
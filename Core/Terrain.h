@@ -148,6 +148,7 @@ public:
 	bool HasFoliageCluster() const;
 
 	const std::string& GetFileName() const;
+	const STERRData& GetTerrainFileData() const;
 
 	const XMFLOAT2& GetSelectionPosition() const;
 	uint32_t GetFoliagePlacingDetail() const;
@@ -163,6 +164,8 @@ public:
 
 public:
 	void UpdateWind(float DeltaTime);
+	// @important: resets the instance buffer upload statistics of the foliages
+	size_t ConsumeFoliageInstanceUploadedByteCount();
 
 	void DrawTerrain(bool bDrawNormals);
 	void DrawWater();
@@ -0,0 +1,133 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+CWorkerPool::CWorkerPool()
+{
+}
+
+CWorkerPool::~CWorkerPool()
+{
+	Destroy();
+}
+
+void CWorkerPool::Create(size_t WorkerCount)
+{
+	Destroy();
+
+	if (WorkerCount == 0)
+	{
+		size_t HardwareConcurrency{ std::thread::hardware_concurrency() };
+		WorkerCount = (HardwareConcurrency > 1) ? HardwareConcurrency - 1 : 0;
+	}
+
+	m_bShouldExit = false;
+	m_vWorkers.reserve(WorkerCount);
+	for (size_t iWorker = 0; iWorker < WorkerCount; ++iWorker)
+	{
+		m_vWorkers.emplace_back(&CWorkerPool::WorkerMain, this, iWorker + 1);
+	}
+}
+
+void CWorkerPool::Destroy()
+{
+	{
+		std::unique_lock<std::mutex> Lock{ m_Mutex };
+		m_bShouldExit = true;
+	}
+	m_cvJobPosted.notify_all();
+
+	for (auto& Worker : m_vWorkers)
+	{
+		if (Worker.joinable()) Worker.join();
+	}
+	m_vWorkers.clear();
+}
+
+void CWorkerPool::ParallelFor(size_t Count, size_t GrainSize, PFNJob Job, void* Context)
+{
+	if (Count == 0) return;
+	if (GrainSize == 0) GrainSize = 1;
+
+	// Not worth waking anyone up
+	if (m_vWorkers.empty() || Count <= GrainSize)
+	{
+		Job(Context, 0, Count, 0);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> Lock{ m_Mutex };
+
+		// @important: a late worker might still be looking at the previous job
+		while (m_ActiveWorkerCount > 0) m_cvJobDone.wait(Lock);
+
+		m_Job = Job;
+		m_JobContext = Context;
+		m_JobCount = Count;
+		m_JobGrainSize = GrainSize;
+		m_NextBegin.store(0);
+		++m_JobGeneration;
+	}
+	m_cvJobPosted.notify_all();
+
+	RunChunks(Job, Context, Count, GrainSize, 0);
+
+	{
+		// Every chunk has been claimed, and chunks are only claimed by active workers
+		std::unique_lock<std::mutex> Lock{ m_Mutex };
+		while (m_ActiveWorkerCount > 0) m_cvJobDone.wait(Lock);
+	}
+}
+
+bool CWorkerPool::IsCreated() const
+{
+	return !m_vWorkers.empty();
+}
+
+size_t CWorkerPool::GetWorkerCount() const
+{
+	return m_vWorkers.size();
+}
+
+size_t CWorkerPool::GetThreadCount() const
+{
+	return m_vWorkers.size() + 1;
+}
+
+void CWorkerPool::WorkerMain(size_t WorkerIndex)
+{
+	uint64_t SeenJobGeneration{};
+
+	std::unique_lock<std::mutex> Lock{ m_Mutex };
+	SeenJobGeneration = m_JobGeneration;
+	while (true)
+	{
+		while (!m_bShouldExit && SeenJobGeneration == m_JobGeneration) m_cvJobPosted.wait(Lock);
+		if (m_bShouldExit) return;
+
+		SeenJobGeneration = m_JobGeneration;
+		PFNJob Job{ m_Job };
+		void* Context{ m_JobContext };
+		size_t Count{ m_JobCount };
+		size_t GrainSize{ m_JobGrainSize };
+		++m_ActiveWorkerCount;
+
+		Lock.unlock();
+		RunChunks(Job, Context, Count, GrainSize, WorkerIndex);
+		Lock.lock();
+
+		--m_ActiveWorkerCount;
+		if (m_ActiveWorkerCount == 0) m_cvJobDone.notify_all();
+	}
+}
+
+void CWorkerPool::RunChunks(PFNJob Job, void* Context, size_t Count, size_t GrainSize, size_t WorkerIndex)
+{
+	while (true)
+	{
+		size_t Begin{ m_NextBegin.fetch_add(GrainSize) };
+		if (Begin >= Count) break;
+
+		Job(Context, Begin, std::min(Begin + GrainSize, Count), WorkerIndex);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Fixed-size pool of worker threads that cooperatively run ParallelFor() jobs
+// The calling thread always takes part in the job (as worker #0), so the pool also works with zero workers.
+class CWorkerPool final
+{
+public:
+	// @important: [Begin, End) is the range to process, WorkerIndex is in [0, GetWorkerCount()]
+	using PFNJob = void(*)(void* Context, size_t Begin, size_t End, size_t WorkerIndex);
+
+public:
+	CWorkerPool();
+	CWorkerPool(const CWorkerPool& b) = delete;
+	~CWorkerPool();
+
+public:
+	// WorkerCount == 0 means (hardware concurrency - 1)
+	void Create(size_t WorkerCount = 0);
+	void Destroy();
+
+public:
+	// @important: blocks until every element in [0, Count) has been processed
+	void ParallelFor(size_t Count, size_t GrainSize, PFNJob Job, void* Context);
+
+public:
+	bool IsCreated() const;
+	size_t GetWorkerCount() const;
+	size_t GetThreadCount() const; // workers + calling thread
+
+private:
+	void WorkerMain(size_t WorkerIndex);
+	void RunChunks(PFNJob Job, void* Context, size_t Count, size_t GrainSize, size_t WorkerIndex);
+
+private:
+	std::vector<std::thread>	m_vWorkers{};
+
+private:
+	std::mutex					m_Mutex{};
+	std::condition_variable		m_cvJobPosted{};
+	std::condition_variable		m_cvJobDone{};
+	bool						m_bShouldExit{};
+	size_t						m_ActiveWorkerCount{};
+
+// Current job (written only while no worker is active)
+private:
+	uint64_t					m_JobGeneration{};
+	PFNJob						m_Job{};
+	void*						m_JobContext{};
+	size_t						m_JobCount{};
+	size_t						m_JobGrainSize{};
+	std::atomic<size_t>			m_NextBegin{};
+};
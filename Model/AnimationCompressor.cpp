@@ -0,0 +1,308 @@
+#include "AnimationCompressor.h"
+#include "../Core/Material.h"
+
+using std::max;
+using std::min;
+using std::vector;
+
+static constexpr float KSqrt2{ 1.41421356f };
+static constexpr float KInverseSqrt2{ 0.70710678f };
+static constexpr float KMaxUint15{ 32767.0f };
+static constexpr float KMaxUint16{ 65535.0f };
+
+CAnimationCompressor::CAnimationCompressor()
+{
+}
+
+CAnimationCompressor::~CAnimationCompressor()
+{
+}
+
+void CAnimationCompressor::Compress(SMeshAnimation& Animation)
+{
+	if (Animation.bIsCompressed) return;
+	if (Animation.vNodeAnimations.empty()) return;
+
+	float TicksPerSecond{ (Animation.TicksPerSecond > 0.0f) ? Animation.TicksPerSecond : 1.0f };
+	float Duration{ max(Animation.Duration, 0.0f) };
+	Animation.SamplesPerTick = KSampleRate / TicksPerSecond;
+	Animation.SampleCount = min((uint32_t)ceil(Duration * Animation.SamplesPerTick) + 1, KMaxSampleCount);
+
+	Animation.vCompressedTracks.clear();
+	Animation.vCompressedTracks.resize(Animation.vNodeAnimations.size() * 3);
+	Animation.vCompressedTrackData.clear();
+	for (size_t iNodeAnimation = 0; iNodeAnimation < Animation.vNodeAnimations.size(); ++iNodeAnimation)
+	{
+		SMeshAnimation::SNodeAnimation& NodeAnimation{ Animation.vNodeAnimations[iNodeAnimation] };
+		SMeshAnimation::SCompressedTrack* const Tracks{ &Animation.vCompressedTracks[iNodeAnimation * 3] };
+
+		CompressTrack(Animation, NodeAnimation.vPositionKeys, ETrackType::Position, Tracks[0], Animation.vCompressedTrackData);
+		CompressTrack(Animation, NodeAnimation.vRotationKeys, ETrackType::Rotation, Tracks[1], Animation.vCompressedTrackData);
+		CompressTrack(Animation, NodeAnimation.vScalingKeys, ETrackType::Scaling, Tracks[2], Animation.vCompressedTrackData);
+
+		NodeAnimation.vPositionKeys.clear();
+		NodeAnimation.vPositionKeys.shrink_to_fit();
+		NodeAnimation.vRotationKeys.clear();
+		NodeAnimation.vRotationKeys.shrink_to_fit();
+		NodeAnimation.vScalingKeys.clear();
+		NodeAnimation.vScalingKeys.shrink_to_fit();
+	}
+	Animation.vCompressedTrackData.shrink_to_fit();
+
+	Animation.bIsCompressed = true;
+}
+
+void CAnimationCompressor::Evaluate(const SMeshAnimation& Animation, size_t NodeAnimationIndex, float AnimationTick,
+	XMVECTOR& OutPosition, XMVECTOR& OutRotation, XMVECTOR& OutScaling)
+{
+	float Tick{ min(max(AnimationTick, 0.0f), Animation.Duration) };
+	float FullRateSample{ min(Tick * Animation.SamplesPerTick, (float)(Animation.SampleCount - 1)) };
+
+	const SMeshAnimation::SCompressedTrack* const Tracks{ &Animation.vCompressedTracks[NodeAnimationIndex * 3] };
+	OutPosition = EvaluateTrack(Animation, Tracks[0], FullRateSample, false);
+	OutRotation = EvaluateTrack(Animation, Tracks[1], FullRateSample, true);
+	OutScaling = EvaluateTrack(Animation, Tracks[2], FullRateSample, false);
+}
+
+void CAnimationCompressor::CompressTrack(const SMeshAnimation& Animation, const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys,
+	ETrackType eTrackType, SMeshAnimation::SCompressedTrack& OutTrack, vector<uint16_t>& vOutTrackData)
+{
+	const bool KIsRotation{ eTrackType == ETrackType::Rotation };
+
+	ResampleKeys(Animation, vKeys, eTrackType);
+	const uint32_t KFullRateSampleCount{ (uint32_t)m_vSamples.size() };
+
+	XMVECTOR Minimum{ m_vSamples[0] };
+	XMVECTOR Maximum{ m_vSamples[0] };
+	for (const XMVECTOR& Sample : m_vSamples)
+	{
+		Minimum = XMVectorMin(Minimum, Sample);
+		Maximum = XMVectorMax(Maximum, Sample);
+	}
+	XMVECTOR Extent{ Maximum - Minimum };
+	float MaxExtent{ max(max(XMVectorGetX(Extent), XMVectorGetY(Extent)), max(XMVectorGetZ(Extent), (KIsRotation) ? XMVectorGetW(Extent) : 0.0f)) };
+
+	float Tolerance{};
+	switch (eTrackType)
+	{
+	case ETrackType::Position:
+		Tolerance = max(KMinPositionTolerance, KPositionTolerance * MaxExtent);
+		break;
+	case ETrackType::Rotation:
+		Tolerance = KRotationTolerance;
+		break;
+	case ETrackType::Scaling:
+		Tolerance = KScalingTolerance;
+		break;
+	default:
+		break;
+	}
+
+	// @important: a constant track keeps a single sample
+	bool bIsConstant{ MaxExtent <= Tolerance };
+	OutTrack.SampleStride = (bIsConstant) ? 1 : SelectSampleStride(eTrackType, Tolerance);
+	OutTrack.SampleCount = (bIsConstant) ? 1 : (KFullRateSampleCount - 1 + OutTrack.SampleStride - 1) / OutTrack.SampleStride + 1;
+	OutTrack.DataOffset = (uint32_t)vOutTrackData.size();
+	XMStoreFloat3(&OutTrack.Minimum, Minimum);
+	XMStoreFloat3(&OutTrack.Extent, Extent);
+
+	vOutTrackData.resize((size_t)OutTrack.DataOffset + (size_t)OutTrack.SampleCount * 3);
+	uint16_t* const PtrX{ &vOutTrackData[OutTrack.DataOffset] };
+	uint16_t* const PtrY{ PtrX + OutTrack.SampleCount };
+	uint16_t* const PtrZ{ PtrY + OutTrack.SampleCount };
+	for (uint32_t iSample = 0; iSample < OutTrack.SampleCount; ++iSample)
+	{
+		const XMVECTOR& Sample{ m_vSamples[min(iSample * OutTrack.SampleStride, KFullRateSampleCount - 1)] };
+		if (KIsRotation)
+		{
+			EncodeRotation(Sample, PtrX[iSample], PtrY[iSample], PtrZ[iSample]);
+		}
+		else
+		{
+			XMVECTOR Normalized{ XMVectorSaturate((Sample - Minimum) / XMVectorMax(Extent, XMVectorReplicate(FLT_MIN))) };
+			PtrX[iSample] = (uint16_t)(XMVectorGetX(Normalized) * KMaxUint16 + 0.5f);
+			PtrY[iSample] = (uint16_t)(XMVectorGetY(Normalized) * KMaxUint16 + 0.5f);
+			PtrZ[iSample] = (uint16_t)(XMVectorGetZ(Normalized) * KMaxUint16 + 0.5f);
+		}
+	}
+}
+
+void CAnimationCompressor::ResampleKeys(const SMeshAnimation& Animation, const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys, ETrackType eTrackType)
+{
+	m_vSamples.resize(Animation.SampleCount);
+	for (uint32_t iSample = 0; iSample < Animation.SampleCount; ++iSample)
+	{
+		float Time{ min((float)iSample / Animation.SamplesPerTick, Animation.Duration) };
+		m_vSamples[iSample] = SampleKeys(vKeys, Time, eTrackType);
+	}
+
+	// @important: keep rotations on the same hemisphere, so that neighboring samples can be compared & interpolated
+	if (eTrackType == ETrackType::Rotation)
+	{
+		for (size_t iSample = 1; iSample < m_vSamples.size(); ++iSample)
+		{
+			if (XMVectorGetX(XMVector4Dot(m_vSamples[iSample - 1], m_vSamples[iSample])) < 0.0f) m_vSamples[iSample] = -m_vSamples[iSample];
+		}
+	}
+}
+
+uint32_t CAnimationCompressor::SelectSampleStride(ETrackType eTrackType, float Tolerance) const
+{
+	const bool KIsRotation{ eTrackType == ETrackType::Rotation };
+	const uint32_t KFullRateSampleCount{ (uint32_t)m_vSamples.size() };
+	const XMVECTOR KTolerance{ XMVectorReplicate(Tolerance) };
+	const XMVECTOR KErrorMask{ (KIsRotation) ? XMVectorSet(1, 1, 1, 1) : XMVectorSet(1, 1, 1, 0) };
+
+	// The largest stride whose interpolation reproduces every removed sample within tolerance
+	for (uint32_t SampleStride = KMaxSampleStride; SampleStride > 1; SampleStride /= 2)
+	{
+		bool bIsWithinTolerance{ true };
+		for (uint32_t iFullRateSample = 0; iFullRateSample < KFullRateSampleCount; ++iFullRateSample)
+		{
+			uint32_t Remainder{ iFullRateSample % SampleStride };
+			if (Remainder == 0) continue;
+
+			uint32_t iSampleA{ iFullRateSample - Remainder };
+			uint32_t iSampleB{ min(iSampleA + SampleStride, KFullRateSampleCount - 1) };
+			XMVECTOR Approximation{ InterpolateTrackSamples(m_vSamples[iSampleA], m_vSamples[iSampleB],
+				(float)Remainder / (float)SampleStride, KIsRotation) };
+			XMVECTOR Error{ XMVectorAbs(Approximation - m_vSamples[iFullRateSample]) * KErrorMask };
+			if (!XMVector4LessOrEqual(Error, KTolerance))
+			{
+				bIsWithinTolerance = false;
+				break;
+			}
+		}
+		if (bIsWithinTolerance) return SampleStride;
+	}
+	return 1;
+}
+
+XMVECTOR CAnimationCompressor::SampleKeys(const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys, float Time, ETrackType eTrackType)
+{
+	if (vKeys.empty())
+	{
+		if (eTrackType == ETrackType::Rotation) return XMQuaternionIdentity();
+		if (eTrackType == ETrackType::Scaling) return XMVectorSet(1, 1, 1, 0);
+		return XMVectorSet(0, 0, 0, 1);
+	}
+
+	const bool KIsRotation{ eTrackType == ETrackType::Rotation };
+	if (Time <= vKeys.front().Time) return (KIsRotation) ? XMQuaternionNormalize(vKeys.front().Value) : vKeys.front().Value;
+	if (Time >= vKeys.back().Time) return (KIsRotation) ? XMQuaternionNormalize(vKeys.back().Value) : vKeys.back().Value;
+
+	// The last key whose time is <= Time
+	uint32_t First{};
+	uint32_t Last{ (uint32_t)vKeys.size() - 1 };
+	while (First < Last)
+	{
+		uint32_t Middle{ (First + Last + 1) / 2 };
+		if (vKeys[Middle].Time <= Time)
+		{
+			First = Middle;
+		}
+		else
+		{
+			Last = Middle - 1;
+		}
+	}
+
+	const SMeshAnimation::SNodeAnimation::SKey& KeyA{ vKeys[First] };
+	const SMeshAnimation::SNodeAnimation::SKey& KeyB{ vKeys[First + 1] };
+	float Span{ KeyB.Time - KeyA.Time };
+	float Alpha{ (Span > 0.0f) ? (Time - KeyA.Time) / Span : 0.0f };
+	if (KIsRotation) return XMQuaternionSlerp(XMQuaternionNormalize(KeyA.Value), XMQuaternionNormalize(KeyB.Value), Alpha);
+	return XMVectorLerp(KeyA.Value, KeyB.Value, Alpha);
+}
+
+XMVECTOR CAnimationCompressor::InterpolateTrackSamples(const XMVECTOR& A, const XMVECTOR& B, float Alpha, bool bIsRotation)
+{
+	if (!bIsRotation) return XMVectorLerp(A, B, Alpha);
+
+	// Normalized lerp on the shortest path
+	XMVECTOR BOnSameHemisphere{ (XMVectorGetX(XMVector4Dot(A, B)) < 0.0f) ? -B : B };
+	return XMQuaternionNormalize(XMVectorLerp(A, BOnSameHemisphere, Alpha));
+}
+
+XMVECTOR CAnimationCompressor::EvaluateTrack(const SMeshAnimation& Animation, const SMeshAnimation::SCompressedTrack& Track,
+	float FullRateSample, bool bIsRotation)
+{
+	float SamplePosition{ FullRateSample / (float)Track.SampleStride };
+	uint32_t iSampleA{ min((uint32_t)SamplePosition, Track.SampleCount - 1) };
+	uint32_t iSampleB{ min(iSampleA + 1, Track.SampleCount - 1) };
+
+	XMVECTOR SampleA{ DecodeTrackSample(Animation, Track, iSampleA, bIsRotation) };
+	if (iSampleA == iSampleB) return SampleA;
+
+	float Alpha{ min(SamplePosition - (float)iSampleA, 1.0f) };
+	return InterpolateTrackSamples(SampleA, DecodeTrackSample(Animation, Track, iSampleB, bIsRotation), Alpha, bIsRotation);
+}
+
+XMVECTOR CAnimationCompressor::DecodeTrackSample(const SMeshAnimation& Animation, const SMeshAnimation::SCompressedTrack& Track,
+	uint32_t iSample, bool bIsRotation)
+{
+	const uint16_t* const PtrX{ &Animation.vCompressedTrackData[Track.DataOffset] };
+	uint16_t X{ PtrX[iSample] };
+	uint16_t Y{ PtrX[Track.SampleCount + iSample] };
+	uint16_t Z{ PtrX[Track.SampleCount * 2 + iSample] };
+	if (bIsRotation) return DecodeRotation(X, Y, Z);
+
+	XMVECTOR Normalized{ XMVectorSet((float)X, (float)Y, (float)Z, 0) / KMaxUint16 };
+	return XMLoadFloat3(&Track.Minimum) + Normalized * XMLoadFloat3(&Track.Extent);
+}
+
+void CAnimationCompressor::EncodeRotation(const XMVECTOR& Rotation, uint16_t& OutA, uint16_t& OutB, uint16_t& OutC)
+{
+	XMFLOAT4 Quaternion{};
+	XMStoreFloat4(&Quaternion, XMQuaternionNormalize(Rotation));
+	const float Components[4]{ Quaternion.x, Quaternion.y, Quaternion.z, Quaternion.w };
+
+	// The largest component is dropped (and made positive), the other three are in [-1/sqrt(2), +1/sqrt(2)]
+	uint32_t iLargest{};
+	for (uint32_t iComponent = 1; iComponent < 4; ++iComponent)
+	{
+		if (fabs(Components[iComponent]) > fabs(Components[iLargest])) iLargest = iComponent;
+	}
+	float Sign{ (Components[iLargest] < 0.0f) ? -1.0f : +1.0f };
+
+	uint16_t Quantized[3]{};
+	uint32_t iQuantized{};
+	for (uint32_t iComponent = 0; iComponent < 4; ++iComponent)
+	{
+		if (iComponent == iLargest) continue;
+
+		float Normalized{ (Components[iComponent] * Sign * KSqrt2 + 1.0f) * 0.5f };
+		Normalized = min(max(Normalized, 0.0f), 1.0f);
+		Quantized[iQuantized++] = (uint16_t)(Normalized * KMaxUint15 + 0.5f);
+	}
+
+	// 15 bits per component, the index of the largest component in the highest bits of A & B
+	OutA = (uint16_t)(Quantized[0] | ((iLargest & 1) << 15));
+	OutB = (uint16_t)(Quantized[1] | ((iLargest >> 1) << 15));
+	OutC = Quantized[2];
+}
+
+XMVECTOR CAnimationCompressor::DecodeRotation(uint16_t A, uint16_t B, uint16_t C)
+{
+	const uint32_t KLargest{ (uint32_t)((A >> 15) | ((B >> 15) << 1)) };
+	const float KSmallest[3]
+	{
+		((float)(A & 0x7FFF) / KMaxUint15 * 2.0f - 1.0f) * KInverseSqrt2,
+		((float)(B & 0x7FFF) / KMaxUint15 * 2.0f - 1.0f) * KInverseSqrt2,
+		((float)(C & 0x7FFF) / KMaxUint15 * 2.0f - 1.0f) * KInverseSqrt2
+	};
+
+	float Components[4]{};
+	float SumSquare{};
+	uint32_t iSmallest{};
+	for (uint32_t iComponent = 0; iComponent < 4; ++iComponent)
+	{
+		if (iComponent == KLargest) continue;
+
+		Components[iComponent] = KSmallest[iSmallest++];
+		SumSquare += Components[iComponent] * Components[iComponent];
+	}
+	Components[KLargest] = sqrt(max(1.0f - SumSquare, 0.0f));
+
+	return XMVectorSet(Components[0], Components[1], Components[2], Components[3]);
+}
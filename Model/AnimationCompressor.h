@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../Core/SharedHeader.h"
+#include "MeshPorter.h"
+
+// Compresses the keys of an animation into uniformly sampled tracks (SMeshAnimation::SCompressedTrack)
+// - Keys are resampled at KSampleRate with interpolation (lerp for position & scaling, slerp for rotation)
+// - Samples that interpolation reproduces within tolerance are removed, by keeping every SampleStride-th sample of a track
+//   (a constant track keeps a single sample)
+// - Rotations are quantized with the smallest three (48 bits), positions & scalings to 16 bits per component
+// - Samples of a track are stored as SoA blocks, so that evaluation is O(1) per track without any key search
+class CAnimationCompressor final
+{
+public:
+	static constexpr float KSampleRate{ 30.0f }; // samples per second
+	static constexpr uint32_t KMaxSampleStride{ 16 };
+	static constexpr uint32_t KMaxSampleCount{ 0x100000 };
+	static constexpr float KRotationTolerance{ 0.0005f }; // quaternion component
+	static constexpr float KScalingTolerance{ 0.0005f };
+	static constexpr float KPositionTolerance{ 0.0001f }; // relative to the extent of the track
+	static constexpr float KMinPositionTolerance{ 0.0001f };
+
+private:
+	enum class ETrackType
+	{
+		Position,
+		Rotation,
+		Scaling
+	};
+
+public:
+	CAnimationCompressor();
+	~CAnimationCompressor();
+
+public:
+	// @important: the keys of Animation.vNodeAnimations are cleared
+	void Compress(SMeshAnimation& Animation);
+
+public:
+	// Interpolated local transform of a node animation of a compressed animation
+	static void Evaluate(const SMeshAnimation& Animation, size_t NodeAnimationIndex, float AnimationTick,
+		XMVECTOR& OutPosition, XMVECTOR& OutRotation, XMVECTOR& OutScaling);
+
+private:
+	void CompressTrack(const SMeshAnimation& Animation, const std::vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys, ETrackType eTrackType,
+		SMeshAnimation::SCompressedTrack& OutTrack, std::vector<uint16_t>& vOutTrackData);
+	void ResampleKeys(const SMeshAnimation& Animation, const std::vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys, ETrackType eTrackType);
+	uint32_t SelectSampleStride(ETrackType eTrackType, float Tolerance) const;
+
+private:
+	static XMVECTOR SampleKeys(const std::vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys, float Time, ETrackType eTrackType);
+	static XMVECTOR InterpolateTrackSamples(const XMVECTOR& A, const XMVECTOR& B, float Alpha, bool bIsRotation);
+	static XMVECTOR EvaluateTrack(const SMeshAnimation& Animation, const SMeshAnimation::SCompressedTrack& Track,
+		float FullRateSample, bool bIsRotation);
+	static XMVECTOR DecodeTrackSample(const SMeshAnimation& Animation, const SMeshAnimation::SCompressedTrack& Track,
+		uint32_t iSample, bool bIsRotation);
+	static void EncodeRotation(const XMVECTOR& Rotation, uint16_t& OutA, uint16_t& OutB, uint16_t& OutC);
+	static XMVECTOR DecodeRotation(uint16_t A, uint16_t B, uint16_t C);
+
+private:
+	std::vector<XMVECTOR>	m_vSamples{}; // full rate samples of the track being compressed
+};
@@ -8,6 +8,11 @@ using std::unique_ptr;
 using std::make_unique;
 using std::string;
 
+// @important: since 0x10006, MESH stores these arrays as blocks of their in-memory layout
+static_assert(sizeof(SVertex3D) == 80, "SVertex3D must be 5 tightly packed XMVECTORs");
+static_assert(sizeof(SAnimationVertex) == 8 * SAnimationVertex::KMaxWeightCount, "SAnimationVertex must be tightly packed");
+static_assert(sizeof(STriangle) == 12, "STriangle must be 3 tightly packed uint32_t");
+
 CMeshPorter::CMeshPorter()
 {
 	m_BinaryData = make_unique<CBinaryData>();
@@ -18,16 +23,23 @@ CMeshPorter::CMeshPorter(const std::vector<byte>& vBytes)
 	m_BinaryData = make_unique<CBinaryData>(vBytes);
 }
 
+CMeshPorter::CMeshPorter(const byte* const PtrBytes, size_t ByteCount)
+{
+	m_BinaryData = make_unique<CBinaryData>(PtrBytes, ByteCount);
+}
+
 CMeshPorter::~CMeshPorter()
 {
 }
 
-void CMeshPorter::ImportMESH(const std::string& FileName, SMESHData& MESHFile)
+bool CMeshPorter::ImportMESH(const std::string& FileName, SMESHData& MESHFile)
 {
 	m_BinaryData->Clear();
 	
-	m_BinaryData->LoadFromFile(FileName);
-	ReadMESHData(MESHFile);
+	if (!m_BinaryData->MapFile(FileName)) return false;
+	bool bResult{ ReadMESHData(MESHFile) };
+	m_BinaryData->Clear(); // @important: unmap the file
+	return bResult;
 }
 
 void CMeshPorter::ExportMESH(const std::string& FileName, const SMESHData& MESHFile)
@@ -44,7 +56,7 @@ void CMeshPorter::ImportTerrain(const std::string& FileName, STERRData& Data)
 	
 	m_BinaryData->Clear();
 
-	m_BinaryData->LoadFromFile(FileName);
+	m_BinaryData->MapFile(FileName);
 
 	// 8B Signature (TERR_KJW)
 	m_BinaryData->ReadSkip(8);
@@ -69,10 +81,11 @@ void CMeshPorter::ImportTerrain(const std::string& FileName, STERRData& Data)
 	Data.vHeightMapTextureRawData.resize(m_BinaryData->ReadUint32());
 
 	// HeightMap texture raw data
-	for (SPixel8Uint& Pixel : Data.vHeightMapTextureRawData)
+	// 1B (uint8_t) R (UNORM) per pixel
+	const SPixel8Uint* PtrHeightMapPixels{};
+	if (m_BinaryData->ReadSpan(Data.vHeightMapTextureRawData.size(), PtrHeightMapPixels))
 	{
-		// 1B (uint8_t) R (UNORM)
-		Pixel.R = m_BinaryData->ReadUint8();
+		memcpy(Data.vHeightMapTextureRawData.data(), PtrHeightMapPixels, sizeof(SPixel8Uint) * Data.vHeightMapTextureRawData.size());
 	}
 	
 
@@ -93,13 +106,11 @@ void CMeshPorter::ImportTerrain(const std::string& FileName, STERRData& Data)
 	Data.vMaskingTextureRawData.resize(m_BinaryData->ReadUint32());
 
 	// Masking texture raw data
-	for (SPixel32Uint& Pixel : Data.vMaskingTextureRawData)
+	// 4B (uint8_t * 4) RGBA (UNORM) per pixel
+	const SPixel32Uint* PtrMaskingPixels{};
+	if (m_BinaryData->ReadSpan(Data.vMaskingTextureRawData.size(), PtrMaskingPixels))
 	{
-		// 4B (uint8_t * 4) RGBA (UNORM)
-		Pixel.R = m_BinaryData->ReadUint8();
-		Pixel.G = m_BinaryData->ReadUint8();
-		Pixel.B = m_BinaryData->ReadUint8();
-		Pixel.A = m_BinaryData->ReadUint8();
+		memcpy(Data.vMaskingTextureRawData.data(), PtrMaskingPixels, sizeof(SPixel32Uint) * Data.vMaskingTextureRawData.size());
 	}
 
 
@@ -116,10 +127,12 @@ void CMeshPorter::ImportTerrain(const std::string& FileName, STERRData& Data)
 	Data.vFoliagePlacingTextureRawData.resize(m_BinaryData->ReadUint32());
 
 	// Foliage placing texture raw data
-	for (SPixel8Uint& Pixel : Data.vFoliagePlacingTextureRawData)
+	// 1B (uint8_t) R (UNORM) per pixel
+	const SPixel8Uint* PtrFoliagePlacingPixels{};
+	if (m_BinaryData->ReadSpan(Data.vFoliagePlacingTextureRawData.size(), PtrFoliagePlacingPixels))
 	{
-		// 1B (uint8_t) R (UNORM)
-		Pixel.R = m_BinaryData->ReadUint8();
+		memcpy(Data.vFoliagePlacingTextureRawData.data(), PtrFoliagePlacingPixels,
+			sizeof(SPixel8Uint) * Data.vFoliagePlacingTextureRawData.size());
 	}
 
 	// 1B (uint8_t) Foliage count
@@ -170,6 +183,8 @@ void CMeshPorter::ImportTerrain(const std::string& FileName, STERRData& Data)
 
 	// @important: right after importing the terrain, it doens't need to be saved again!
 	Data.bShouldSave = false;
+
+	m_BinaryData->Clear(); // @important: unmap the file
 }
 
 void CMeshPorter::ExportTerrain(const std::string& FileName, const STERRData& Data)
@@ -292,7 +307,7 @@ void CMeshPorter::ExportTerrain(const std::string& FileName, const STERRData& Da
 	m_BinaryData->SaveToFile(FileName);
 }
 
-void CMeshPorter::ReadMESHData(SMESHData& MESHData)
+bool CMeshPorter::ReadMESHData(SMESHData& MESHData)
 {
 	// 8B Signature (KJW_MESH)
 	m_BinaryData->ReadSkip(8);
@@ -329,52 +344,70 @@ void CMeshPorter::ReadMESHData(SMESHData& MESHData)
 		// # ### VERTEX ###
 		// 4B (uint32_t) Vertex count
 		Mesh.vVertices.resize(m_BinaryData->ReadUint32());
-		for (SVertex3D& Vertex : Mesh.vVertices)
+		if (Version >= 0x10006)
+		{
+			// 80B * ?? (SVertex3D) Vertices
+			m_BinaryData->ReadArray(Mesh.vVertices.data(), Mesh.vVertices.size());
+		}
+		else
 		{
-			// # 4B (uint32_t) Vertex index
-			m_BinaryData->ReadUint32();
+			for (SVertex3D& Vertex : Mesh.vVertices)
+			{
+				// # 4B (uint32_t) Vertex index
+				m_BinaryData->ReadUint32();
 
-			// # 16B (XMVECTOR) Position
-			m_BinaryData->ReadXMVECTOR(Vertex.Position);
+				// # 16B (XMVECTOR) Position
+				m_BinaryData->ReadXMVECTOR(Vertex.Position);
 
-			// # 16B (XMVECTOR) Color
-			m_BinaryData->ReadXMVECTOR(Vertex.Color);
+				// # 16B (XMVECTOR) Color
+				m_BinaryData->ReadXMVECTOR(Vertex.Color);
 
-			// # 16B (XMVECTOR) TexCoord
-			m_BinaryData->ReadXMVECTOR(Vertex.TexCoord);
+				// # 16B (XMVECTOR) TexCoord
+				m_BinaryData->ReadXMVECTOR(Vertex.TexCoord);
 
-			// # 16B (XMVECTOR) Normal
-			m_BinaryData->ReadXMVECTOR(Vertex.Normal);
+				// # 16B (XMVECTOR) Normal
+				m_BinaryData->ReadXMVECTOR(Vertex.Normal);
 
-			// 16B (XMVECTOR) Tangent
-			m_BinaryData->ReadXMVECTOR(Vertex.Tangent);
+				// 16B (XMVECTOR) Tangent
+				m_BinaryData->ReadXMVECTOR(Vertex.Tangent);
+			}
 		}
 
 		if (Version >= 0x10002)
 		{
 			// 4B (uint32_t) Max weight count per animation vertex
-			assert(m_BinaryData->ReadUint32() == SAnimationVertex::KMaxWeightCount);
+			// @important: read outside of assert(), which is compiled out in release builds
+			uint32_t MaxWeightCount{ m_BinaryData->ReadUint32() };
+			assert(MaxWeightCount == SAnimationVertex::KMaxWeightCount);
 
 			// 4B (uint32_t) Animation vertex count
 			Mesh.vAnimationVertices.resize(m_BinaryData->ReadUint32());
 
-			for (uint32_t iAnimationVertex = 0; iAnimationVertex < (uint32_t)Mesh.vAnimationVertices.size(); ++iAnimationVertex)
+			if (Version >= 0x10006)
 			{
-				// 4B (uint32_t) Animation vertex index
-				m_BinaryData->ReadUint32();
-
-				SAnimationVertex& AnimationVertex{ Mesh.vAnimationVertices[iAnimationVertex] };
-
-				// 4B * ?? (uint32_t) Bone IDs
-				for (auto& BoneID : AnimationVertex.BoneIDs)
-				{
-					m_BinaryData->ReadUint32(BoneID);
-				}
-
-				// 4B * ?? (float) Weights
-				for (auto& Weight : AnimationVertex.Weights)
+				// 32B * ?? (SAnimationVertex) Animation vertices
+				m_BinaryData->ReadArray(Mesh.vAnimationVertices.data(), Mesh.vAnimationVertices.size());
+			}
+			else
+			{
+				for (uint32_t iAnimationVertex = 0; iAnimationVertex < (uint32_t)Mesh.vAnimationVertices.size(); ++iAnimationVertex)
 				{
-					m_BinaryData->ReadFloat(Weight);
+					// 4B (uint32_t) Animation vertex index
+					m_BinaryData->ReadUint32();
+
+					SAnimationVertex& AnimationVertex{ Mesh.vAnimationVertices[iAnimationVertex] };
+
+					// 4B * ?? (uint32_t) Bone IDs
+					for (auto& BoneID : AnimationVertex.BoneIDs)
+					{
+						m_BinaryData->ReadUint32(BoneID);
+					}
+
+					// 4B * ?? (float) Weights
+					for (auto& Weight : AnimationVertex.Weights)
+					{
+						m_BinaryData->ReadFloat(Weight);
+					}
 				}
 			}
 		}
@@ -382,19 +415,27 @@ void CMeshPorter::ReadMESHData(SMESHData& MESHData)
 		// # ### TRIANGLE ###
 		// 4B (uint32_t) Triangle count
 		Mesh.vTriangles.resize(m_BinaryData->ReadUint32());
-		for (STriangle& Triangle : Mesh.vTriangles)
+		if (Version >= 0x10006)
+		{
+			// 12B * ?? (STriangle) Triangles
+			m_BinaryData->ReadArray(Mesh.vTriangles.data(), Mesh.vTriangles.size());
+		}
+		else
 		{
-			// # 4B (uint32_t) Triangle index
-			m_BinaryData->ReadUint32();
+			for (STriangle& Triangle : Mesh.vTriangles)
+			{
+				// # 4B (uint32_t) Triangle index
+				m_BinaryData->ReadUint32();
 
-			// # 4B (uint32_t) Vertex ID 0
-			m_BinaryData->ReadUint32(Triangle.I0);
+				// # 4B (uint32_t) Vertex ID 0
+				m_BinaryData->ReadUint32(Triangle.I0);
 
-			// # 4B (uint32_t) Vertex ID 1
-			m_BinaryData->ReadUint32(Triangle.I1);
+				// # 4B (uint32_t) Vertex ID 1
+				m_BinaryData->ReadUint32(Triangle.I1);
 
-			// # 4B (uint32_t) Vertex ID 2
-			m_BinaryData->ReadUint32(Triangle.I2);
+				// # 4B (uint32_t) Vertex ID 2
+				m_BinaryData->ReadUint32(Triangle.I2);
+			}
 		}
 	}
 
@@ -483,47 +524,110 @@ void CMeshPorter::ReadMESHData(SMESHData& MESHData)
 			// 4B (float) Ticks per second
 			m_BinaryData->ReadFloat(Animation.TicksPerSecond);
 
-			// 4B (uint32_t) Node animation count
-			Animation.vNodeAnimations.resize(m_BinaryData->ReadUint32());
-			for (auto& NodeAnimation : Animation.vNodeAnimations)
+			// 1B (bool) bIsCompressed
+			if (Version >= 0x10005) m_BinaryData->ReadBool(Animation.bIsCompressed);
+
+			if (Animation.bIsCompressed)
 			{
-				// 4B (uint32_t) Node animation index
-				m_BinaryData->ReadUint32(NodeAnimation.Index);
+				// 4B (float) Samples per tick
+				m_BinaryData->ReadFloat(Animation.SamplesPerTick);
 
-				// <@PrefString> Node animation name
-				m_BinaryData->ReadStringWithPrefixedLength(NodeAnimation.Name);
+				// 4B (uint32_t) Sample count
+				m_BinaryData->ReadUint32(Animation.SampleCount);
 
-				// 4B (uint32_t) Position key count
-				NodeAnimation.vPositionKeys.resize(m_BinaryData->ReadUint32());
-				for (auto& PositionKey : NodeAnimation.vPositionKeys)
+				// 4B (uint32_t) Node animation count
+				Animation.vNodeAnimations.resize(m_BinaryData->ReadUint32());
+				Animation.vCompressedTracks.resize(Animation.vNodeAnimations.size() * 3);
+				for (size_t iNodeAnimation = 0; iNodeAnimation < Animation.vNodeAnimations.size(); ++iNodeAnimation)
 				{
-					// 4B (float) Time
-					m_BinaryData->ReadFloat(PositionKey.Time);
+					auto& NodeAnimation{ Animation.vNodeAnimations[iNodeAnimation] };
 
-					// 16B (XMVECTOR) Value
-					m_BinaryData->ReadXMVECTOR(PositionKey.Value);
-				}
+					// 4B (uint32_t) Node animation index
+					m_BinaryData->ReadUint32(NodeAnimation.Index);
 
-				// 4B (uint32_t) Rotation key count
-				NodeAnimation.vRotationKeys.resize(m_BinaryData->ReadUint32());
-				for (auto& RotationKey : NodeAnimation.vRotationKeys)
-				{
-					// 4B (float) Time
-					m_BinaryData->ReadFloat(RotationKey.Time);
+					// <@PrefString> Node animation name
+					m_BinaryData->ReadStringWithPrefixedLength(NodeAnimation.Name);
+
+					// Position, rotation & scaling tracks
+					for (size_t iTrack = 0; iTrack < 3; ++iTrack)
+					{
+						auto& Track{ Animation.vCompressedTracks[iNodeAnimation * 3 + iTrack] };
 
-					// 16B (XMVECTOR) Value
-					m_BinaryData->ReadXMVECTOR(RotationKey.Value);
+						// 4B (uint32_t) Data offset
+						m_BinaryData->ReadUint32(Track.DataOffset);
+
+						// 4B (uint32_t) Sample count
+						m_BinaryData->ReadUint32(Track.SampleCount);
+
+						// 4B (uint32_t) Sample stride
+						m_BinaryData->ReadUint32(Track.SampleStride);
+
+						// 12B (XMFLOAT3) Minimum
+						m_BinaryData->ReadXMFLOAT3(Track.Minimum);
+
+						// 12B (XMFLOAT3) Extent
+						m_BinaryData->ReadXMFLOAT3(Track.Extent);
+					}
 				}
 
-				// 4B (uint32_t) Scaling key count
-				NodeAnimation.vScalingKeys.resize(m_BinaryData->ReadUint32());
-				for (auto& ScalingKey : NodeAnimation.vScalingKeys)
-				{
-					// 4B (float) Time
-					m_BinaryData->ReadFloat(ScalingKey.Time);
+				// 4B (uint32_t) Track data count
+				Animation.vCompressedTrackData.resize(m_BinaryData->ReadUint32());
 
-					// 16B (XMVECTOR) Value
-					m_BinaryData->ReadXMVECTOR(ScalingKey.Value);
+				// 2B * ?? (uint16_t) Track data
+				m_BinaryData->ReadArray(Animation.vCompressedTrackData.data(), Animation.vCompressedTrackData.size());
+
+				// @important: tracks are evaluated without bounds checks, so a broken track fails the load
+				if (Animation.SampleCount < 1) return false;
+				for (const auto& Track : Animation.vCompressedTracks)
+				{
+					if (Track.SampleStride < 1 || Track.SampleCount < 1) return false;
+					if ((uint64_t)Track.DataOffset + (uint64_t)Track.SampleCount * 3 > Animation.vCompressedTrackData.size()) return false;
+				}
+			}
+			else
+			{
+				// 4B (uint32_t) Node animation count
+				Animation.vNodeAnimations.resize(m_BinaryData->ReadUint32());
+				for (auto& NodeAnimation : Animation.vNodeAnimations)
+				{
+					// 4B (uint32_t) Node animation index
+					m_BinaryData->ReadUint32(NodeAnimation.Index);
+
+					// <@PrefString> Node animation name
+					m_BinaryData->ReadStringWithPrefixedLength(NodeAnimation.Name);
+
+					// 4B (uint32_t) Position key count
+					NodeAnimation.vPositionKeys.resize(m_BinaryData->ReadUint32());
+					for (auto& PositionKey : NodeAnimation.vPositionKeys)
+					{
+						// 4B (float) Time
+						m_BinaryData->ReadFloat(PositionKey.Time);
+
+						// 16B (XMVECTOR) Value
+						m_BinaryData->ReadXMVECTOR(PositionKey.Value);
+					}
+
+					// 4B (uint32_t) Rotation key count
+					NodeAnimation.vRotationKeys.resize(m_BinaryData->ReadUint32());
+					for (auto& RotationKey : NodeAnimation.vRotationKeys)
+					{
+						// 4B (float) Time
+						m_BinaryData->ReadFloat(RotationKey.Time);
+
+						// 16B (XMVECTOR) Value
+						m_BinaryData->ReadXMVECTOR(RotationKey.Value);
+					}
+
+					// 4B (uint32_t) Scaling key count
+					NodeAnimation.vScalingKeys.resize(m_BinaryData->ReadUint32());
+					for (auto& ScalingKey : NodeAnimation.vScalingKeys)
+					{
+						// 4B (float) Time
+						m_BinaryData->ReadFloat(ScalingKey.Time);
+
+						// 16B (XMVECTOR) Value
+						m_BinaryData->ReadXMVECTOR(ScalingKey.Value);
+					}
 				}
 			}
 
@@ -534,6 +638,8 @@ void CMeshPorter::ReadMESHData(SMESHData& MESHData)
 			}
 		}
 	}
+
+	return true;
 }
 
 void CMeshPorter::ReadModelMaterials(std::vector<CMaterialData>& vMaterialData)
@@ -621,7 +727,7 @@ void CMeshPorter::WriteMESHData(const SMESHData& MESHData)
 {
 	static constexpr uint16_t KVersionMajor{ 0x0001 };
 	static constexpr uint8_t KVersionMinor{ 0x00 };
-	static constexpr uint8_t KVersionSubminor{ 0x04 };
+	static constexpr uint8_t KVersionSubminor{ 0x06 };
 	uint32_t Version{ (uint32_t)(KVersionSubminor | (KVersionMinor << 8) | (KVersionMajor << 16)) };
 
 	// 8B Signature
@@ -656,28 +762,8 @@ void CMeshPorter::WriteMESHData(const SMESHData& MESHData)
 		// 4B (uint32_t) Vertex count
 		m_BinaryData->WriteUint32((uint32_t)Mesh.vVertices.size());
 
-		for (uint32_t iVertex = 0; iVertex < (uint32_t)Mesh.vVertices.size(); ++iVertex)
-		{
-			// 4B (uint32_t) Vertex index
-			m_BinaryData->WriteUint32(iVertex);
-
-			const SVertex3D& Vertex{ Mesh.vVertices[iVertex] };
-
-			// 16B (XMVECTOR) Position
-			m_BinaryData->WriteXMVECTOR(Vertex.Position);
-
-			// 16B (XMVECTOR) Color
-			m_BinaryData->WriteXMVECTOR(Vertex.Color);
-
-			// 16B (XMVECTOR) TexCoord
-			m_BinaryData->WriteXMVECTOR(Vertex.TexCoord);
-
-			// 16B (XMVECTOR) Normal
-			m_BinaryData->WriteXMVECTOR(Vertex.Normal);
-
-			// 16B (XMVECTOR) Tangent
-			m_BinaryData->WriteXMVECTOR(Vertex.Tangent);
-		}
+		// 80B * ?? (SVertex3D) Vertices (Position, Color, TexCoord, Normal, Tangent)
+		m_BinaryData->WriteArray(Mesh.vVertices.data(), Mesh.vVertices.size());
 
 		if (Version >= 0x10002)
 		{
@@ -687,45 +773,15 @@ void CMeshPorter::WriteMESHData(const SMESHData& MESHData)
 			// 4B (uint32_t) Animation vertex count
 			m_BinaryData->WriteUint32((uint32_t)Mesh.vAnimationVertices.size());
 
-			for (uint32_t iAnimationVertex = 0; iAnimationVertex < (uint32_t)Mesh.vAnimationVertices.size(); ++iAnimationVertex)
-			{
-				// 4B (uint32_t) Animation vertex index
-				m_BinaryData->WriteUint32(iAnimationVertex);
-
-				const SAnimationVertex& AnimationVertex{ Mesh.vAnimationVertices[iAnimationVertex] };
-
-				// 4B * ?? (uint32_t) Bone IDs
-				for (const auto& BoneID : AnimationVertex.BoneIDs)
-				{
-					m_BinaryData->WriteUint32(BoneID);
-				}
-
-				// 4B * ?? (float) Weights
-				for (const auto& Weight : AnimationVertex.Weights)
-				{
-					m_BinaryData->WriteFloat(Weight);
-				}
-			}
+			// 32B * ?? (SAnimationVertex) Animation vertices (Bone IDs, Weights)
+			m_BinaryData->WriteArray(Mesh.vAnimationVertices.data(), Mesh.vAnimationVertices.size());
 		}
 
 		// 4B (uint32_t) Triangle count
 		m_BinaryData->WriteUint32((uint32_t)Mesh.vTriangles.size());
-		for (uint32_t iTriangle = 0; iTriangle < (uint32_t)Mesh.vTriangles.size(); ++iTriangle)
-		{
-			// 4B (uint32_t) Triangle index
-			m_BinaryData->WriteUint32(iTriangle);
-
-			const STriangle& Triangle{ Mesh.vTriangles[iTriangle] };
-
-			// 4B (uint32_t) Vertex ID 0
-			m_BinaryData->WriteUint32(Triangle.I0);
-
-			// 4B (uint32_t) Vertex ID 1
-			m_BinaryData->WriteUint32(Triangle.I1);
 
-			// 4B (uint32_t) Vertex ID 2
-			m_BinaryData->WriteUint32(Triangle.I2);
-		}
+		// 12B * ?? (STriangle) Triangles (Vertex ID 0, 1, 2)
+		m_BinaryData->WriteArray(Mesh.vTriangles.data(), Mesh.vTriangles.size());
 	}
 
 	if (Version >= 0x10001)
@@ -807,47 +863,101 @@ void CMeshPorter::WriteMESHData(const SMESHData& MESHData)
 			// 4B (float) Ticks per second
 			m_BinaryData->WriteFloat(Animation.TicksPerSecond);
 
-			// 4B (uint32_t) Node animation count
-			m_BinaryData->WriteUint32((uint32_t)Animation.vNodeAnimations.size());
-			for (const auto& NodeAnimation : Animation.vNodeAnimations)
+			// 1B (bool) bIsCompressed
+			m_BinaryData->WriteBool(Animation.bIsCompressed);
+
+			if (Animation.bIsCompressed)
 			{
-				// 4B (uint32_t) Node animation index
-				m_BinaryData->WriteUint32(NodeAnimation.Index);
+				// 4B (float) Samples per tick
+				m_BinaryData->WriteFloat(Animation.SamplesPerTick);
 
-				// <@PrefString> Node name
-				m_BinaryData->WriteStringWithPrefixedLength(NodeAnimation.Name);
+				// 4B (uint32_t) Sample count
+				m_BinaryData->WriteUint32(Animation.SampleCount);
 
-				// 4B (uint32_t) Position key count
-				m_BinaryData->WriteUint32((uint32_t)NodeAnimation.vPositionKeys.size());
-				for (const auto& PositionKey : NodeAnimation.vPositionKeys)
+				// 4B (uint32_t) Node animation count
+				m_BinaryData->WriteUint32((uint32_t)Animation.vNodeAnimations.size());
+				for (size_t iNodeAnimation = 0; iNodeAnimation < Animation.vNodeAnimations.size(); ++iNodeAnimation)
 				{
-					// 4B (float) Time
-					m_BinaryData->WriteFloat(PositionKey.Time);
+					const auto& NodeAnimation{ Animation.vNodeAnimations[iNodeAnimation] };
 
-					// 16B (XMVECTOR) Value
-					m_BinaryData->WriteXMVECTOR(PositionKey.Value);
-				}
+					// 4B (uint32_t) Node animation index
+					m_BinaryData->WriteUint32(NodeAnimation.Index);
 
-				// 4B (uint32_t) Rotation key count
-				m_BinaryData->WriteUint32((uint32_t)NodeAnimation.vRotationKeys.size());
-				for (const auto& RotationKey : NodeAnimation.vRotationKeys)
-				{
-					// 4B (float) Time
-					m_BinaryData->WriteFloat(RotationKey.Time);
+					// <@PrefString> Node name
+					m_BinaryData->WriteStringWithPrefixedLength(NodeAnimation.Name);
 
-					// 16B (XMVECTOR) Value
-					m_BinaryData->WriteXMVECTOR(RotationKey.Value);
+					// Position, rotation & scaling tracks
+					for (size_t iTrack = 0; iTrack < 3; ++iTrack)
+					{
+						const auto& Track{ Animation.vCompressedTracks[iNodeAnimation * 3 + iTrack] };
+
+						// 4B (uint32_t) Data offset
+						m_BinaryData->WriteUint32(Track.DataOffset);
+
+						// 4B (uint32_t) Sample count
+						m_BinaryData->WriteUint32(Track.SampleCount);
+
+						// 4B (uint32_t) Sample stride
+						m_BinaryData->WriteUint32(Track.SampleStride);
+
+						// 12B (XMFLOAT3) Minimum
+						m_BinaryData->WriteXMFLOAT3(Track.Minimum);
+
+						// 12B (XMFLOAT3) Extent
+						m_BinaryData->WriteXMFLOAT3(Track.Extent);
+					}
 				}
 
-				// 4B (uint32_t) Scaling key count
-				m_BinaryData->WriteUint32((uint32_t)NodeAnimation.vScalingKeys.size());
-				for (const auto& ScalingKey : NodeAnimation.vScalingKeys)
-				{
-					// 4B (float) Time
-					m_BinaryData->WriteFloat(ScalingKey.Time);
+				// 4B (uint32_t) Track data count
+				m_BinaryData->WriteUint32((uint32_t)Animation.vCompressedTrackData.size());
 
-					// 16B (XMVECTOR) Value
-					m_BinaryData->WriteXMVECTOR(ScalingKey.Value);
+				// 2B * ?? (uint16_t) Track data
+				m_BinaryData->WriteArray(Animation.vCompressedTrackData.data(), Animation.vCompressedTrackData.size());
+			}
+			else
+			{
+				// 4B (uint32_t) Node animation count
+				m_BinaryData->WriteUint32((uint32_t)Animation.vNodeAnimations.size());
+				for (const auto& NodeAnimation : Animation.vNodeAnimations)
+				{
+					// 4B (uint32_t) Node animation index
+					m_BinaryData->WriteUint32(NodeAnimation.Index);
+
+					// <@PrefString> Node name
+					m_BinaryData->WriteStringWithPrefixedLength(NodeAnimation.Name);
+
+					// 4B (uint32_t) Position key count
+					m_BinaryData->WriteUint32((uint32_t)NodeAnimation.vPositionKeys.size());
+					for (const auto& PositionKey : NodeAnimation.vPositionKeys)
+					{
+						// 4B (float) Time
+						m_BinaryData->WriteFloat(PositionKey.Time);
+
+						// 16B (XMVECTOR) Value
+						m_BinaryData->WriteXMVECTOR(PositionKey.Value);
+					}
+
+					// 4B (uint32_t) Rotation key count
+					m_BinaryData->WriteUint32((uint32_t)NodeAnimation.vRotationKeys.size());
+					for (const auto& RotationKey : NodeAnimation.vRotationKeys)
+					{
+						// 4B (float) Time
+						m_BinaryData->WriteFloat(RotationKey.Time);
+
+						// 16B (XMVECTOR) Value
+						m_BinaryData->WriteXMVECTOR(RotationKey.Value);
+					}
+
+					// 4B (uint32_t) Scaling key count
+					m_BinaryData->WriteUint32((uint32_t)NodeAnimation.vScalingKeys.size());
+					for (const auto& ScalingKey : NodeAnimation.vScalingKeys)
+					{
+						// 4B (float) Time
+						m_BinaryData->WriteFloat(ScalingKey.Time);
+
+						// 16B (XMVECTOR) Value
+						m_BinaryData->WriteXMVECTOR(ScalingKey.Value);
+					}
 				}
 			}
 		}
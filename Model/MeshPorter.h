@@ -25,6 +25,16 @@ struct SMeshAnimation
 		std::vector<SKey>	vScalingKeys{};
 	};
 
+	// Uniformly sampled & quantized track (see CAnimationCompressor)
+	struct SCompressedTrack
+	{
+		uint32_t	DataOffset{}; // into vCompressedTrackData: X[SampleCount], Y[SampleCount], Z[SampleCount]
+		uint32_t	SampleCount{};
+		uint32_t	SampleStride{ 1 }; // in full rate samples
+		XMFLOAT3	Minimum{}; // position & scaling only
+		XMFLOAT3	Extent{}; // position & scaling only
+	};
+
 	std::vector<SNodeAnimation>				vNodeAnimations{};
 
 	float									Duration{};
@@ -33,6 +43,13 @@ struct SMeshAnimation
 	std::unordered_map<std::string, size_t>	umapNodeAnimationNameToIndex{};
 
 	std::string								Name{};
+
+	// @important: once compressed, the keys of vNodeAnimations are cleared
+	bool									bIsCompressed{};
+	float									SamplesPerTick{};
+	uint32_t								SampleCount{}; // at the full rate
+	std::vector<SCompressedTrack>			vCompressedTracks{}; // position, rotation & scaling of every node animation
+	std::vector<uint16_t>					vCompressedTrackData{};
 };
 
 struct SMeshTreeNode
@@ -122,17 +139,20 @@ class CMeshPorter
 public:
 	CMeshPorter();
 	CMeshPorter(const std::vector<byte>& vBytes);
+	// Reads in place from a read-only view, the bytes must outlive this
+	CMeshPorter(const byte* const PtrBytes, size_t ByteCount);
 	~CMeshPorter();
 
 public:
-	void ImportMESH(const std::string& FileName, SMESHData& MESHFile);
+	// returns false if the file can't be opened or its data is broken
+	bool ImportMESH(const std::string& FileName, SMESHData& MESHFile);
 	void ExportMESH(const std::string& FileName, const SMESHData& MESHFile);
 
 	void ImportTerrain(const std::string& FileName, STERRData& Data);
 	void ExportTerrain(const std::string& FileName, const STERRData& Data);
 
 public:
-	void ReadMESHData(SMESHData& MESHData);
+	bool ReadMESHData(SMESHData& MESHData);
 	void WriteMESHData(const SMESHData& MESHData);
 
 private:
@@ -1,10 +1,15 @@
 ﻿#include "Object3D.h"
+#include "AnimationCompressor.h"
 #include "AssimpLoader.h"
 #include "MeshPorter.h"
 #include "../Core/BinaryData.h"
 #include "../Core/ConstantBuffer.h"
 #include "../Core/Material.h"
+#include "../Core/Math.h"
 #include "../Core/Shader.h"
+#include "../Core/WorkerPool.h"
+#include "../Physics/TriangleBVH.h"
+#include <DirectXPackedVector.h>
 
 using std::max;
 using std::min;
@@ -12,6 +17,51 @@ using std::vector;
 using std::string;
 using std::to_string;
 using std::make_unique;
+using std::sort;
+
+static constexpr uint32_t KInvalidAnimationKey{ UINT32_MAX };
+static constexpr uint32_t KMaxAnimationKeyCursorSteps{ 4 };
+
+// Returns the index of the last key whose time is <= AnimationTick (KInvalidAnimationKey if there's none)
+// Cursor is only a hint (the result of the previous call): it's advanced a few keys while the tick moves forward,
+// and a binary search is done on seeks and loops, so that a channel is evaluated in constant time per frame.
+static uint32_t FindAnimationKey(const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys, float AnimationTick, uint32_t& Cursor)
+{
+	const uint32_t KKeyCount{ (uint32_t)vKeys.size() };
+	if (KKeyCount == 0 || vKeys[0].Time > AnimationTick)
+	{
+		Cursor = 0;
+		return KInvalidAnimationKey;
+	}
+
+	uint32_t First{};
+	if (Cursor < KKeyCount && vKeys[Cursor].Time <= AnimationTick)
+	{
+		for (uint32_t iStep = 0; iStep < KMaxAnimationKeyCursorSteps; ++iStep)
+		{
+			if (Cursor + 1 == KKeyCount || vKeys[Cursor + 1].Time > AnimationTick) return Cursor;
+			++Cursor;
+		}
+		First = Cursor; // the key is ahead of the cursor
+	}
+
+	// @important: vKeys[First].Time <= AnimationTick is kept
+	uint32_t Last{ KKeyCount - 1 };
+	while (First < Last)
+	{
+		uint32_t Middle{ (First + Last + 1) / 2 };
+		if (vKeys[Middle].Time <= AnimationTick)
+		{
+			First = Middle;
+		}
+		else
+		{
+			Last = Middle - 1;
+		}
+	}
+	Cursor = First;
+	return Cursor;
+}
 
 CObject3D::CObject3D(const std::string& Name, ID3D11Device* const PtrDevice, ID3D11DeviceContext* const PtrDeviceContext) :
 	m_Name{ Name }, m_PtrDevice{ PtrDevice }, m_PtrDeviceContext{ PtrDeviceContext }
@@ -65,7 +115,11 @@ void CObject3D::CreateFromFile(const string& FileName, bool bIsModelRigged)
 		// MESH file
 		CMeshPorter MeshPorter{};
 		SMESHData MESHData{};
-		MeshPorter.ImportMESH(m_ModelFileName, MESHData);
+		if (!MeshPorter.ImportMESH(m_ModelFileName, MESHData))
+		{
+			MB_WARN(("모델 파일 [" + m_ModelFileName + "] 을 읽을 수 없습니다.").c_str(), "모델 로드 실패");
+			return;
+		}
 		
 		Create(MESHData);
 	}
@@ -99,6 +153,7 @@ void CObject3D::InitializeModelData()
 	_CreateMaterialTextures();
 	_CreateConstantBuffers();
 	_InitializeAnimationData();
+	_CreateTriangleBVHs();
 
 	for (const CMaterialData& Material : m_Model->vMaterialData)
 	{
@@ -204,6 +259,21 @@ void CObject3D::_CreateConstantBuffers()
 	m_CBMaterial->Create();
 }
 
+void CObject3D::_CreateTriangleBVHs()
+{
+	m_vTriangleBVHs.clear();
+
+	// @important: rigged models are animated, so their bind pose triangles are useless
+	if (m_Model->bIsModelRigged) return;
+
+	m_vTriangleBVHs.reserve(m_Model->vMeshes.size());
+	for (const auto& Mesh : m_Model->vMeshes)
+	{
+		m_vTriangleBVHs.emplace_back(make_unique<CTriangleBVH>());
+		m_vTriangleBVHs.back()->Build(Mesh);
+	}
+}
+
 void CObject3D::CalculateEditorBoundingSphereData()
 {
 	size_t VertexCount{};
@@ -237,10 +307,66 @@ void CObject3D::_InitializeAnimationData()
 	if (m_Model->vAnimations.empty())
 	{
 		m_vAnimationBehaviorStartTicks.clear();
+		m_vAnimationNodeAnimationIndices.clear();
 		return;
 	}
 
 	m_vAnimationBehaviorStartTicks.resize(m_Model->vAnimations.size());
+
+	// @important: keys are replaced by compressed tracks (already compressed animations are skipped)
+	if (m_bShouldCompressAnimations)
+	{
+		CAnimationCompressor AnimationCompressor{};
+		for (auto& Animation : m_Model->vAnimations)
+		{
+			AnimationCompressor.Compress(Animation);
+		}
+	}
+
+	__InitializeAnimationNodeTables();
+}
+
+void CObject3D::__InitializeAnimationNodeTables()
+{
+	const vector<SMeshTreeNode>& vTreeNodes{ m_Model->vTreeNodes };
+
+	m_vAnimationNodeOrder.clear();
+	m_vAnimationNodeParentIndices.assign(vTreeNodes.size(), -1);
+	m_AnimationEvaluationScratch.vNodeTransforms.resize(vTreeNodes.size());
+	if (vTreeNodes.size())
+	{
+		// Breadth-first from the root, so that every parent precedes its children
+		m_vAnimationNodeOrder.reserve(vTreeNodes.size());
+		m_vAnimationNodeOrder.emplace_back(0);
+		for (size_t iOrder = 0; iOrder < m_vAnimationNodeOrder.size(); ++iOrder)
+		{
+			uint32_t NodeIndex{ m_vAnimationNodeOrder[iOrder] };
+			for (auto iChild : vTreeNodes[NodeIndex].vChildNodeIndices)
+			{
+				m_vAnimationNodeParentIndices[iChild] = (int32_t)NodeIndex;
+				m_vAnimationNodeOrder.emplace_back((uint32_t)iChild);
+			}
+		}
+	}
+
+	// @important: only bones are animated
+	m_vAnimationNodeAnimationIndices.resize(m_Model->vAnimations.size());
+	for (size_t iAnimation = 0; iAnimation < m_Model->vAnimations.size(); ++iAnimation)
+	{
+		const SMeshAnimation& Animation{ m_Model->vAnimations[iAnimation] };
+		vector<int32_t>& vNodeAnimationIndices{ m_vAnimationNodeAnimationIndices[iAnimation] };
+		vNodeAnimationIndices.assign(vTreeNodes.size(), -1);
+		for (size_t iNode = 0; iNode < vTreeNodes.size(); ++iNode)
+		{
+			if (!vTreeNodes[iNode].bIsBone) continue;
+
+			auto itNodeAnimation{ Animation.umapNodeAnimationNameToIndex.find(vTreeNodes[iNode].Name) };
+			if (itNodeAnimation == Animation.umapNodeAnimationNameToIndex.end()) continue;
+			if (itNodeAnimation->second >= Animation.vNodeAnimations.size()) continue;
+
+			vNodeAnimationIndices[iNode] = (int32_t)itNodeAnimation->second;
+		}
+	}
 }
 
 void CObject3D::LoadOB3D(const std::string& OB3DFileName, bool bIsRigged)
@@ -250,7 +376,7 @@ void CObject3D::LoadOB3D(const std::string& OB3DFileName, bool bIsRigged)
 	CBinaryData Object3DBinary{};
 	string ReadString{};
 
-	Object3DBinary.LoadFromFile(OB3DFileName);
+	Object3DBinary.MapFile(OB3DFileName);
 
 	// 8B (string) Signature
 	Object3DBinary.ReadSkip(8);
@@ -275,12 +401,16 @@ void CObject3D::LoadOB3D(const std::string& OB3DFileName, bool bIsRigged)
 		// ?? (byte) Mesh bytes
 
 		size_t MeshDataByteCount{ Object3DBinary.ReadUint32() };
-		vector<byte> MeshDataBinary{};
-		Object3DBinary.ReadBytes(MeshDataByteCount, MeshDataBinary);
+		const byte* PtrMeshDataBytes{};
+		Object3DBinary.ReadSpan(MeshDataByteCount, PtrMeshDataBytes);
 		
-		CMeshPorter MeshPorter{ MeshDataBinary };
+		CMeshPorter MeshPorter{ PtrMeshDataBytes, MeshDataByteCount };
 		SMESHData MeshData{};
-		MeshPorter.ReadMESHData(MeshData);
+		if (!MeshPorter.ReadMESHData(MeshData))
+		{
+			MB_WARN(("[" + OB3DFileName + "] 의 모델 데이터를 읽을 수 없습니다.").c_str(), "모델 로드 실패");
+			return;
+		}
 
 		Create(MeshData);
 	}
@@ -704,6 +834,16 @@ void CObject3D::SetAnimationBehaviorStartTick(uint32_t AnimationID, float Behavi
 	m_vAnimationBehaviorStartTicks[AnimationID] = BehaviorStartTick;
 }
 
+void CObject3D::ShouldCompressAnimations(bool bShouldCompress)
+{
+	m_bShouldCompressAnimations = bShouldCompress;
+}
+
+bool CObject3D::ShouldCompressAnimations() const
+{
+	return m_bShouldCompressAnimations;
+}
+
 bool CObject3D::HasAnimations() const
 {
 	return (m_Model->vAnimations.size()) ? true : false;
@@ -755,18 +895,22 @@ const DirectX::XMMATRIX* CObject3D::GetAnimationBoneMatrices() const
 
 bool CObject3D::IsCurrentAnimationRegisteredAs(const SObjectIdentifier& Identifier, EAnimationRegistrationType eRegistrationType) const
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		return IsInstanceCurrentAnimationRegisteredAs(Identifier.InstanceName, eRegistrationType);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 정보 조회 실패")) return false;
+
+		return IsInstanceCurrentAnimationRegisteredAs(GetInstanceIndex(Identifier), eRegistrationType);
 	}
 	return IsObjectCurrentAnimationRegisteredAs(eRegistrationType);
 }
 
 float CObject3D::GetAnimationTick(const SObjectIdentifier& Identifier) const
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		return GetInstanceAnimationTick(Identifier.InstanceName);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 정보 조회 실패")) return 0;
+
+		return GetInstanceAnimationTick(GetInstanceIndex(Identifier));
 	}
 	else
 	{
@@ -776,18 +920,22 @@ float CObject3D::GetAnimationTick(const SObjectIdentifier& Identifier) const
 
 uint32_t CObject3D::GetAnimationID(const SObjectIdentifier& Identifier) const
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		return GetInstanceAnimationID(Identifier.InstanceName);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 정보 조회 실패")) return 0;
+
+		return GetInstanceAnimationID(GetInstanceIndex(Identifier));
 	}
 	return GetObjectAnimationID();
 }
 
 size_t CObject3D::GetAnimationPlayCount(const SObjectIdentifier& Identifier) const
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		return GetInstanceAnimationPlayCount(Identifier.InstanceName);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 정보 조회 실패")) return 0;
+
+		return GetInstanceAnimationPlayCount(GetInstanceIndex(Identifier));
 	}
 	return GetObjectAnimationPlayCount();
 }
@@ -822,37 +970,39 @@ float CObject3D::GetObjectCurrentAnimationBehaviorStartTick() const
 	return GetAnimationBehaviorStartTick(GetObjectAnimationID());
 }
 
-bool CObject3D::IsInstanceCurrentAnimationRegisteredAs(const std::string& InstanceName, EAnimationRegistrationType eRegistrationType) const
+bool CObject3D::IsInstanceCurrentAnimationRegisteredAs(size_t InstanceIndex, EAnimationRegistrationType eRegistrationType) const
 {
-	return GetRegisteredAnimationType(GetInstanceGPUData(InstanceName).CurrAnimID) == eRegistrationType;
+	return GetRegisteredAnimationType(m_vInstanceGPUData[InstanceIndex].CurrAnimID) == eRegistrationType;
 }
 
-float CObject3D::GetInstanceAnimationTick(const std::string& InstanceName) const
+float CObject3D::GetInstanceAnimationTick(size_t InstanceIndex) const
 {
-	return GetInstanceGPUData(InstanceName).AnimTick;
+	return m_vInstanceGPUData[InstanceIndex].AnimTick;
 }
 
-uint32_t CObject3D::GetInstanceAnimationID(const std::string& InstanceName) const
+uint32_t CObject3D::GetInstanceAnimationID(size_t InstanceIndex) const
 {
-	return GetInstanceGPUData(InstanceName).CurrAnimID;
+	return m_vInstanceGPUData[InstanceIndex].CurrAnimID;
 }
 
-size_t CObject3D::GetInstanceAnimationPlayCount(const std::string& InstanceName) const
+size_t CObject3D::GetInstanceAnimationPlayCount(size_t InstanceIndex) const
 {
-	return GetInstanceCPUData(InstanceName).CurrAnimPlayCount;
+	return m_vInstanceCPUData[InstanceIndex].CurrAnimPlayCount;
 }
 
-float CObject3D::GetInstanceCurrentAnimationBehaviorStartTick(const std::string& InstanceName) const
+float CObject3D::GetInstanceCurrentAnimationBehaviorStartTick(size_t InstanceIndex) const
 {
-	return GetAnimationBehaviorStartTick(GetInstanceAnimationID(InstanceName));
+	return GetAnimationBehaviorStartTick(GetInstanceAnimationID(InstanceIndex));
 }
 
 void CObject3D::SetAnimation(const SObjectIdentifier& Identifier, uint32_t AnimationID, 
 	EAnimationOption eAnimationOption, bool bShouldIgnoreCurrentAnimation)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		SetInstanceAnimation(Identifier.InstanceName, AnimationID, eAnimationOption, bShouldIgnoreCurrentAnimation);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 애니메이션 지정 실패")) return;
+
+		SetInstanceAnimation(GetInstanceIndex(Identifier), AnimationID, eAnimationOption, bShouldIgnoreCurrentAnimation);
 	}
 	else
 	{
@@ -863,9 +1013,11 @@ void CObject3D::SetAnimation(const SObjectIdentifier& Identifier, uint32_t Anima
 void CObject3D::SetAnimation(const SObjectIdentifier& Identifier, EAnimationRegistrationType eRegisteredType, 
 	EAnimationOption eAnimationOption, bool bShouldIgnoreCurrentAnimation)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		SetInstanceAnimation(Identifier.InstanceName, eRegisteredType, eAnimationOption, bShouldIgnoreCurrentAnimation);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 애니메이션 지정 실패")) return;
+
+		SetInstanceAnimation(GetInstanceIndex(Identifier), eRegisteredType, eAnimationOption, bShouldIgnoreCurrentAnimation);
 	}
 	else
 	{
@@ -900,15 +1052,29 @@ void CObject3D::SetObjectAnimation(EAnimationRegistrationType eRegisteredType, E
 	SetObjectAnimation(AnimationID, eAnimationOption, bShouldIgnoreCurrentAnimation);
 }
 
-void CObject3D::SetInstanceAnimation(const std::string& InstanceName, uint32_t AnimationID, EAnimationOption eAnimationOption, bool bShouldIgnoreCurrentAnimation)
+void CObject3D::SetInstanceAnimation(const SInstanceHandle& InstanceHandle, uint32_t AnimationID, EAnimationOption eAnimationOption, bool bShouldIgnoreCurrentAnimation)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 애니메이션 지정 실패")) return;
+
+	SetInstanceAnimation(GetInstanceIndex(InstanceHandle), AnimationID, eAnimationOption, bShouldIgnoreCurrentAnimation);
+}
+
+void CObject3D::SetInstanceAnimation(const SInstanceHandle& InstanceHandle, EAnimationRegistrationType eRegisteredType, EAnimationOption eAnimationOption, bool bShouldIgnoreCurrentAnimation)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 애니메이션 지정 실패")) return;
+
+	SetInstanceAnimation(GetInstanceIndex(InstanceHandle), eRegisteredType, eAnimationOption, bShouldIgnoreCurrentAnimation);
+}
+
+void CObject3D::SetInstanceAnimation(size_t InstanceIndex, uint32_t AnimationID, EAnimationOption eAnimationOption, bool bShouldIgnoreCurrentAnimation)
 {
 	size_t AnimationCount{ GetAnimationCount() };
 	if (AnimationCount == 0) return;
 
 	AnimationID = min(AnimationID, static_cast<uint32_t>(AnimationCount - 1));
 
-	auto& InstanceCPUData{ GetInstanceCPUData(InstanceName) };
-	auto& InstanceGPUData{ GetInstanceGPUData(InstanceName) };
+	auto& InstanceCPUData{ m_vInstanceCPUData[InstanceIndex] };
+	auto& InstanceGPUData{ m_vInstanceGPUData[InstanceIndex] };
 	if (!bShouldIgnoreCurrentAnimation)
 	{
 		if (InstanceGPUData.CurrAnimID == AnimationID) return;
@@ -919,30 +1085,37 @@ void CObject3D::SetInstanceAnimation(const std::string& InstanceName, uint32_t A
 	InstanceGPUData.CurrAnimID = AnimationID;
 	InstanceCPUData.CurrAnimPlayCount = 0;
 	InstanceCPUData.eCurrAnimOption = eAnimationOption;
+	MarkInstanceGPUDataDirty(InstanceIndex);
 }
 
-void CObject3D::SetInstanceAnimation(const std::string& InstanceName, EAnimationRegistrationType eRegisteredType, EAnimationOption eAnimationOption, bool bShouldIgnoreCurrentAnimation)
+void CObject3D::SetInstanceAnimation(size_t InstanceIndex, EAnimationRegistrationType eRegisteredType, EAnimationOption eAnimationOption, bool bShouldIgnoreCurrentAnimation)
 {
 	if (m_umapRegisteredAnimationTypeToIndex.find(eRegisteredType) == m_umapRegisteredAnimationTypeToIndex.end()) return;
 	size_t RegisteredAnimationIndex{ m_umapRegisteredAnimationTypeToIndex.at(eRegisteredType) };
 	uint32_t AnimationID{ m_vRegisteredAnimationIDs[RegisteredAnimationIndex] };
-	SetInstanceAnimation(InstanceName, AnimationID, eAnimationOption, bShouldIgnoreCurrentAnimation);
+	SetInstanceAnimation(InstanceIndex, AnimationID, eAnimationOption, bShouldIgnoreCurrentAnimation);
 }
 
 const SComponentTransform& CObject3D::GetTransform(const SObjectIdentifier& Identifier) const
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		return GetInstanceTransform(Identifier.InstanceName);
+		static const SComponentTransform KInvalidComponentTransform{};
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 정보 조회 실패")) return KInvalidComponentTransform;
+
+		return GetInstanceTransform(GetInstanceIndex(Identifier));
 	}
 	return GetTransform();
 }
 
 const SComponentPhysics& CObject3D::GetPhysics(const SObjectIdentifier& Identifier) const
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		return GetInstancePhysics(Identifier.InstanceName);
+		static const SComponentPhysics KInvalidComponentPhysics{};
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 정보 조회 실패")) return KInvalidComponentPhysics;
+
+		return GetInstancePhysics(GetInstanceIndex(Identifier));
 	}
 	return GetPhysics();
 }
@@ -954,18 +1127,23 @@ CObject3D::EFlagsRendering CObject3D::GetRenderingFlags() const
 
 const SBoundingVolume& CObject3D::GetOuterBoundingSphere(const SObjectIdentifier& Identifier) const
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		return GetInstanceOuterBoundingSphere(Identifier.InstanceName);
+		static const SBoundingVolume KInvalidBoundingVolume{};
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 정보 조회 실패")) return KInvalidBoundingVolume;
+
+		return GetInstanceOuterBoundingSphere(GetInstanceIndex(Identifier));
 	}
 	return GetOuterBoundingSphere();
 }
 
 void CObject3D::TranslateTo(const SObjectIdentifier& Identifier, const XMVECTOR& Prime)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		TranslateInstanceTo(Identifier.InstanceName, Prime);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		TranslateInstanceTo(GetInstanceIndex(Identifier), Prime);
 		return;
 	}
 	TranslateTo(Prime);
@@ -973,9 +1151,11 @@ void CObject3D::TranslateTo(const SObjectIdentifier& Identifier, const XMVECTOR&
 
 void CObject3D::RotatePitchTo(const SObjectIdentifier& Identifier, float Prime)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		RotateInstancePitchTo(Identifier.InstanceName, Prime);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		RotateInstancePitchTo(GetInstanceIndex(Identifier), Prime);
 		return;
 	}
 	RotatePitchTo(Prime);
@@ -983,9 +1163,11 @@ void CObject3D::RotatePitchTo(const SObjectIdentifier& Identifier, float Prime)
 
 void CObject3D::RotateYawTo(const SObjectIdentifier& Identifier, float Prime)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		RotateInstanceYawTo(Identifier.InstanceName, Prime);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		RotateInstanceYawTo(GetInstanceIndex(Identifier), Prime);
 		return;
 	}
 	RotateYawTo(Prime);
@@ -993,9 +1175,11 @@ void CObject3D::RotateYawTo(const SObjectIdentifier& Identifier, float Prime)
 
 void CObject3D::RotateRollTo(const SObjectIdentifier& Identifier, float Prime)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		RotateInstanceRollTo(Identifier.InstanceName, Prime);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		RotateInstanceRollTo(GetInstanceIndex(Identifier), Prime);
 		return;
 	}
 	RotateRollTo(Prime);
@@ -1003,9 +1187,11 @@ void CObject3D::RotateRollTo(const SObjectIdentifier& Identifier, float Prime)
 
 void CObject3D::ScaleTo(const SObjectIdentifier& Identifier, const XMVECTOR& Prime)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		ScaleInstanceTo(Identifier.InstanceName, Prime);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		ScaleInstanceTo(GetInstanceIndex(Identifier), Prime);
 		return;
 	}
 	ScaleTo(Prime);
@@ -1013,9 +1199,11 @@ void CObject3D::ScaleTo(const SObjectIdentifier& Identifier, const XMVECTOR& Pri
 
 void CObject3D::Translate(const SObjectIdentifier& Identifier, const XMVECTOR& Delta)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		TranslateInstance(Identifier.InstanceName, Delta);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		TranslateInstance(GetInstanceIndex(Identifier), Delta);
 		return;
 	}
 	Translate(Delta);
@@ -1023,9 +1211,11 @@ void CObject3D::Translate(const SObjectIdentifier& Identifier, const XMVECTOR& D
 
 void CObject3D::RotatePitch(const SObjectIdentifier& Identifier, float Delta)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		RotateInstancePitch(Identifier.InstanceName, Delta);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		RotateInstancePitch(GetInstanceIndex(Identifier), Delta);
 		return;
 	}
 	RotatePitch(Delta);
@@ -1033,9 +1223,11 @@ void CObject3D::RotatePitch(const SObjectIdentifier& Identifier, float Delta)
 
 void CObject3D::RotateYaw(const SObjectIdentifier& Identifier, float Delta)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		RotateInstanceYaw(Identifier.InstanceName, Delta);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		RotateInstanceYaw(GetInstanceIndex(Identifier), Delta);
 		return;
 	}
 	RotateYaw(Delta);
@@ -1043,9 +1235,11 @@ void CObject3D::RotateYaw(const SObjectIdentifier& Identifier, float Delta)
 
 void CObject3D::RotateRoll(const SObjectIdentifier& Identifier, float Delta)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		RotateInstanceRoll(Identifier.InstanceName, Delta);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		RotateInstanceRoll(GetInstanceIndex(Identifier), Delta);
 		return;
 	}
 	RotateRoll(Delta);
@@ -1053,9 +1247,11 @@ void CObject3D::RotateRoll(const SObjectIdentifier& Identifier, float Delta)
 
 void CObject3D::Scale(const SObjectIdentifier& Identifier, const XMVECTOR& Delta)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		ScaleInstance(Identifier.InstanceName, Delta);
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 변환 실패")) return;
+
+		ScaleInstance(GetInstanceIndex(Identifier), Delta);
 		return;
 	}
 	Scale(Delta);
@@ -1063,9 +1259,11 @@ void CObject3D::Scale(const SObjectIdentifier& Identifier, const XMVECTOR& Delta
 
 void CObject3D::SetLinearAcceleration(const SObjectIdentifier& Identifier, const XMVECTOR& Prime)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		GetInstanceCPUData(Identifier.InstanceName).Physics.LinearAcceleration = Prime;
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 물리 설정 실패")) return;
+
+		m_vInstanceCPUData[GetInstanceIndex(Identifier)].Physics.LinearAcceleration = Prime;
 		return;
 	}
 	SetLinearAcceleration(Prime);
@@ -1073,9 +1271,11 @@ void CObject3D::SetLinearAcceleration(const SObjectIdentifier& Identifier, const
 
 void CObject3D::SetLinearVelocity(const SObjectIdentifier& Identifier, const XMVECTOR& Prime)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		GetInstanceCPUData(Identifier.InstanceName).Physics.LinearVelocity = Prime;
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 물리 설정 실패")) return;
+
+		m_vInstanceCPUData[GetInstanceIndex(Identifier)].Physics.LinearVelocity = Prime;
 		return;
 	}
 	SetLinearVelocity(Prime);
@@ -1083,9 +1283,11 @@ void CObject3D::SetLinearVelocity(const SObjectIdentifier& Identifier, const XMV
 
 void CObject3D::AddLinearAcceleration(const SObjectIdentifier& Identifier, const XMVECTOR& Delta)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		GetInstanceCPUData(Identifier.InstanceName).Physics.LinearAcceleration += Delta;
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 물리 설정 실패")) return;
+
+		m_vInstanceCPUData[GetInstanceIndex(Identifier)].Physics.LinearAcceleration += Delta;
 		return;
 	}
 	AddLinearAcceleration(Delta);
@@ -1093,9 +1295,11 @@ void CObject3D::AddLinearAcceleration(const SObjectIdentifier& Identifier, const
 
 void CObject3D::AddLinearVelocity(const SObjectIdentifier& Identifier, const XMVECTOR& Delta)
 {
-	if (Identifier.InstanceName.size())
+	if (Identifier.IsInstance())
 	{
-		GetInstanceCPUData(Identifier.InstanceName).Physics.LinearVelocity += Delta;
+		if (!CheckInstanceIdentifier(Identifier, "인스턴스 물리 설정 실패")) return;
+
+		m_vInstanceCPUData[GetInstanceIndex(Identifier)].Physics.LinearVelocity += Delta;
 		return;
 	}
 	AddLinearVelocity(Delta);
@@ -1146,6 +1350,59 @@ std::vector<SBoundingVolume>& CObject3D::GetInnerBoundingVolumeVector()
 	return m_vInnerBoundingVolumes;
 }
 
+bool CObject3D::HasTriangleBVHs() const
+{
+	return (m_vTriangleBVHs.size() ? true : false);
+}
+
+size_t CObject3D::GetTriangleBVHCount() const
+{
+	return m_vTriangleBVHs.size();
+}
+
+const CTriangleBVH& CObject3D::GetTriangleBVH(size_t MeshIndex) const
+{
+	return *m_vTriangleBVHs[MeshIndex];
+}
+
+bool CObject3D::RayCastTriangles(const XMMATRIX& WorldMatrix, const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection,
+	XMVECTOR* const OutPtrT, XMVECTOR* const OutPtrTriangleVertices) const
+{
+	// @important: the direction is not normalized, so that T is the same in both spaces
+	XMMATRIX InverseWorldMatrix{ XMMatrixInverse(nullptr, WorldMatrix) };
+	XMVECTOR ModelRayOrigin{ XMVector3TransformCoord(RayOrigin, InverseWorldMatrix) };
+	XMVECTOR ModelRayDirection{ XMVector3TransformNormal(RayDirection, InverseWorldMatrix) };
+
+	float ClosestT{ FLT_MAX };
+	size_t HitMeshIndex{};
+	uint32_t HitTriangleIndex{};
+	bool bHit{ false };
+	for (size_t iMesh = 0; iMesh < m_vTriangleBVHs.size(); ++iMesh)
+	{
+		float T{};
+		uint32_t TriangleIndex{};
+		if (m_vTriangleBVHs[iMesh]->RayCast(ModelRayOrigin, ModelRayDirection, &T, &TriangleIndex) && T < ClosestT)
+		{
+			ClosestT = T;
+			HitMeshIndex = iMesh;
+			HitTriangleIndex = TriangleIndex;
+			bHit = true;
+		}
+	}
+	if (!bHit) return false;
+
+	if (OutPtrT) *OutPtrT = XMVectorReplicate(ClosestT);
+	if (OutPtrTriangleVertices)
+	{
+		m_vTriangleBVHs[HitMeshIndex]->GetTriangle(HitTriangleIndex, OutPtrTriangleVertices[0], OutPtrTriangleVertices[1], OutPtrTriangleVertices[2]);
+		for (size_t iVertex = 0; iVertex < 3; ++iVertex)
+		{
+			OutPtrTriangleVertices[iVertex] = XMVector3TransformCoord(OutPtrTriangleVertices[iVertex], WorldMatrix);
+		}
+	}
+	return true;
+}
+
 void CObject3D::TranslateTo(const XMVECTOR& Prime)
 {
 	m_ComponentTransform.Translation = Prime;
@@ -1226,7 +1483,7 @@ bool CObject3D::CanBakeAnimationTexture() const
 	return !m_bIsBakedAnimationLoaded;
 }
 
-void CObject3D::BakeAnimationTexture()
+void CObject3D::BakeAnimationTexture(EAnimationTextureLayout eLayout)
 {
 	if (m_Model->vAnimations.empty()) return;
 
@@ -1240,14 +1497,18 @@ void CObject3D::BakeAnimationTexture()
 		vAnimationHeights.emplace_back((int32_t)Animation.Duration + 1);
 		TextureHeight += vAnimationHeights.back();
 	}
+	if (eLayout == EAnimationTextureLayout::Affine3x4Half && TextureHeight > KMaxHalfAnimationTextureHeight) eLayout = EAnimationTextureLayout::Affine3x4;
 
-	m_BakedAnimationTexture = make_unique<CTexture>(m_PtrDevice, m_PtrDeviceContext);
-	m_BakedAnimationTexture->CreateBlankTexture(CTexture::EFormat::Pixel128Float, XMFLOAT2((float)KAnimationTextureWidth, (float)TextureHeight));
-	m_BakedAnimationTexture->SetShaderType(EShaderType::VertexShader);
+	// @important: packed layouts are as wide as the skeleton (but at least as wide as the header)
+	const bool KIsPacked{ eLayout != EAnimationTextureLayout::Matrix4x4 };
+	const uint32_t KBoneCount{ (KIsPacked && m_Model->ModelBoneCount) ? min(m_Model->ModelBoneCount, KMaxBoneMatrixCount) : KMaxBoneMatrixCount };
+	const int32_t KInfoPixelCount{ (KIsPacked) ? KAnimationTexturePackedInfoPixelCount : KAnimationTextureInfoPixelCount };
+	const int32_t KTextureWidth{ (KIsPacked) ?
+		max((int32_t)KBoneCount * 3, KAnimationTextureReservedFirstPixelCount + AnimationCount * KInfoPixelCount) : KAnimationTextureWidth };
 
 	vector<SPixel128Float> vRawData{};
 	
-	vRawData.resize((int64_t)KAnimationTextureWidth * TextureHeight);
+	vRawData.resize((int64_t)KTextureWidth * TextureHeight);
 	vRawData[0].R = 'A';
 	vRawData[0].G = 'N';
 	vRawData[0].B = 'I';
@@ -1255,51 +1516,104 @@ void CObject3D::BakeAnimationTexture()
 
 	float fAnimationCount{ (float)AnimationCount };
 	memcpy(&vRawData[1].R, &fAnimationCount, sizeof(float));
+	if (KIsPacked)
+	{
+		vRawData[1].G = (float)KBoneCount;
+		vRawData[1].B = (float)eLayout;
+	}
+
+	vector<SAnimationBakeSample> vSamples{};
+	vSamples.reserve((size_t)TextureHeight - KAnimationTextureReservedHeight);
 
 	int32_t AnimationHeightSum{ KAnimationTextureReservedHeight };
 	for (int32_t iAnimation = 0; iAnimation < (int32_t)vAnimationHeights.size(); ++iAnimation)
 	{
+		const SMeshAnimation& Animation{ m_Model->vAnimations[iAnimation] };
+		const int64_t KInfoPixelIndex{ (int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * KInfoPixelCount };
+
 		float fAnimationHeightSum{ (float)AnimationHeightSum };
-		memcpy(&vRawData[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 0].R,
-			&fAnimationHeightSum, sizeof(float));
-		memcpy(&vRawData[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 0].G,
-			&m_Model->vAnimations[iAnimation].Duration, sizeof(float));
-		memcpy(&vRawData[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 0].B,
-			&m_Model->vAnimations[iAnimation].TicksPerSecond, sizeof(float));
+		memcpy(&vRawData[KInfoPixelIndex + 0].R, &fAnimationHeightSum, sizeof(float));
+		memcpy(&vRawData[KInfoPixelIndex + 0].G, &Animation.Duration, sizeof(float));
+		memcpy(&vRawData[KInfoPixelIndex + 0].B, &Animation.TicksPerSecond, sizeof(float));
 		//A
 
-		// RGBA = 4 floats = 16 chars!
-		memcpy(&vRawData[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 1].R,
-			m_Model->vAnimations[iAnimation].Name.c_str(), sizeof(char) * 16);
+		if (KIsPacked)
+		{
+			// A character per channel, so that the name survives half precision
+			// (durations are rounded down to whole ticks in half precision, so that the shader never reads past the animation)
+			if (eLayout == EAnimationTextureLayout::Affine3x4Half) vRawData[KInfoPixelIndex + 0].G = (float)(vAnimationHeights[iAnimation] - 1);
+
+			float* const PtrName{ &vRawData[KInfoPixelIndex + 1].R };
+			for (size_t iCharacter = 0; iCharacter < min(Animation.Name.size(), (size_t)16); ++iCharacter)
+			{
+				PtrName[iCharacter] = (float)(uint8_t)Animation.Name[iCharacter];
+			}
+		}
+		else
+		{
+			// RGBA = 4 floats = 16 chars!
+			memcpy(&vRawData[KInfoPixelIndex + 1].R, Animation.Name.c_str(), sizeof(char) * 16);
+		}
+
+		for (int32_t iTime = 0; iTime < vAnimationHeights[iAnimation]; ++iTime)
+		{
+			vSamples.emplace_back(SAnimationBakeSample{ (uint32_t)iAnimation, (uint32_t)iTime, (uint32_t)(AnimationHeightSum + iTime) });
+		}
 
 		AnimationHeightSum += vAnimationHeights[iAnimation];
 	}
 
-	for (int32_t iAnimation = 0; iAnimation < (int32_t)m_Model->vAnimations.size(); ++iAnimation)
+	// Every row is independent of the others
+	CWorkerPool WorkerPool{};
+	WorkerPool.Create();
+	vector<SAnimationEvaluationScratch> vScratches(WorkerPool.GetThreadCount());
+	SAnimationBakeContext BakeContext{ this, &vSamples, &vScratches, &vRawData[0], (uint32_t)KTextureWidth, KBoneCount, eLayout };
+	WorkerPool.ParallelFor(vSamples.size(), KAnimationBakeGrainSize, BakeAnimationTextureJob, &BakeContext);
+	WorkerPool.Destroy();
+
+	m_BakedAnimationTexture = make_unique<CTexture>(m_PtrDevice, m_PtrDeviceContext);
+	if (eLayout == EAnimationTextureLayout::Affine3x4Half)
 	{
-		float fAnimationOffset{};
-		memcpy(&fAnimationOffset, &vRawData[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 0].R, sizeof(float));
+		vector<SPixel64Float> vHalfRawData(vRawData.size());
+		PackedVector::XMConvertFloatToHalfStream(&vHalfRawData[0].R, sizeof(uint16_t), &vRawData[0].R, sizeof(float), vRawData.size() * 4);
 
-		const int32_t KAnimationYOffset{ (int32_t)fAnimationOffset };
-		const int32_t KAnimationOffset{ (int32_t)((int64_t)KAnimationYOffset * KAnimationTextureWidth) };
-		const SMeshAnimation& Animation{ m_Model->vAnimations[iAnimation] };
-		
-		int32_t Duration{ (int32_t)Animation.Duration + 1 };
-		for (int32_t iTime = 0; iTime < Duration; ++iTime)
-		{
-			const int32_t KTimeOffset{ (int32_t)((int64_t)iTime * KAnimationTextureWidth) };
-			CalculateAnimatedBoneMatrices(Animation, (float)iTime, m_Model->vTreeNodes[0], XMMatrixIdentity());
+		m_BakedAnimationTexture->CreateBlankTexture(CTexture::EFormat::Pixel64Float, XMFLOAT2((float)KTextureWidth, (float)TextureHeight));
+		m_BakedAnimationTexture->UpdateTextureRawData(&vHalfRawData[0]);
+	}
+	else
+	{
+		m_BakedAnimationTexture->CreateBlankTexture(CTexture::EFormat::Pixel128Float, XMFLOAT2((float)KTextureWidth, (float)TextureHeight));
+		m_BakedAnimationTexture->UpdateTextureRawData(&vRawData[0]);
+	}
+	m_BakedAnimationTexture->SetShaderType(EShaderType::VertexShader);
+}
+
+void CObject3D::BakeAnimationTextureJob(void* Context, size_t Begin, size_t End, size_t WorkerIndex)
+{
+	const SAnimationBakeContext* const BakeContext{ static_cast<const SAnimationBakeContext*>(Context) };
+	SAnimationEvaluationScratch& Scratch{ (*BakeContext->PtrScratches)[WorkerIndex] };
+
+	XMMATRIX BoneMatrices[KMaxBoneMatrixCount]{};
+	for (size_t iSample = Begin; iSample < End; ++iSample)
+	{
+		const SAnimationBakeSample& Sample{ (*BakeContext->PtrSamples)[iSample] };
+		BakeContext->PtrObject3D->_CalculateAnimatedBoneMatrices(Sample.AnimationID, (float)Sample.Tick, BoneMatrices, Scratch);
 
-			for (int32_t iBoneMatrix = 0; iBoneMatrix < (int32_t)KMaxBoneMatrixCount; ++iBoneMatrix)
+		SPixel128Float* const PtrRow{ BakeContext->PtrRawData + (size_t)Sample.Row * BakeContext->TextureWidth };
+		for (uint32_t iBoneMatrix = 0; iBoneMatrix < BakeContext->BoneCount; ++iBoneMatrix)
+		{
+			if (BakeContext->eLayout == EAnimationTextureLayout::Matrix4x4)
 			{
-				const auto& BoneMatrix{ m_AnimatedBoneMatrices[iBoneMatrix] };
-				XMMATRIX TransposedBoneMatrix{ XMMatrixTranspose(BoneMatrix) };
-				memcpy(&vRawData[(int64_t)KAnimationOffset + KTimeOffset + (int64_t)iBoneMatrix * 4].R, &TransposedBoneMatrix, sizeof(XMMATRIX));
+				XMMATRIX TransposedBoneMatrix{ XMMatrixTranspose(BoneMatrices[iBoneMatrix]) };
+				memcpy(&PtrRow[(size_t)iBoneMatrix * 4].R, &TransposedBoneMatrix, sizeof(XMMATRIX));
+			}
+			else
+			{
+				// @important: bone matrices are affine, the first 3 rows of the transposed matrix are enough
+				memcpy(&PtrRow[(size_t)iBoneMatrix * 3].R, &BoneMatrices[iBoneMatrix], sizeof(XMVECTOR) * 3);
 			}
 		}
 	}
-
-	m_BakedAnimationTexture->UpdateTextureRawData(&vRawData[0]);
 }
 
 void CObject3D::SaveBakedAnimationTexture(const string& FileName)
@@ -1333,9 +1647,22 @@ void CObject3D::LoadBakedAnimationTexture(const string& FileName)
 	D3D11_MAPPED_SUBRESOURCE MappedSubresource{};
 	if (SUCCEEDED(m_PtrDeviceContext->Map(ReadableAnimationTexture.Get(), 0, D3D11_MAP_READ, 0, &MappedSubresource)))
 	{
+		// Header row
 		vector<SPixel128Float> vPixels{};
-		vPixels.resize(KAnimationTextureWidth);
-		memcpy(&vPixels[0], MappedSubresource.pData, sizeof(SPixel128Float) * KAnimationTextureWidth);
+		vPixels.resize(AnimationTextureDesc.Width);
+		if (AnimationTextureDesc.Format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+		{
+			PackedVector::XMConvertHalfToFloatStream(&vPixels[0].R, sizeof(float),
+				(const PackedVector::HALF*)MappedSubresource.pData, sizeof(PackedVector::HALF), vPixels.size() * 4);
+		}
+		else
+		{
+			memcpy(&vPixels[0], MappedSubresource.pData, sizeof(SPixel128Float) * vPixels.size());
+		}
+
+		// @important: Matrix4x4 textures (the original layout) have 0 here
+		const bool KIsPacked{ (EAnimationTextureLayout)(uint32_t)vPixels[1].B != EAnimationTextureLayout::Matrix4x4 };
+		const int32_t KInfoPixelCount{ (KIsPacked) ? KAnimationTexturePackedInfoPixelCount : KAnimationTextureInfoPixelCount };
 
 		// Animation count
 		m_Model->vAnimations.clear();
@@ -1343,19 +1670,25 @@ void CObject3D::LoadBakedAnimationTexture(const string& FileName)
 
 		for (int32_t iAnimation = 0; iAnimation < (int32_t)m_Model->vAnimations.size(); ++iAnimation)
 		{
-			m_Model->vAnimations[iAnimation].Duration = vPixels[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 0].G;
-			m_Model->vAnimations[iAnimation].TicksPerSecond = vPixels[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 0].B;
+			const int64_t KInfoPixelIndex{ (int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * KInfoPixelCount };
+			if (KInfoPixelIndex + KInfoPixelCount > (int64_t)vPixels.size()) break;
 
-			float NameR{ vPixels[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 1].R };
-			float NameG{ vPixels[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 1].G };
-			float NameB{ vPixels[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 1].B };
-			float NameA{ vPixels[(int64_t)KAnimationTextureReservedFirstPixelCount + (int64_t)iAnimation * 2 + 1].A };
+			m_Model->vAnimations[iAnimation].Duration = vPixels[KInfoPixelIndex + 0].G;
+			m_Model->vAnimations[iAnimation].TicksPerSecond = vPixels[KInfoPixelIndex + 0].B;
 
-			char Name[16]{};
-			memcpy(&Name[0], &NameR, 4);
-			memcpy(&Name[4], &NameG, 4);
-			memcpy(&Name[8], &NameB, 4);
-			memcpy(&Name[12], &NameA, 4);
+			char Name[17]{};
+			if (KIsPacked)
+			{
+				const float* const PtrName{ &vPixels[KInfoPixelIndex + 1].R };
+				for (size_t iCharacter = 0; iCharacter < 16; ++iCharacter)
+				{
+					Name[iCharacter] = (char)(uint8_t)PtrName[iCharacter];
+				}
+			}
+			else
+			{
+				memcpy(&Name[0], &vPixels[KInfoPixelIndex + 1].R, 16);
+			}
 
 			m_Model->vAnimations[iAnimation].Name = Name;
 		}
@@ -1416,6 +1749,10 @@ void CObject3D::CreateInstances(const std::vector<SObject3DInstanceCPUData>& vIn
 	m_vInstanceGPUData = vInstanceGPUData;
 
 	m_mapInstanceNameToIndex.clear();
+	ReleaseAllInstanceSlots();
+	m_vInstanceDirtyFlags.assign(m_vInstanceCPUData.size(), 0);
+	m_vDirtyInstanceIndices.clear();
+	MarkAllInstancesDirty();
 	for (size_t iInstance = 0; iInstance < m_vInstanceCPUData.size(); ++iInstance)
 	{
 		auto& InstanceCPUData{ m_vInstanceCPUData[iInstance] };
@@ -1426,6 +1763,7 @@ void CObject3D::CreateInstances(const std::vector<SObject3DInstanceCPUData>& vIn
 		InstanceCPUData.EditorBoundingSphere.Data.BS.Radius = InstanceCPUData.EditorBoundingSphere.Data.BS.RadiusBias * MaxScaling; // @important
 
 		m_mapInstanceNameToIndex[InstanceCPUData.Name] = iInstance;
+		AllocateInstanceSlot();
 	}
 
 	CreateInstanceBuffers();
@@ -1486,8 +1824,6 @@ bool CObject3D::InsertInstance(const string& InstanceName)
 		return false;
 	}
 
-	bool bShouldRecreateInstanceBuffer{ m_vInstanceCPUData.size() == m_vInstanceCPUData.capacity() };
-
 	std::string LimitedName{ InstanceName };
 	if (LimitedName.length() >= SObject3DInstanceCPUData::KMaxNameLengthZeroTerminated)
 	{
@@ -1506,17 +1842,108 @@ bool CObject3D::InsertInstance(const string& InstanceName)
 	m_vInstanceCPUData.back().Transform.Roll = m_ComponentTransform.Roll;
 	m_vInstanceCPUData.back().EditorBoundingSphere = m_OuterBoundingSphere; // @important
 	m_mapInstanceNameToIndex[LimitedName] = m_vInstanceCPUData.size() - 1;
+	AllocateInstanceSlot();
+	m_vInstanceDirtyFlags.emplace_back(0);
+	MarkInstanceMoved(m_vInstanceCPUData.size() - 1);
 
 	m_vInstanceGPUData.emplace_back();
 
-	if (m_vInstanceCPUData.size() == 1) CreateInstanceBuffers();
-	if (bShouldRecreateInstanceBuffer) CreateInstanceBuffers();
+	// @important: the instance buffers (and the upload ring) are as large as the capacity of m_vInstanceGPUData
+	if (m_vInstanceBuffers.empty() || m_vInstanceGPUData.size() > m_InstanceBufferCapacity) CreateInstanceBuffers();
 
-	UpdateInstanceWorldMatrix(LimitedName);
+	UpdateInstanceWorldMatrix(m_vInstanceCPUData.size() - 1);
 
 	return true;
 }
 
+size_t CObject3D::InsertInstances(const std::vector<SComponentTransform>& vTransforms, const std::vector<std::string>& vInstanceNames)
+{
+	if (vTransforms.empty()) return 0;
+	if (vInstanceNames.size() && vInstanceNames.size() != vTransforms.size()) return 0;
+	if (GetInstanceCount() + vTransforms.size() >= 100'000) return 0; // TOO MANY INSTANCES
+
+	// @important: grow geometrically, since the instance buffers are recreated whenever the capacity of m_vInstanceGPUData grows
+	size_t NewInstanceCount{ GetInstanceCount() + vTransforms.size() };
+	if (NewInstanceCount > m_vInstanceGPUData.capacity())
+	{
+		size_t NewCapacity{ max(NewInstanceCount, m_vInstanceGPUData.capacity() * 2) };
+		m_vInstanceCPUData.reserve(NewCapacity);
+		m_vInstanceGPUData.reserve(NewCapacity);
+		m_vInstanceSlotIndices.reserve(NewCapacity);
+		m_vInstanceDirtyFlags.reserve(NewCapacity);
+	}
+	m_vDirtyInstanceIndices.reserve(m_vDirtyInstanceIndices.size() + vTransforms.size());
+
+	size_t InsertedCount{};
+	size_t TruncatedNameCount{};
+	size_t SkippedNameCount{};
+	size_t AutoGeneratedNameIndex{ GetInstanceCount() };
+	for (size_t iTransform = 0; iTransform < vTransforms.size(); ++iTransform)
+	{
+		size_t InstanceIndex{ m_vInstanceCPUData.size() };
+
+		// @important: a single map insertion per instance, it fails if the name already exists
+		string InstanceName{};
+		if (vInstanceNames.empty())
+		{
+			do
+			{
+				InstanceName = "inst" + to_string(AutoGeneratedNameIndex++);
+			} while (!m_mapInstanceNameToIndex.emplace(InstanceName, InstanceIndex).second);
+		}
+		else
+		{
+			InstanceName = vInstanceNames[iTransform];
+			if (InstanceName.length() >= SObject3DInstanceCPUData::KMaxNameLengthZeroTerminated)
+			{
+				InstanceName.resize(SObject3DInstanceCPUData::KMaxNameLengthZeroTerminated - 1);
+				++TruncatedNameCount;
+			}
+			if (!m_mapInstanceNameToIndex.emplace(InstanceName, InstanceIndex).second)
+			{
+				++SkippedNameCount;
+				continue;
+			}
+		}
+
+		m_vInstanceCPUData.emplace_back();
+		m_vInstanceCPUData.back().Name = InstanceName;
+		m_vInstanceCPUData.back().Transform = vTransforms[iTransform];
+		m_vInstanceCPUData.back().EditorBoundingSphere = m_OuterBoundingSphere; // @important
+		AllocateInstanceSlot();
+		m_vInstanceDirtyFlags.emplace_back(0);
+		MarkInstanceDirty(InstanceIndex);
+
+		m_vInstanceGPUData.emplace_back();
+
+		++InsertedCount;
+	}
+
+	// @important: a single warning for the whole insertion (there can be thousands of names)
+	if (TruncatedNameCount || SkippedNameCount)
+	{
+		MB_WARN(("인스턴스 " + to_string(vTransforms.size()) + "개 중\n" +
+			"- 이름이 최대 길이(" + to_string(SObject3DInstanceCPUData::KMaxNameLengthZeroTerminated - 1) + " 자)를 넘어 잘린 인스턴스: " +
+			to_string(TruncatedNameCount) + "개\n" +
+			"- 같은 이름의 인스턴스가 이미 존재해 생성되지 않은 인스턴스: " + to_string(SkippedNameCount) + "개").c_str(), "인스턴스 생성");
+	}
+	if (InsertedCount == 0) return 0;
+
+	UpdateDirtyInstanceWorldMatrices();
+
+	// @important: recreated instance buffers already have all the data in them
+	if (m_vInstanceBuffers.empty() || m_vInstanceGPUData.size() > m_InstanceBufferCapacity)
+	{
+		CreateInstanceBuffers();
+	}
+	else
+	{
+		UpdateInstanceBuffers();
+	}
+
+	return InsertedCount;
+}
+
 void CObject3D::DeleteInstance(const string& InstanceName)
 {
 	if (m_vInstanceCPUData.empty()) return;
@@ -1535,11 +1962,13 @@ void CObject3D::DeleteInstance(const string& InstanceName)
 	string SavedName{ InstanceName };
 	size_t iInstance{ m_mapInstanceNameToIndex.at(SavedName) };
 	size_t iLastInstance{ GetInstanceCount() - 1 };
+	ReleaseInstanceSlot(iInstance);
 	if (iInstance == iLastInstance)
 	{
 		// End instance
 		m_vInstanceCPUData.pop_back();
 		m_vInstanceGPUData.pop_back();
+		m_vInstanceDirtyFlags.pop_back();
 
 		m_mapInstanceNameToIndex.erase(SavedName);
 
@@ -1553,22 +1982,140 @@ void CObject3D::DeleteInstance(const string& InstanceName)
 
 		std::swap(m_vInstanceCPUData[iInstance], m_vInstanceCPUData[iLastInstance]);
 		std::swap(m_vInstanceGPUData[iInstance], m_vInstanceGPUData[iLastInstance]);
+		std::swap(m_vInstanceDirtyFlags[iInstance], m_vInstanceDirtyFlags[iLastInstance]);
 
 		m_vInstanceCPUData.pop_back();
 		m_vInstanceGPUData.pop_back();
+		m_vInstanceDirtyFlags.pop_back();
+		if (m_vInstanceDirtyFlags[iInstance]) m_vDirtyInstanceIndices.emplace_back((uint32_t)iInstance);
+		MarkInstanceMoved(iInstance); // @important: another instance took this index
 
 		m_mapInstanceNameToIndex.erase(SavedName);
 		m_mapInstanceNameToIndex[LastInstanceName] = iInstance;
 
+		MarkInstanceGPUDataDirty(iInstance);
 		UpdateInstanceBuffers();
 	}
 }
 
+void CObject3D::DeleteInstance(const SInstanceHandle& InstanceHandle)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 삭제 실패")) return;
+
+	// @important: copy the name, since its storage is swapped away
+	string InstanceName{ m_vInstanceCPUData[GetInstanceIndex(InstanceHandle)].Name };
+	DeleteInstance(InstanceName);
+}
+
 void CObject3D::ClearInstances()
 {
 	m_vInstanceCPUData.clear();
 	m_vInstanceGPUData.clear();
 	m_mapInstanceNameToIndex.clear();
+	ReleaseAllInstanceSlots();
+	m_vInstanceDirtyFlags.clear();
+	m_vDirtyInstanceIndices.clear();
+	m_vGPUDirtyInstanceIndices.clear();
+	m_bShouldUploadAllInstances = false;
+	MarkAllInstancesMoved();
+}
+
+SInstanceHandle CObject3D::GetInstanceHandle(const std::string& InstanceName) const
+{
+	if (m_mapInstanceNameToIndex.find(InstanceName) == m_mapInstanceNameToIndex.end()) return SInstanceHandle();
+	return GetInstanceHandle(m_mapInstanceNameToIndex.at(InstanceName));
+}
+
+SInstanceHandle CObject3D::GetInstanceHandle(size_t InstanceIndex) const
+{
+	if (InstanceIndex >= m_vInstanceSlotIndices.size()) return SInstanceHandle();
+
+	SInstanceHandle Result{};
+	Result.Slot = m_vInstanceSlotIndices[InstanceIndex];
+	Result.Generation = m_vInstanceSlots[Result.Slot].Generation;
+	return Result;
+}
+
+SInstanceHandle CObject3D::GetLastInstanceHandle() const
+{
+	if (m_vInstanceCPUData.empty()) return SInstanceHandle();
+	return GetInstanceHandle(m_vInstanceCPUData.size() - 1);
+}
+
+bool CObject3D::IsInstanceHandleValid(const SInstanceHandle& InstanceHandle) const
+{
+	if (InstanceHandle.Slot >= (uint32_t)m_vInstanceSlots.size()) return false;
+	return (m_vInstanceSlots[InstanceHandle.Slot].Generation == InstanceHandle.Generation);
+}
+
+bool CObject3D::CheckInstanceHandle(const SInstanceHandle& InstanceHandle, const char* const FailureTitle) const
+{
+	if (IsInstanceHandleValid(InstanceHandle)) return true;
+
+	MB_WARN("해당 인스턴스는 존재하지 않습니다.", FailureTitle);
+	return false;
+}
+
+bool CObject3D::CheckInstanceIdentifier(const SObjectIdentifier& Identifier, const char* const FailureTitle) const
+{
+	// @important: name-based identifiers are looked up as before
+	if (Identifier.InstanceHandle.IsNull()) return true;
+	return CheckInstanceHandle(Identifier.InstanceHandle, FailureTitle);
+}
+
+size_t CObject3D::GetInstanceIndex(const SInstanceHandle& InstanceHandle) const
+{
+	assert(IsInstanceHandleValid(InstanceHandle));
+	return m_vInstanceSlots[InstanceHandle.Slot].InstanceIndex;
+}
+
+size_t CObject3D::GetInstanceIndex(const SObjectIdentifier& Identifier) const
+{
+	if (!Identifier.InstanceHandle.IsNull()) return GetInstanceIndex(Identifier.InstanceHandle);
+	return GetInstanceIndex(Identifier.InstanceName);
+}
+
+void CObject3D::AllocateInstanceSlot()
+{
+	// @important: the new instance is the last one
+	uint32_t InstanceIndex{ (uint32_t)m_vInstanceSlotIndices.size() };
+	uint32_t Slot{};
+	if (m_vFreeInstanceSlots.size())
+	{
+		Slot = m_vFreeInstanceSlots.back();
+		m_vFreeInstanceSlots.pop_back();
+	}
+	else
+	{
+		Slot = (uint32_t)m_vInstanceSlots.size();
+		m_vInstanceSlots.emplace_back();
+	}
+	m_vInstanceSlots[Slot].InstanceIndex = InstanceIndex;
+	m_vInstanceSlotIndices.emplace_back(Slot);
+}
+
+void CObject3D::ReleaseInstanceSlot(size_t InstanceIndex)
+{
+	// @important: mirrors the swap & pop of the instance data
+	size_t LastInstanceIndex{ m_vInstanceSlotIndices.size() - 1 };
+	uint32_t Slot{ m_vInstanceSlotIndices[InstanceIndex] };
+	uint32_t LastSlot{ m_vInstanceSlotIndices[LastInstanceIndex] };
+	m_vInstanceSlots[LastSlot].InstanceIndex = (uint32_t)InstanceIndex;
+	m_vInstanceSlotIndices[InstanceIndex] = LastSlot;
+	m_vInstanceSlotIndices.pop_back();
+
+	++m_vInstanceSlots[Slot].Generation; // every handle of the slot is now stale
+	m_vFreeInstanceSlots.emplace_back(Slot);
+}
+
+void CObject3D::ReleaseAllInstanceSlots()
+{
+	for (uint32_t Slot : m_vInstanceSlotIndices)
+	{
+		++m_vInstanceSlots[Slot].Generation;
+		m_vFreeInstanceSlots.emplace_back(Slot);
+	}
+	m_vInstanceSlotIndices.clear();
 }
 
 bool CObject3D::ChangeInstanceName(const std::string& OldName, const std::string& NewName)
@@ -1595,87 +2142,304 @@ bool CObject3D::ChangeInstanceName(const std::string& OldName, const std::string
 
 void CObject3D::TranslateInstanceTo(const std::string& InstanceName, const XMVECTOR& Prime)
 {
-	GetInstanceCPUData(InstanceName).Transform.Translation = Prime;
+	TranslateInstanceTo(GetInstanceIndex(InstanceName), Prime);
 }
 
 void CObject3D::RotateInstancePitchTo(const std::string& InstanceName, float Prime)
 {
-	GetInstanceCPUData(InstanceName).Transform.Pitch = Prime;
+	RotateInstancePitchTo(GetInstanceIndex(InstanceName), Prime);
 }
 
 void CObject3D::RotateInstanceYawTo(const std::string& InstanceName, float Prime)
 {
-	GetInstanceCPUData(InstanceName).Transform.Yaw = Prime;
+	RotateInstanceYawTo(GetInstanceIndex(InstanceName), Prime);
 }
 
 void CObject3D::RotateInstanceRollTo(const std::string& InstanceName, float Prime)
 {
-	GetInstanceCPUData(InstanceName).Transform.Roll = Prime;
+	RotateInstanceRollTo(GetInstanceIndex(InstanceName), Prime);
 }
 
 void CObject3D::ScaleInstanceTo(const std::string& InstanceName, const XMVECTOR& Prime)
 {
-	GetInstanceCPUData(InstanceName).Transform.Scaling = Prime;
+	ScaleInstanceTo(GetInstanceIndex(InstanceName), Prime);
 }
 
 void CObject3D::TranslateInstance(const std::string& InstanceName, const XMVECTOR& Delta)
 {
-	GetInstanceCPUData(InstanceName).Transform.Translation += Delta;
+	TranslateInstance(GetInstanceIndex(InstanceName), Delta);
 }
 
 void CObject3D::RotateInstancePitch(const std::string& InstanceName, float Delta)
 {
-	GetInstanceCPUData(InstanceName).Transform.Pitch += Delta;
+	RotateInstancePitch(GetInstanceIndex(InstanceName), Delta);
 }
 
 void CObject3D::RotateInstanceYaw(const std::string& InstanceName, float Delta)
 {
-	GetInstanceCPUData(InstanceName).Transform.Yaw += Delta;
+	RotateInstanceYaw(GetInstanceIndex(InstanceName), Delta);
 }
 
 void CObject3D::RotateInstanceRoll(const std::string& InstanceName, float Delta)
 {
-	GetInstanceCPUData(InstanceName).Transform.Roll += Delta;
+	RotateInstanceRoll(GetInstanceIndex(InstanceName), Delta);
 }
 
 void CObject3D::ScaleInstance(const std::string& InstanceName, const XMVECTOR& Delta)
 {
-	GetInstanceCPUData(InstanceName).Transform.Scaling += Delta;
+	ScaleInstance(GetInstanceIndex(InstanceName), Delta);
 }
 
 void CObject3D::SetInstanceLinearAcceleration(const std::string& InstanceName, const XMVECTOR& Prime)
 {
-	GetInstanceCPUData(InstanceName).Physics.LinearAcceleration = Prime;
+	SetInstanceLinearAcceleration(GetInstanceIndex(InstanceName), Prime);
 }
 
 void CObject3D::SetInstanceLinearVelocity(const std::string& InstanceName, const XMVECTOR& Prime)
 {
-	GetInstanceCPUData(InstanceName).Physics.LinearVelocity = Prime;
+	SetInstanceLinearVelocity(GetInstanceIndex(InstanceName), Prime);
 }
 
 void CObject3D::AddInstanceLinearAcceleration(const std::string& InstanceName, const XMVECTOR& Delta)
 {
-	GetInstanceCPUData(InstanceName).Physics.LinearAcceleration += Delta;
+	AddInstanceLinearAcceleration(GetInstanceIndex(InstanceName), Delta);
 }
 
 void CObject3D::AddInstanceLinearVelocity(const std::string& InstanceName, const XMVECTOR& Delta)
 {
-	GetInstanceCPUData(InstanceName).Physics.LinearVelocity += Delta;
+	AddInstanceLinearVelocity(GetInstanceIndex(InstanceName), Delta);
 }
 
-const SComponentTransform& CObject3D::GetInstanceTransform(const std::string& InstanceName) const
+void CObject3D::TranslateInstanceTo(const SInstanceHandle& InstanceHandle, const XMVECTOR& Prime)
 {
-	return GetInstanceCPUData(InstanceName).Transform;
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	TranslateInstanceTo(GetInstanceIndex(InstanceHandle), Prime);
 }
 
-const SComponentPhysics& CObject3D::GetInstancePhysics(const std::string& InstanceName) const
+void CObject3D::RotateInstancePitchTo(const SInstanceHandle& InstanceHandle, float Prime)
 {
-	return GetInstanceCPUData(InstanceName).Physics;
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	RotateInstancePitchTo(GetInstanceIndex(InstanceHandle), Prime);
+}
+
+void CObject3D::RotateInstanceYawTo(const SInstanceHandle& InstanceHandle, float Prime)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	RotateInstanceYawTo(GetInstanceIndex(InstanceHandle), Prime);
+}
+
+void CObject3D::RotateInstanceRollTo(const SInstanceHandle& InstanceHandle, float Prime)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	RotateInstanceRollTo(GetInstanceIndex(InstanceHandle), Prime);
+}
+
+void CObject3D::ScaleInstanceTo(const SInstanceHandle& InstanceHandle, const XMVECTOR& Prime)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	ScaleInstanceTo(GetInstanceIndex(InstanceHandle), Prime);
+}
+
+void CObject3D::TranslateInstance(const SInstanceHandle& InstanceHandle, const XMVECTOR& Delta)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	TranslateInstance(GetInstanceIndex(InstanceHandle), Delta);
+}
+
+void CObject3D::RotateInstancePitch(const SInstanceHandle& InstanceHandle, float Delta)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	RotateInstancePitch(GetInstanceIndex(InstanceHandle), Delta);
+}
+
+void CObject3D::RotateInstanceYaw(const SInstanceHandle& InstanceHandle, float Delta)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	RotateInstanceYaw(GetInstanceIndex(InstanceHandle), Delta);
+}
+
+void CObject3D::RotateInstanceRoll(const SInstanceHandle& InstanceHandle, float Delta)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	RotateInstanceRoll(GetInstanceIndex(InstanceHandle), Delta);
+}
+
+void CObject3D::ScaleInstance(const SInstanceHandle& InstanceHandle, const XMVECTOR& Delta)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 변환 실패")) return;
+
+	ScaleInstance(GetInstanceIndex(InstanceHandle), Delta);
+}
+
+void CObject3D::SetInstanceLinearAcceleration(const SInstanceHandle& InstanceHandle, const XMVECTOR& Prime)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 물리 설정 실패")) return;
+
+	SetInstanceLinearAcceleration(GetInstanceIndex(InstanceHandle), Prime);
+}
+
+void CObject3D::SetInstanceLinearVelocity(const SInstanceHandle& InstanceHandle, const XMVECTOR& Prime)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 물리 설정 실패")) return;
+
+	SetInstanceLinearVelocity(GetInstanceIndex(InstanceHandle), Prime);
+}
+
+void CObject3D::AddInstanceLinearAcceleration(const SInstanceHandle& InstanceHandle, const XMVECTOR& Delta)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 물리 설정 실패")) return;
+
+	AddInstanceLinearAcceleration(GetInstanceIndex(InstanceHandle), Delta);
+}
+
+void CObject3D::AddInstanceLinearVelocity(const SInstanceHandle& InstanceHandle, const XMVECTOR& Delta)
+{
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 물리 설정 실패")) return;
+
+	AddInstanceLinearVelocity(GetInstanceIndex(InstanceHandle), Delta);
+}
+
+void CObject3D::TranslateInstanceTo(size_t InstanceIndex, const XMVECTOR& Prime)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Translation = Prime;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::RotateInstancePitchTo(size_t InstanceIndex, float Prime)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Pitch = Prime;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::RotateInstanceYawTo(size_t InstanceIndex, float Prime)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Yaw = Prime;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::RotateInstanceRollTo(size_t InstanceIndex, float Prime)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Roll = Prime;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::ScaleInstanceTo(size_t InstanceIndex, const XMVECTOR& Prime)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Scaling = Prime;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::TranslateInstance(size_t InstanceIndex, const XMVECTOR& Delta)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Translation += Delta;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::RotateInstancePitch(size_t InstanceIndex, float Delta)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Pitch += Delta;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::RotateInstanceYaw(size_t InstanceIndex, float Delta)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Yaw += Delta;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::RotateInstanceRoll(size_t InstanceIndex, float Delta)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Roll += Delta;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::ScaleInstance(size_t InstanceIndex, const XMVECTOR& Delta)
+{
+	m_vInstanceCPUData[InstanceIndex].Transform.Scaling += Delta;
+	MarkInstanceDirty(InstanceIndex);
+}
+
+void CObject3D::SetInstanceLinearAcceleration(size_t InstanceIndex, const XMVECTOR& Prime)
+{
+	m_vInstanceCPUData[InstanceIndex].Physics.LinearAcceleration = Prime;
+}
+
+void CObject3D::SetInstanceLinearVelocity(size_t InstanceIndex, const XMVECTOR& Prime)
+{
+	m_vInstanceCPUData[InstanceIndex].Physics.LinearVelocity = Prime;
+}
+
+void CObject3D::AddInstanceLinearAcceleration(size_t InstanceIndex, const XMVECTOR& Delta)
+{
+	m_vInstanceCPUData[InstanceIndex].Physics.LinearAcceleration += Delta;
+}
+
+void CObject3D::AddInstanceLinearVelocity(size_t InstanceIndex, const XMVECTOR& Delta)
+{
+	m_vInstanceCPUData[InstanceIndex].Physics.LinearVelocity += Delta;
+}
+
+const SComponentTransform& CObject3D::GetInstanceTransform(const std::string& InstanceName) const
+{
+	return GetInstanceTransform(GetInstanceIndex(InstanceName));
+}
+
+const SComponentPhysics& CObject3D::GetInstancePhysics(const std::string& InstanceName) const
+{
+	return GetInstancePhysics(GetInstanceIndex(InstanceName));
 }
 
 const SBoundingVolume& CObject3D::GetInstanceOuterBoundingSphere(const std::string& InstanceName) const
 {
-	return GetInstanceCPUData(InstanceName).EditorBoundingSphere;
+	return GetInstanceOuterBoundingSphere(GetInstanceIndex(InstanceName));
+}
+
+const SComponentTransform& CObject3D::GetInstanceTransform(const SInstanceHandle& InstanceHandle) const
+{
+	static const SComponentTransform KInvalidComponentTransform{};
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 정보 조회 실패")) return KInvalidComponentTransform;
+
+	return GetInstanceTransform(GetInstanceIndex(InstanceHandle));
+}
+
+const SComponentPhysics& CObject3D::GetInstancePhysics(const SInstanceHandle& InstanceHandle) const
+{
+	static const SComponentPhysics KInvalidComponentPhysics{};
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 정보 조회 실패")) return KInvalidComponentPhysics;
+
+	return GetInstancePhysics(GetInstanceIndex(InstanceHandle));
+}
+
+const SBoundingVolume& CObject3D::GetInstanceOuterBoundingSphere(const SInstanceHandle& InstanceHandle) const
+{
+	static const SBoundingVolume KInvalidBoundingVolume{};
+	if (!CheckInstanceHandle(InstanceHandle, "인스턴스 정보 조회 실패")) return KInvalidBoundingVolume;
+
+	return GetInstanceOuterBoundingSphere(GetInstanceIndex(InstanceHandle));
+}
+
+const SComponentTransform& CObject3D::GetInstanceTransform(size_t InstanceIndex) const
+{
+	return m_vInstanceCPUData[InstanceIndex].Transform;
+}
+
+const SComponentPhysics& CObject3D::GetInstancePhysics(size_t InstanceIndex) const
+{
+	return m_vInstanceCPUData[InstanceIndex].Physics;
+}
+
+const SBoundingVolume& CObject3D::GetInstanceOuterBoundingSphere(size_t InstanceIndex) const
+{
+	return m_vInstanceCPUData[InstanceIndex].EditorBoundingSphere;
 }
 
 SObject3DInstanceCPUData& CObject3D::GetInstanceCPUData(const string& InstanceName)
@@ -1689,6 +2453,7 @@ void CObject3D::SetInstanceCPUData(const std::string& InstanceName, const SObjec
 	auto& InstanceCPUData{ GetInstanceCPUData(InstanceName) };
 	InstanceCPUData = Prime;
 	InstanceCPUData.Name = SavedName; // @important
+	MarkInstanceDirty(GetInstanceIndex(SavedName));
 }
 
 const SObject3DInstanceCPUData& CObject3D::GetInstanceCPUData(const std::string& InstanceName) const
@@ -1722,6 +2487,11 @@ const XMMATRIX& CObject3D::GetInstanceWorldMatrix(const std::string& InstanceNam
 	return GetInstanceGPUData(InstanceName).WorldMatrix;
 }
 
+const XMMATRIX& CObject3D::GetInstanceWorldMatrix(size_t InstanceIndex) const
+{
+	return m_vInstanceGPUData[InstanceIndex].WorldMatrix;
+}
+
 const std::string& CObject3D::GetLastInstanceName() const
 {
 	return m_vInstanceCPUData.back().Name;
@@ -1731,11 +2501,11 @@ void CObject3D::_CreateInstanceBuffer(size_t MeshIndex)
 {
 	D3D11_BUFFER_DESC BufferDesc{};
 	BufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	BufferDesc.ByteWidth = static_cast<UINT>(sizeof(SObject3DInstanceGPUData) * m_vInstanceGPUData.capacity()); // @important
-	BufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	BufferDesc.ByteWidth = static_cast<UINT>(sizeof(SObject3DInstanceGPUData) * m_InstanceBufferCapacity); // @important
+	BufferDesc.CPUAccessFlags = 0;
 	BufferDesc.MiscFlags = 0;
 	BufferDesc.StructureByteStride = 0;
-	BufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	BufferDesc.Usage = D3D11_USAGE_DEFAULT; // @important: written by copies from the upload ring
 
 	D3D11_SUBRESOURCE_DATA SubresourceData{};
 	SubresourceData.pSysMem = &m_vInstanceGPUData[0];
@@ -1746,35 +2516,178 @@ void CObject3D::CreateInstanceBuffers()
 {
 	if (m_vInstanceCPUData.empty()) return;
 
+	m_InstanceBufferCapacity = static_cast<uint32_t>(m_vInstanceGPUData.capacity());
+
 	m_vInstanceBuffers.clear();
 	m_vInstanceBuffers.resize(m_Model->vMeshes.size());
 	for (size_t iMesh = 0; iMesh < m_Model->vMeshes.size(); ++iMesh)
 	{
 		_CreateInstanceBuffer(iMesh);
 	}
+
+	// Upload ring (as large as an instance buffer, so that even a full upload fits in it)
+	{
+		D3D11_BUFFER_DESC BufferDesc{};
+		BufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		BufferDesc.ByteWidth = static_cast<UINT>(sizeof(SObject3DInstanceGPUData) * m_InstanceBufferCapacity);
+		BufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		BufferDesc.MiscFlags = 0;
+		BufferDesc.StructureByteStride = 0;
+		BufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+
+		m_InstanceUploadRing.Reset();
+		m_PtrDevice->CreateBuffer(&BufferDesc, nullptr, &m_InstanceUploadRing);
+
+		// @important: the first map of the ring must discard
+		m_InstanceUploadRingOffset = BufferDesc.ByteWidth;
+	}
+
+	// Initial data is uploaded to every instance buffer
+	m_InstanceUploadStatistics.UploadedByteCount += sizeof(SObject3DInstanceGPUData) * m_vInstanceGPUData.size() * m_vInstanceBuffers.size();
+	++m_InstanceUploadStatistics.FullUploadCount;
+	m_vGPUDirtyInstanceIndices.clear();
+	m_bShouldUploadAllInstances = false;
 }
 
 void CObject3D::_UpdateInstanceBuffer(size_t MeshIndex)
 {
-	if (m_vInstanceGPUData.empty()) return;
 	if (m_vInstanceBuffers.empty()) return;
 	if (!m_vInstanceBuffers[MeshIndex].Buffer) return;
 
-	D3D11_MAPPED_SUBRESOURCE MappedSubresource{};
-	if (SUCCEEDED(m_PtrDeviceContext->Map(m_vInstanceBuffers[MeshIndex].Buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &MappedSubresource)))
+	const UINT KStride{ m_vInstanceBuffers[MeshIndex].Stride };
+	for (const auto& Range : m_vInstanceUploadRanges)
 	{
-		memcpy(MappedSubresource.pData, &m_vInstanceGPUData[0], sizeof(SObject3DInstanceGPUData) * m_vInstanceGPUData.size());
-
-		m_PtrDeviceContext->Unmap(m_vInstanceBuffers[MeshIndex].Buffer.Get(), 0);
+		D3D11_BOX SourceBox{ Range.RingOffset, 0, 0, Range.RingOffset + Range.Count * KStride, 1, 1 };
+		m_PtrDeviceContext->CopySubresourceRegion(m_vInstanceBuffers[MeshIndex].Buffer.Get(), 0, Range.First * KStride, 0, 0,
+			m_InstanceUploadRing.Get(), 0, &SourceBox);
 	}
 }
 
 void CObject3D::UpdateInstanceBuffers()
 {
-	for (size_t iMesh = 0; iMesh < m_Model->vMeshes.size(); ++iMesh)
+	if (m_vInstanceBuffers.empty() || !m_InstanceUploadRing) return;
+
+	BuildInstanceUploadRanges();
+	if (m_vInstanceUploadRanges.empty()) return;
+
+	if (StageInstanceUploadRanges())
+	{
+		for (size_t iMesh = 0; iMesh < m_Model->vMeshes.size(); ++iMesh)
+		{
+			_UpdateInstanceBuffer(iMesh);
+		}
+	}
+
+	m_vInstanceUploadRanges.clear();
+}
+
+void CObject3D::MarkInstanceGPUDataDirty(size_t InstanceIndex)
+{
+	if (m_bShouldUploadAllInstances) return;
+
+	m_vGPUDirtyInstanceIndices.emplace_back((uint32_t)InstanceIndex);
+
+	// @important: once there are more marks than instances, sorting them costs more than uploading everything
+	if (m_vGPUDirtyInstanceIndices.size() > m_vInstanceGPUData.size()) MarkAllInstanceGPUDataDirty();
+}
+
+void CObject3D::MarkAllInstanceGPUDataDirty()
+{
+	m_bShouldUploadAllInstances = true;
+	m_vGPUDirtyInstanceIndices.clear();
+}
+
+void CObject3D::BuildInstanceUploadRanges()
+{
+	m_vInstanceUploadRanges.clear();
+
+	uint32_t InstanceCount{ min((uint32_t)m_vInstanceGPUData.size(), m_InstanceBufferCapacity) };
+	if (m_bShouldUploadAllInstances)
+	{
+		if (InstanceCount) m_vInstanceUploadRanges.push_back({ 0, InstanceCount });
+	}
+	else if (m_vGPUDirtyInstanceIndices.size())
 	{
-		_UpdateInstanceBuffer(iMesh);
+		sort(m_vGPUDirtyInstanceIndices.begin(), m_vGPUDirtyInstanceIndices.end());
+		for (uint32_t InstanceIndex : m_vGPUDirtyInstanceIndices)
+		{
+			if (InstanceIndex >= InstanceCount) break; // deleted
+
+			if (m_vInstanceUploadRanges.size())
+			{
+				SInstanceUploadRange& LastRange{ m_vInstanceUploadRanges.back() };
+				uint32_t LastRangeEnd{ LastRange.First + LastRange.Count };
+				if (InstanceIndex < LastRangeEnd) continue; // duplicate
+				if (InstanceIndex - LastRangeEnd <= KInstanceUploadRangeMergeGap)
+				{
+					LastRange.Count = InstanceIndex + 1 - LastRange.First;
+					continue;
+				}
+			}
+			m_vInstanceUploadRanges.push_back({ InstanceIndex, 1 });
+		}
+
+		// Too fragmented, a single copy is cheaper than many small ones
+		if (m_vInstanceUploadRanges.size() > KMaxInstanceUploadRangeCount)
+		{
+			uint32_t First{ m_vInstanceUploadRanges.front().First };
+			uint32_t End{ m_vInstanceUploadRanges.back().First + m_vInstanceUploadRanges.back().Count };
+			m_vInstanceUploadRanges.clear();
+			m_vInstanceUploadRanges.push_back({ First, End - First });
+		}
 	}
+
+	m_vGPUDirtyInstanceIndices.clear();
+	m_bShouldUploadAllInstances = false;
+}
+
+bool CObject3D::StageInstanceUploadRanges()
+{
+	const UINT KStride{ static_cast<UINT>(sizeof(SObject3DInstanceGPUData)) };
+	const UINT KRingByteWidth{ KStride * m_InstanceBufferCapacity };
+
+	UINT StagedByteCount{};
+	for (const auto& Range : m_vInstanceUploadRanges)
+	{
+		StagedByteCount += Range.Count * KStride;
+	}
+
+	// Append to the ring without stalling on the copies in flight, and discard (rename) it only when it wraps around
+	D3D11_MAP eMapType{ D3D11_MAP_WRITE_NO_OVERWRITE };
+	if (m_InstanceUploadRingOffset + StagedByteCount > KRingByteWidth)
+	{
+		eMapType = D3D11_MAP_WRITE_DISCARD;
+		m_InstanceUploadRingOffset = 0;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE MappedSubresource{};
+	if (FAILED(m_PtrDeviceContext->Map(m_InstanceUploadRing.Get(), 0, eMapType, 0, &MappedSubresource))) return false;
+	{
+		uint8_t* const PtrRing{ static_cast<uint8_t*>(MappedSubresource.pData) };
+		for (auto& Range : m_vInstanceUploadRanges)
+		{
+			UINT ByteCount{ Range.Count * KStride };
+			Range.RingOffset = m_InstanceUploadRingOffset;
+			memcpy(PtrRing + Range.RingOffset, &m_vInstanceGPUData[Range.First], ByteCount);
+			m_InstanceUploadRingOffset += ByteCount;
+		}
+	}
+	m_PtrDeviceContext->Unmap(m_InstanceUploadRing.Get(), 0);
+
+	m_InstanceUploadStatistics.UploadedByteCount += StagedByteCount;
+	m_InstanceUploadStatistics.UploadedRangeCount += (uint32_t)m_vInstanceUploadRanges.size();
+	if (StagedByteCount == KStride * m_vInstanceGPUData.size()) ++m_InstanceUploadStatistics.FullUploadCount;
+	return true;
+}
+
+const CObject3D::SInstanceUploadStatistics& CObject3D::GetInstanceUploadStatistics() const
+{
+	return m_InstanceUploadStatistics;
+}
+
+void CObject3D::ResetInstanceUploadStatistics()
+{
+	m_InstanceUploadStatistics = SInstanceUploadStatistics();
 }
 
 void CObject3D::UpdateQuadUV(const XMFLOAT2& UVOffset, const XMFLOAT2& UVSize)
@@ -1842,38 +2755,29 @@ void CObject3D::UpdateWorldMatrix()
 
 void CObject3D::UpdateInstanceWorldMatrix(const std::string& InstanceName, bool bUpdateInstanceBuffer)
 {
-	auto& InstanceCPUData{ GetInstanceCPUData(InstanceName) };
-	auto& InstanceGPUData{ GetInstanceGPUData(InstanceName) };
+	UpdateInstanceWorldMatrix(GetInstanceIndex(InstanceName), bUpdateInstanceBuffer);
+}
 
-	// Update CPU data
-	LimitFloatRotation(InstanceCPUData.Transform.Pitch, KRotationMinLimit, KRotationMaxLimit);
-	LimitFloatRotation(InstanceCPUData.Transform.Yaw, KRotationMinLimit, KRotationMaxLimit);
-	LimitFloatRotation(InstanceCPUData.Transform.Roll, KRotationMinLimit, KRotationMaxLimit);
+void CObject3D::UpdateInstanceWorldMatrix(size_t InstanceIndex, bool bUpdateInstanceBuffer)
+{
+	auto& InstanceCPUData{ m_vInstanceCPUData[InstanceIndex] };
+	auto& InstanceGPUData{ m_vInstanceGPUData[InstanceIndex] };
 
-	if (XMVectorGetX(InstanceCPUData.Transform.Scaling) < KScalingMinLimit)
-		InstanceCPUData.Transform.Scaling = XMVectorSetX(InstanceCPUData.Transform.Scaling, KScalingMinLimit);
-	if (XMVectorGetY(InstanceCPUData.Transform.Scaling) < KScalingMinLimit)
-		InstanceCPUData.Transform.Scaling = XMVectorSetY(InstanceCPUData.Transform.Scaling, KScalingMinLimit);
-	if (XMVectorGetZ(InstanceCPUData.Transform.Scaling) < KScalingMinLimit)
-		InstanceCPUData.Transform.Scaling = XMVectorSetZ(InstanceCPUData.Transform.Scaling, KScalingMinLimit);
+	// Update CPU data
+	LimitInstanceTransform(InstanceCPUData);
 
 	XMMATRIX Translation{ XMMatrixTranslationFromVector(InstanceCPUData.Transform.Translation) };
 	XMMATRIX Rotation{ XMMatrixRotationRollPitchYaw(
 		InstanceCPUData.Transform.Pitch, InstanceCPUData.Transform.Yaw, InstanceCPUData.Transform.Roll) };
 	XMMATRIX Scaling{ XMMatrixScalingFromVector(InstanceCPUData.Transform.Scaling) };
 
-	// @important
-	float ScalingX{ XMVectorGetX(InstanceCPUData.Transform.Scaling) };
-	float ScalingY{ XMVectorGetY(InstanceCPUData.Transform.Scaling) };
-	float ScalingZ{ XMVectorGetZ(InstanceCPUData.Transform.Scaling) };
-	float MaxScaling{ max(ScalingX, max(ScalingY, ScalingZ)) };
-	InstanceCPUData.EditorBoundingSphere.Data.BS.Radius = m_OuterBoundingSphere.Data.BS.RadiusBias * MaxScaling;
-
 	XMMATRIX BoundingSphereTranslation{ XMMatrixTranslationFromVector(m_OuterBoundingSphere.Center) };
 	XMMATRIX BoundingSphereTranslationOpposite{ XMMatrixTranslationFromVector(-m_OuterBoundingSphere.Center) };
 
 	// Update GPU data
 	InstanceGPUData.WorldMatrix = Scaling * BoundingSphereTranslationOpposite * Rotation * Translation * BoundingSphereTranslation;
+	m_vInstanceDirtyFlags[InstanceIndex] = 0;
+	MarkInstanceGPUDataDirty(InstanceIndex);
 
 	if (bUpdateInstanceBuffer) UpdateInstanceBuffers();
 }
@@ -1882,33 +2786,143 @@ void CObject3D::UpdateInstanceWorldMatrix(const std::string& InstanceName, const
 {
 	if (InstanceName.empty()) return;
 
-	GetInstanceGPUData(InstanceName).WorldMatrix = WorldMatrix;
+	size_t InstanceIndex{ GetInstanceIndex(InstanceName) };
+	m_vInstanceGPUData[InstanceIndex].WorldMatrix = WorldMatrix;
+	MarkInstanceGPUDataDirty(InstanceIndex);
 
 	UpdateInstanceBuffers();
 }
 
 void CObject3D::UpdateAllInstances(bool bUpdateWorldMatrix)
 {
-	if (bUpdateWorldMatrix)
+	if (bUpdateWorldMatrix) UpdateDirtyInstanceWorldMatrices();
+	UpdateInstanceBuffers();
+}
+
+void CObject3D::MarkInstanceDirty(size_t InstanceIndex)
+{
+	MarkInstanceMoved(InstanceIndex);
+
+	if (m_vInstanceDirtyFlags[InstanceIndex]) return;
+
+	m_vInstanceDirtyFlags[InstanceIndex] = 1;
+	m_vDirtyInstanceIndices.emplace_back((uint32_t)InstanceIndex);
+}
+
+void CObject3D::MarkAllInstancesDirty()
+{
+	MarkAllInstancesMoved();
+
+	for (size_t iInstance = 0; iInstance < m_vInstanceDirtyFlags.size(); ++iInstance)
 	{
-		for (const auto& InstanceCPUData : m_vInstanceCPUData)
+		MarkInstanceDirty(iInstance);
+	}
+}
+
+bool CObject3D::ConsumeMovedInstanceIndices(std::vector<uint32_t>& vOutInstanceIndices)
+{
+	bool bHaveAllInstancesMoved{ m_bHaveAllInstancesMoved };
+	vOutInstanceIndices.clear();
+	vOutInstanceIndices.swap(m_vMovedInstanceIndices);
+	if (bHaveAllInstancesMoved) vOutInstanceIndices.clear();
+
+	m_bHaveAllInstancesMoved = false;
+	return bHaveAllInstancesMoved;
+}
+
+void CObject3D::MarkInstanceMoved(size_t InstanceIndex)
+{
+	if (m_bHaveAllInstancesMoved) return;
+
+	m_vMovedInstanceIndices.emplace_back((uint32_t)InstanceIndex);
+
+	// @important: only the physics engine consumes the list, so it must stay bounded without it
+	if (m_vMovedInstanceIndices.size() > m_vInstanceCPUData.size()) MarkAllInstancesMoved();
+}
+
+void CObject3D::MarkAllInstancesMoved()
+{
+	m_bHaveAllInstancesMoved = true;
+	m_vMovedInstanceIndices.clear();
+}
+
+void CObject3D::UpdateDirtyInstanceWorldMatrices()
+{
+	// Dirty instances are composed 4 at a time
+	STransformPack4 Pack{};
+	uint32_t InstanceIndices[STransformPack4::KLaneCount]{};
+	uint32_t LaneCount{};
+	for (uint32_t InstanceIndex : m_vDirtyInstanceIndices)
+	{
+		if (InstanceIndex >= (uint32_t)m_vInstanceDirtyFlags.size()) continue; // deleted
+		if (!m_vInstanceDirtyFlags[InstanceIndex]) continue; // already updated
+		m_vInstanceDirtyFlags[InstanceIndex] = 0;
+
+		auto& InstanceCPUData{ m_vInstanceCPUData[InstanceIndex] };
+		LimitInstanceTransform(InstanceCPUData);
+		SetTransformPackLane(Pack, LaneCount, InstanceCPUData.Transform.Translation, InstanceCPUData.Transform.Scaling,
+			InstanceCPUData.Transform.Pitch, InstanceCPUData.Transform.Yaw, InstanceCPUData.Transform.Roll);
+		InstanceIndices[LaneCount++] = InstanceIndex;
+
+		if (LaneCount == STransformPack4::KLaneCount)
 		{
-			UpdateInstanceWorldMatrix(InstanceCPUData.Name, false);
+			ComposeInstanceWorldMatrices(Pack, InstanceIndices, LaneCount);
+			LaneCount = 0;
 		}
 	}
-	UpdateInstanceBuffers();
+	if (LaneCount) ComposeInstanceWorldMatrices(Pack, InstanceIndices, LaneCount);
+
+	m_vDirtyInstanceIndices.clear();
+}
+
+void CObject3D::ComposeInstanceWorldMatrices(const STransformPack4& Pack, const uint32_t* const InstanceIndices, uint32_t LaneCount)
+{
+	XMMATRIX WorldMatrices[STransformPack4::KLaneCount]{};
+	ComposeWorldMatrices4(Pack, m_OuterBoundingSphere.Center, WorldMatrices, LaneCount);
+	for (uint32_t iLane = 0; iLane < LaneCount; ++iLane)
+	{
+		m_vInstanceGPUData[InstanceIndices[iLane]].WorldMatrix = WorldMatrices[iLane];
+		MarkInstanceGPUDataDirty(InstanceIndices[iLane]);
+	}
+}
+
+void CObject3D::LimitInstanceTransform(SObject3DInstanceCPUData& InstanceCPUData)
+{
+	LimitFloatRotation(InstanceCPUData.Transform.Pitch, KRotationMinLimit, KRotationMaxLimit);
+	LimitFloatRotation(InstanceCPUData.Transform.Yaw, KRotationMinLimit, KRotationMaxLimit);
+	LimitFloatRotation(InstanceCPUData.Transform.Roll, KRotationMinLimit, KRotationMaxLimit);
+
+	if (XMVectorGetX(InstanceCPUData.Transform.Scaling) < KScalingMinLimit)
+		InstanceCPUData.Transform.Scaling = XMVectorSetX(InstanceCPUData.Transform.Scaling, KScalingMinLimit);
+	if (XMVectorGetY(InstanceCPUData.Transform.Scaling) < KScalingMinLimit)
+		InstanceCPUData.Transform.Scaling = XMVectorSetY(InstanceCPUData.Transform.Scaling, KScalingMinLimit);
+	if (XMVectorGetZ(InstanceCPUData.Transform.Scaling) < KScalingMinLimit)
+		InstanceCPUData.Transform.Scaling = XMVectorSetZ(InstanceCPUData.Transform.Scaling, KScalingMinLimit);
+
+	// @important
+	float ScalingX{ XMVectorGetX(InstanceCPUData.Transform.Scaling) };
+	float ScalingY{ XMVectorGetY(InstanceCPUData.Transform.Scaling) };
+	float ScalingZ{ XMVectorGetZ(InstanceCPUData.Transform.Scaling) };
+	float MaxScaling{ max(ScalingX, max(ScalingY, ScalingZ)) };
+	InstanceCPUData.EditorBoundingSphere.Data.BS.Radius = m_OuterBoundingSphere.Data.BS.RadiusBias * MaxScaling;
 }
 
 void CObject3D::SetInstanceHighlight(const std::string& InstanceName, bool bShouldHighlight)
 {
-	GetInstanceGPUData(InstanceName).IsHighlighted = (bShouldHighlight) ? 1.0f : 0.0f;
+	size_t InstanceIndex{ GetInstanceIndex(InstanceName) };
+	m_vInstanceGPUData[InstanceIndex].IsHighlighted = (bShouldHighlight) ? 1.0f : 0.0f;
+	MarkInstanceGPUDataDirty(InstanceIndex);
 }
 
 void CObject3D::SetAllInstancesHighlightOff()
 {
-	for (auto& InstanceGPUData : m_vInstanceGPUData)
+	for (size_t iInstance = 0; iInstance < m_vInstanceGPUData.size(); ++iInstance)
 	{
+		auto& InstanceGPUData{ m_vInstanceGPUData[iInstance] };
+		if (InstanceGPUData.IsHighlighted == 0.0f) continue;
+
 		InstanceGPUData.IsHighlighted = 0.0f;
+		MarkInstanceGPUDataDirty(iInstance);
 	}
 
 	UpdateInstanceBuffers();
@@ -2078,12 +3092,14 @@ void CObject3D::SetOuterBoundingSphereCenterOffset(const XMVECTOR& Center)
 {
 	m_OuterBoundingSphere.Center = Center;
 	if (m_Model) m_Model->EditorBoundingSphereData.Center = m_OuterBoundingSphere.Center;
+	MarkAllInstancesDirty();
 }
 
 void CObject3D::SetOuterBoundingSphereRadiusBias(float Radius)
 {
 	m_OuterBoundingSphere.Data.BS.RadiusBias = Radius;
 	if (m_Model) m_Model->EditorBoundingSphereData.Data.BS.RadiusBias = m_OuterBoundingSphere.Data.BS.RadiusBias;
+	MarkAllInstancesDirty();
 }
 
 const XMVECTOR& CObject3D::GetOuterBoundingSphereCenterOffset() const
@@ -2117,11 +3133,10 @@ void CObject3D::Animate(float DeltaTime)
 
 	if (IsInstanced())
 	{
-		for (const auto& InstanceCPUData : m_vInstanceCPUData)
+		for (size_t iInstance = 0; iInstance < m_vInstanceCPUData.size(); ++iInstance)
 		{
-			AnimateInstance(InstanceCPUData.Name, DeltaTime);
+			AnimateInstance(iInstance, DeltaTime);
 		}
-		UpdateInstanceBuffers(); // @important
 	}
 	else
 	{
@@ -2154,14 +3169,14 @@ void CObject3D::Animate(float DeltaTime)
 	else
 	{
 		m_CBAnimationData.bUseGPUSkinning = FALSE;
-		CalculateAnimatedBoneMatrices(m_Model->vAnimations[m_CurrentAnimationID], m_AnimationTick, m_Model->vTreeNodes[0], XMMatrixIdentity());
+		if (m_bShouldEvaluateAnimationPose) CalculateAnimatedBoneMatrices(m_CurrentAnimationID, m_AnimationTick);
 	}
 }
 
-void CObject3D::AnimateInstance(const std::string& InstanceName, float DeltaTime)
+void CObject3D::AnimateInstance(size_t InstanceIndex, float DeltaTime)
 {
-	auto& InstanceCPUData{ GetInstanceCPUData(InstanceName) };
-	auto& InstanceGPUData{ GetInstanceGPUData(InstanceName) };
+	auto& InstanceCPUData{ m_vInstanceCPUData[InstanceIndex] };
+	auto& InstanceGPUData{ m_vInstanceGPUData[InstanceIndex] };
 
 	if ((InstanceCPUData.eCurrAnimOption == EAnimationOption::PlayToFirstFrame || InstanceCPUData.eCurrAnimOption == EAnimationOption::PlayToLastFrame) &&
 		InstanceCPUData.CurrAnimPlayCount >= 1)
@@ -2171,6 +3186,7 @@ void CObject3D::AnimateInstance(const std::string& InstanceName, float DeltaTime
 
 	const SMeshAnimation& CurrentAnimation{ m_Model->vAnimations[InstanceGPUData.CurrAnimID] };
 	InstanceGPUData.AnimTick += CurrentAnimation.TicksPerSecond * DeltaTime;
+	MarkInstanceGPUDataDirty(InstanceIndex);
 	if (InstanceGPUData.AnimTick > CurrentAnimation.Duration)
 	{
 		++InstanceCPUData.CurrAnimPlayCount;
@@ -2182,90 +3198,99 @@ void CObject3D::AnimateInstance(const std::string& InstanceName, float DeltaTime
 	}
 }
 
-void CObject3D::CalculateAnimatedBoneMatrices(const SMeshAnimation& CurrentAnimation, float AnimationTick,
-	const SMeshTreeNode& Node, XMMATRIX ParentTransform)
+void CObject3D::CalculateAnimatedBoneMatrices(uint32_t AnimationID, float AnimationTick)
+{
+	_CalculateAnimatedBoneMatrices(AnimationID, AnimationTick, m_AnimatedBoneMatrices, m_AnimationEvaluationScratch);
+}
+
+void CObject3D::_CalculateAnimatedBoneMatrices(uint32_t AnimationID, float AnimationTick, XMMATRIX* const OutBoneMatrices,
+	SAnimationEvaluationScratch& Scratch) const
 {
-	XMMATRIX MatrixTransformation{ Node.MatrixTransformation * ParentTransform };
+	const SMeshAnimation& CurrentAnimation{ m_Model->vAnimations[AnimationID] };
+	const vector<int32_t>& vNodeAnimationIndices{ m_vAnimationNodeAnimationIndices[AnimationID] };
+	if (Scratch.vNodeTransforms.size() < m_Model->vTreeNodes.size()) Scratch.vNodeTransforms.resize(m_Model->vTreeNodes.size());
+	if (Scratch.vKeyCursors.size() < CurrentAnimation.vNodeAnimations.size()) Scratch.vKeyCursors.resize(CurrentAnimation.vNodeAnimations.size());
 
-	if (Node.bIsBone)
+	// @important: parents precede their children in m_vAnimationNodeOrder
+	for (uint32_t NodeIndex : m_vAnimationNodeOrder)
 	{
-		if (CurrentAnimation.vNodeAnimations.size())
+		const SMeshTreeNode& Node{ m_Model->vTreeNodes[NodeIndex] };
+		const int32_t KParentNodeIndex{ m_vAnimationNodeParentIndices[NodeIndex] };
+		const XMMATRIX ParentTransform{ (KParentNodeIndex < 0) ? XMMatrixIdentity() : Scratch.vNodeTransforms[KParentNodeIndex] };
+		XMMATRIX& MatrixTransformation{ Scratch.vNodeTransforms[NodeIndex] };
+
+		const int32_t KNodeAnimationIndex{ vNodeAnimationIndices[NodeIndex] };
+		if (KNodeAnimationIndex < 0)
 		{
-			if (CurrentAnimation.umapNodeAnimationNameToIndex.find(Node.Name) != CurrentAnimation.umapNodeAnimationNameToIndex.end())
-			{
-				size_t NodeAnimationIndex{ CurrentAnimation.umapNodeAnimationNameToIndex.at(Node.Name) };
+			MatrixTransformation = Node.MatrixTransformation * ParentTransform;
+		}
+		else if (CurrentAnimation.bIsCompressed)
+		{
+			XMVECTOR Position{}, Rotation{}, Scaling{};
+			CAnimationCompressor::Evaluate(CurrentAnimation, (size_t)KNodeAnimationIndex, AnimationTick, Position, Rotation, Scaling);
 
-				const SMeshAnimation::SNodeAnimation& NodeAnimation{ CurrentAnimation.vNodeAnimations[NodeAnimationIndex] };
+			MatrixTransformation = XMMatrixScalingFromVector(Scaling) * XMMatrixRotationQuaternion(Rotation) *
+				XMMatrixTranslationFromVector(Position) * ParentTransform;
+		}
+		else
+		{
+			const SMeshAnimation::SNodeAnimation& NodeAnimation{ CurrentAnimation.vNodeAnimations[KNodeAnimationIndex] };
+			SAnimationKeyCursor& KeyCursor{ Scratch.vKeyCursors[KNodeAnimationIndex] };
 
-				XMMATRIX MatrixPosition{ XMMatrixIdentity() };
-				XMMATRIX MatrixRotation{ XMMatrixIdentity() };
-				XMMATRIX MatrixScaling{ XMMatrixIdentity() };
+			XMMATRIX MatrixPosition{ XMMatrixIdentity() };
+			XMMATRIX MatrixRotation{ XMMatrixIdentity() };
+			XMMATRIX MatrixScaling{ XMMatrixIdentity() };
 
-				{
-					const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys{ NodeAnimation.vPositionKeys };
-					SMeshAnimation::SNodeAnimation::SKey KeyA{};
-					SMeshAnimation::SNodeAnimation::SKey KeyB{};
-					for (uint32_t iKey = 0; iKey < (uint32_t)vKeys.size(); ++iKey)
-					{
-						if (vKeys[iKey].Time <= AnimationTick)
-						{
-							KeyA = vKeys[iKey];
-							KeyB = vKeys[(iKey < (uint32_t)vKeys.size() - 1) ? iKey + 1 : 0];
-						}
-					}
-
-					MatrixPosition = XMMatrixTranslationFromVector(KeyA.Value);
-				}
+			{
+				const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys{ NodeAnimation.vPositionKeys };
+				uint32_t iKey{ FindAnimationKey(vKeys, AnimationTick, KeyCursor.Position) };
+				SMeshAnimation::SNodeAnimation::SKey KeyA{ (iKey == KInvalidAnimationKey) ? SMeshAnimation::SNodeAnimation::SKey() : vKeys[iKey] };
 
-				{
-					const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys{ NodeAnimation.vRotationKeys };
-					SMeshAnimation::SNodeAnimation::SKey KeyA{};
-					SMeshAnimation::SNodeAnimation::SKey KeyB{};
-					for (uint32_t iKey = 0; iKey < (uint32_t)vKeys.size(); ++iKey)
-					{
-						if (vKeys[iKey].Time <= AnimationTick)
-						{
-							KeyA = vKeys[iKey];
-							KeyB = vKeys[(iKey < (uint32_t)vKeys.size() - 1) ? iKey + 1 : 0];
-						}
-					}
-
-					MatrixRotation = XMMatrixRotationQuaternion(KeyA.Value);
-				}
+				MatrixPosition = XMMatrixTranslationFromVector(KeyA.Value);
+			}
 
-				{
-					const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys{ NodeAnimation.vScalingKeys };
-					SMeshAnimation::SNodeAnimation::SKey KeyA{};
-					SMeshAnimation::SNodeAnimation::SKey KeyB{};
-					for (uint32_t iKey = 0; iKey < (uint32_t)vKeys.size(); ++iKey)
-					{
-						if (vKeys[iKey].Time <= AnimationTick)
-						{
-							KeyA = vKeys[iKey];
-							KeyB = vKeys[(iKey < (uint32_t)vKeys.size() - 1) ? iKey + 1 : 0];
-						}
-					}
-
-					MatrixScaling = XMMatrixScalingFromVector(KeyA.Value);
-				}
+			{
+				const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys{ NodeAnimation.vRotationKeys };
+				uint32_t iKey{ FindAnimationKey(vKeys, AnimationTick, KeyCursor.Rotation) };
+				SMeshAnimation::SNodeAnimation::SKey KeyA{ (iKey == KInvalidAnimationKey) ? SMeshAnimation::SNodeAnimation::SKey() : vKeys[iKey] };
 
-				MatrixTransformation = MatrixScaling * MatrixRotation * MatrixPosition * ParentTransform;
+				MatrixRotation = XMMatrixRotationQuaternion(KeyA.Value);
 			}
-		}
 
-		// Transpose at the last moment!
-		m_AnimatedBoneMatrices[Node.BoneIndex] = XMMatrixTranspose(Node.MatrixBoneOffset * MatrixTransformation);
-	}
+			{
+				const vector<SMeshAnimation::SNodeAnimation::SKey>& vKeys{ NodeAnimation.vScalingKeys };
+				uint32_t iKey{ FindAnimationKey(vKeys, AnimationTick, KeyCursor.Scaling) };
+				SMeshAnimation::SNodeAnimation::SKey KeyA{ (iKey == KInvalidAnimationKey) ? SMeshAnimation::SNodeAnimation::SKey() : vKeys[iKey] };
 
-	if (Node.vChildNodeIndices.size())
-	{
-		for (auto iChild : Node.vChildNodeIndices)
+				MatrixScaling = XMMatrixScalingFromVector(KeyA.Value);
+			}
+
+			MatrixTransformation = MatrixScaling * MatrixRotation * MatrixPosition * ParentTransform;
+		}
+
+		if (Node.bIsBone)
 		{
-			CalculateAnimatedBoneMatrices(CurrentAnimation, AnimationTick, m_Model->vTreeNodes[iChild], MatrixTransformation);
+			// Transpose at the last moment!
+			OutBoneMatrices[Node.BoneIndex] = XMMatrixTranspose(Node.MatrixBoneOffset * MatrixTransformation);
 		}
 	}
 }
 
+void CObject3D::UpdateAnimationLOD(uint32_t FrameInterval)
+{
+	const uint32_t KFrameInterval{ max(FrameInterval, (uint32_t)1) };
+
+	// @important: an object that gets a shorter interval (e.g. closer to the camera) does not wait for the longer one
+	m_AnimationEvaluationFrameCountdown = min(m_AnimationEvaluationFrameCountdown, KFrameInterval - 1);
+	m_bShouldEvaluateAnimationPose = (m_AnimationEvaluationFrameCountdown == 0);
+	m_AnimationEvaluationFrameCountdown = (m_bShouldEvaluateAnimationPose) ? KFrameInterval - 1 : m_AnimationEvaluationFrameCountdown - 1;
+}
+
+bool CObject3D::ShouldEvaluateAnimationPose() const
+{
+	return m_bShouldEvaluateAnimationPose;
+}
+
 void CObject3D::Draw(EFlagsObject3DRendering eFlagsRendering, size_t OneInstanceIndex) const
 {
 	bool bIgnoreOwnTexture{ EFLAG_HAS(eFlagsRendering, EFlagsObject3DRendering::IgnoreOwnTextures) };
@@ -9,9 +9,11 @@ class CMaterialData;
 class CMaterialTextureSet;
 class CShader;
 class CTexture;
+class CTriangleBVH;
 struct SMeshAnimation;
-struct SMeshTreeNode;
 struct SMESHData;
+struct SPixel128Float;
+struct STransformPack4;
 enum class ETextureType;
 
 enum class EFlagsObject3DRendering
@@ -52,6 +54,14 @@ public:
 		NoCulling = 0x01,
 	};
 
+	// Bone matrices of the baked animation texture (one row per tick)
+	enum class EAnimationTextureLayout
+	{
+		Matrix4x4,		// 4 RGBA32F texels per bone, KMaxBoneMatrixCount bones per row
+		Affine3x4,		// 3 RGBA32F texels per bone, ModelBoneCount bones per row
+		Affine3x4Half	// 3 RGBA16F texels per bone, ModelBoneCount bones per row
+	};
+
 	struct SCBMaterialData // Update at least per every object (even an object could have multiple materials)
 	{
 		//XMFLOAT3	AmbientColor{};
@@ -92,6 +102,14 @@ public:
 		float		AnimationTick{};
 	};
 
+	// CPU to GPU traffic of the instance buffers since the last reset (a frame, when reset every frame)
+	struct SInstanceUploadStatistics
+	{
+		size_t		UploadedByteCount{};
+		uint32_t	UploadedRangeCount{};
+		uint32_t	FullUploadCount{};
+	};
+
 private:
 	struct SMeshBuffers
 	{
@@ -113,6 +131,48 @@ private:
 		UINT					Offset{};
 	};
 
+	// Instances [First, First + Count) staged at RingOffset (bytes) of the upload ring
+	struct SInstanceUploadRange
+	{
+		uint32_t				First{};
+		uint32_t				Count{};
+		UINT					RingOffset{};
+	};
+
+	// Last evaluated key of each channel of a node animation
+	struct SAnimationKeyCursor
+	{
+		uint32_t				Position{};
+		uint32_t				Rotation{};
+		uint32_t				Scaling{};
+	};
+
+	// Scratch of bone matrix evaluation (one per thread when evaluating in parallel)
+	struct SAnimationEvaluationScratch
+	{
+		std::vector<XMMATRIX>				vNodeTransforms{}; // per tree node
+		std::vector<SAnimationKeyCursor>	vKeyCursors{}; // per node animation (hints only)
+	};
+
+	// A row of the baked animation texture
+	struct SAnimationBakeSample
+	{
+		uint32_t				AnimationID{};
+		uint32_t				Tick{};
+		uint32_t				Row{};
+	};
+
+	struct SAnimationBakeContext
+	{
+		const CObject3D*							PtrObject3D{};
+		const std::vector<SAnimationBakeSample>*	PtrSamples{};
+		std::vector<SAnimationEvaluationScratch>*	PtrScratches{}; // per thread
+		SPixel128Float*								PtrRawData{};
+		uint32_t									TextureWidth{};
+		uint32_t									BoneCount{};
+		EAnimationTextureLayout						eLayout{};
+	};
+
 public:
 	CObject3D(const std::string& Name, ID3D11Device* const PtrDevice, ID3D11DeviceContext* const PtrDeviceContext);
 	~CObject3D();
@@ -144,6 +204,8 @@ private:
 	void __CreateMaterialTexture(size_t Index);
 	void _CreateConstantBuffers();
 	void _InitializeAnimationData();
+	void __InitializeAnimationNodeTables();
+	void _CreateTriangleBVHs();
 	void CalculateEditorBoundingSphereData();
 
 // Import & export
@@ -164,9 +226,25 @@ public:
 	void CreateInstances(size_t InstanceCount);
 	bool InsertInstance();
 	bool InsertInstance(const std::string& InstanceName);
+	// Bulk insertion: reserves once, composes all world matrices in one pass and uploads the instance buffers once
+	// @important: names are auto-generated if vInstanceNames is empty, and instances whose names already exist are skipped
+	// (skipped and truncated names are reported in a single warning)
+	// returns the number of inserted instances (appended at the end)
+	size_t InsertInstances(const std::vector<SComponentTransform>& vTransforms, const std::vector<std::string>& vInstanceNames = {});
 	void DeleteInstance(const std::string& InstanceName);
+	void DeleteInstance(const SInstanceHandle& InstanceHandle);
 	void ClearInstances();
 
+// Instance handle
+public:
+	// @important: a null handle is returned if there's no such instance
+	SInstanceHandle GetInstanceHandle(const std::string& InstanceName) const;
+	SInstanceHandle GetInstanceHandle(size_t InstanceIndex) const;
+	SInstanceHandle GetLastInstanceHandle() const;
+	bool IsInstanceHandleValid(const SInstanceHandle& InstanceHandle) const;
+	// @important: only valid handles are allowed (SInstanceHandle overloads check them with CheckInstanceHandle())
+	size_t GetInstanceIndex(const SInstanceHandle& InstanceHandle) const;
+
 // Instance setting
 public:
 	bool ChangeInstanceName(const std::string& OldName, const std::string& NewName);
@@ -177,20 +255,46 @@ public:
 	const std::vector<SObject3DInstanceCPUData>& GetInstanceCPUDataVector() const;
 	size_t GetInstanceIndex(const std::string& InstanceName) const;
 	const XMMATRIX& GetInstanceWorldMatrix(const std::string& InstanceName) const;
+	const XMMATRIX& GetInstanceWorldMatrix(size_t InstanceIndex) const;
 	const std::string& GetLastInstanceName() const;
 
 // Instance setting (internal)
 private:
 	SObject3DInstanceCPUData& GetInstanceCPUData(const std::string& InstanceName);
 	SObject3DInstanceGPUData& GetInstanceGPUData(const std::string& InstanceName);
+	size_t GetInstanceIndex(const SObjectIdentifier& Identifier) const;
+
+// Instance slot (internal)
+private:
+	void AllocateInstanceSlot();
+	void ReleaseInstanceSlot(size_t InstanceIndex);
+	void ReleaseAllInstanceSlots();
+	// warns and returns false if the handle is stale or null
+	bool CheckInstanceHandle(const SInstanceHandle& InstanceHandle, const char* const FailureTitle) const;
+	bool CheckInstanceIdentifier(const SObjectIdentifier& Identifier, const char* const FailureTitle) const;
 
 // Instance buffer
 private:
 	void _CreateInstanceBuffer(size_t MeshIndex);
 	void CreateInstanceBuffers();
 	void _UpdateInstanceBuffer(size_t MeshIndex = 0);
+
+public:
+	// Uploads the instance data marked dirty since the last call
 	void UpdateInstanceBuffers();
 
+// Instance buffer upload (internal)
+private:
+	void MarkInstanceGPUDataDirty(size_t InstanceIndex);
+	void MarkAllInstanceGPUDataDirty();
+	void BuildInstanceUploadRanges();
+	bool StageInstanceUploadRanges();
+
+// Instance buffer upload statistics
+public:
+	const SInstanceUploadStatistics& GetInstanceUploadStatistics() const;
+	void ResetInstanceUploadStatistics();
+
 // Animation adding & setting (general)
 public:
 	void AddAnimationFromFile(const std::string& FileName, const std::string& AnimationName);
@@ -198,6 +302,9 @@ public:
 	void SetAnimationName(uint32_t AnimationID, const std::string& Name);
 	void SetAnimationTicksPerSecond(uint32_t AnimationID, float TPS);
 	void SetAnimationBehaviorStartTick(uint32_t AnimationID, float BehaviorStartTick);
+	// @important: takes effect when animations are loaded or added next, uncompressed animations are evaluated from their keys
+	void ShouldCompressAnimations(bool bShouldCompress);
+	bool ShouldCompressAnimations() const;
 
 // Animation info (general)
 public:
@@ -227,17 +334,19 @@ private:
 	size_t GetObjectAnimationPlayCount() const;
 	float GetObjectCurrentAnimationBehaviorStartTick() const;
 
-	bool IsInstanceCurrentAnimationRegisteredAs(const std::string& InstanceName, EAnimationRegistrationType eRegistrationType) const;
-	float GetInstanceAnimationTick(const std::string& InstanceName) const;
-	uint32_t GetInstanceAnimationID(const std::string& InstanceName) const;
-	size_t GetInstanceAnimationPlayCount(const std::string& InstanceName) const;
-	float GetInstanceCurrentAnimationBehaviorStartTick(const std::string& InstanceName) const;
+	bool IsInstanceCurrentAnimationRegisteredAs(size_t InstanceIndex, EAnimationRegistrationType eRegistrationType) const;
+	float GetInstanceAnimationTick(size_t InstanceIndex) const;
+	uint32_t GetInstanceAnimationID(size_t InstanceIndex) const;
+	size_t GetInstanceAnimationPlayCount(size_t InstanceIndex) const;
+	float GetInstanceCurrentAnimationBehaviorStartTick(size_t InstanceIndex) const;
 
 // Animation baking (general)
 public:
 	bool HasBakedAnimationTexture() const;
 	bool CanBakeAnimationTexture() const;
-	void BakeAnimationTexture();
+	// @important: Affine3x4Half falls back to Affine3x4 when the texture is higher than KMaxHalfAnimationTextureHeight
+	// @important: the packed layouts need Shader/VSAnimation.cso rebuilt from Shader/VSAnimation.hlsl (or bShouldCompileShaders)
+	void BakeAnimationTexture(EAnimationTextureLayout eLayout = EAnimationTextureLayout::Matrix4x4);
 	void SaveBakedAnimationTexture(const std::string& FileName);
 	void LoadBakedAnimationTexture(const std::string& FileName);
 
@@ -248,6 +357,13 @@ public:
 	void SetAnimation(const SObjectIdentifier& Identifier, EAnimationRegistrationType eRegisteredType,
 		EAnimationOption eAnimationOption = EAnimationOption::Repeat, bool bShouldIgnoreCurrentAnimation = true);
 
+// Animation setting (instance handle)
+public:
+	void SetInstanceAnimation(const SInstanceHandle& InstanceHandle, uint32_t AnimationID,
+		EAnimationOption eAnimationOption = EAnimationOption::Repeat, bool bShouldIgnoreCurrentAnimation = true);
+	void SetInstanceAnimation(const SInstanceHandle& InstanceHandle, EAnimationRegistrationType eRegisteredType,
+		EAnimationOption eAnimationOption = EAnimationOption::Repeat, bool bShouldIgnoreCurrentAnimation = true);
+
 // Animation setting (object & instance)
 private:
 	void SetObjectAnimation(uint32_t AnimationID,
@@ -255,9 +371,9 @@ private:
 	void SetObjectAnimation(EAnimationRegistrationType eRegisteredType,
 		EAnimationOption eAnimationOption = EAnimationOption::Repeat, bool bShouldIgnoreCurrentAnimation = true);
 
-	void SetInstanceAnimation(const std::string& InstanceName, uint32_t AnimationID,
+	void SetInstanceAnimation(size_t InstanceIndex, uint32_t AnimationID,
 		EAnimationOption eAnimationOption = EAnimationOption::Repeat, bool bShouldIgnoreCurrentAnimation = true);
-	void SetInstanceAnimation(const std::string& InstanceName, EAnimationRegistrationType eRegisteredType,
+	void SetInstanceAnimation(size_t InstanceIndex, EAnimationRegistrationType eRegisteredType,
 		EAnimationOption eAnimationOption = EAnimationOption::Repeat, bool bShouldIgnoreCurrentAnimation = true);
 
 // Inner bounding volumes (general)
@@ -266,6 +382,16 @@ public:
 	const std::vector<SBoundingVolume>& GetInnerBoundingVolumeVector() const;
 	std::vector<SBoundingVolume>& GetInnerBoundingVolumeVector();
 
+// Triangle BVH (model space, one per mesh, static models only)
+public:
+	bool HasTriangleBVHs() const;
+	size_t GetTriangleBVHCount() const;
+	const CTriangleBVH& GetTriangleBVH(size_t MeshIndex) const;
+
+	// @important: the ray is transformed into model space, OutPtrTriangleVertices (3 vertices) are in world space
+	bool RayCastTriangles(const XMMATRIX& WorldMatrix, const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection,
+		XMVECTOR* const OutPtrT, XMVECTOR* const OutPtrTriangleVertices = nullptr) const;
+
 // Transform, Physics, Outer bounding sphere (identifier)
 public:
 	const SComponentTransform& GetTransform(const SObjectIdentifier& Identifier) const;
@@ -339,6 +465,50 @@ public:
 	void AddInstanceLinearAcceleration(const std::string& InstanceName, const XMVECTOR& Delta);
 	void AddInstanceLinearVelocity(const std::string& InstanceName, const XMVECTOR& Delta);
 
+	// @important: handle-based overloads, no name lookup involved
+	const SComponentTransform& GetInstanceTransform(const SInstanceHandle& InstanceHandle) const;
+	const SComponentPhysics& GetInstancePhysics(const SInstanceHandle& InstanceHandle) const;
+	const SBoundingVolume& GetInstanceOuterBoundingSphere(const SInstanceHandle& InstanceHandle) const;
+
+	void TranslateInstanceTo(const SInstanceHandle& InstanceHandle, const XMVECTOR& Prime);
+	void RotateInstancePitchTo(const SInstanceHandle& InstanceHandle, float Prime);
+	void RotateInstanceYawTo(const SInstanceHandle& InstanceHandle, float Prime);
+	void RotateInstanceRollTo(const SInstanceHandle& InstanceHandle, float Prime);
+	void ScaleInstanceTo(const SInstanceHandle& InstanceHandle, const XMVECTOR& Prime);
+
+	void TranslateInstance(const SInstanceHandle& InstanceHandle, const XMVECTOR& Delta);
+	void RotateInstancePitch(const SInstanceHandle& InstanceHandle, float Delta);
+	void RotateInstanceYaw(const SInstanceHandle& InstanceHandle, float Delta);
+	void RotateInstanceRoll(const SInstanceHandle& InstanceHandle, float Delta);
+	void ScaleInstance(const SInstanceHandle& InstanceHandle, const XMVECTOR& Delta);
+
+	void SetInstanceLinearAcceleration(const SInstanceHandle& InstanceHandle, const XMVECTOR& Prime);
+	void SetInstanceLinearVelocity(const SInstanceHandle& InstanceHandle, const XMVECTOR& Prime);
+	void AddInstanceLinearAcceleration(const SInstanceHandle& InstanceHandle, const XMVECTOR& Delta);
+	void AddInstanceLinearVelocity(const SInstanceHandle& InstanceHandle, const XMVECTOR& Delta);
+
+	// @important: index-based overloads for hot paths (physics), no name lookup involved
+	const SComponentTransform& GetInstanceTransform(size_t InstanceIndex) const;
+	const SComponentPhysics& GetInstancePhysics(size_t InstanceIndex) const;
+	const SBoundingVolume& GetInstanceOuterBoundingSphere(size_t InstanceIndex) const;
+
+	void TranslateInstanceTo(size_t InstanceIndex, const XMVECTOR& Prime);
+	void RotateInstancePitchTo(size_t InstanceIndex, float Prime);
+	void RotateInstanceYawTo(size_t InstanceIndex, float Prime);
+	void RotateInstanceRollTo(size_t InstanceIndex, float Prime);
+	void ScaleInstanceTo(size_t InstanceIndex, const XMVECTOR& Prime);
+
+	void TranslateInstance(size_t InstanceIndex, const XMVECTOR& Delta);
+	void RotateInstancePitch(size_t InstanceIndex, float Delta);
+	void RotateInstanceYaw(size_t InstanceIndex, float Delta);
+	void RotateInstanceRoll(size_t InstanceIndex, float Delta);
+	void ScaleInstance(size_t InstanceIndex, const XMVECTOR& Delta);
+
+	void SetInstanceLinearAcceleration(size_t InstanceIndex, const XMVECTOR& Prime);
+	void SetInstanceLinearVelocity(size_t InstanceIndex, const XMVECTOR& Prime);
+	void AddInstanceLinearAcceleration(size_t InstanceIndex, const XMVECTOR& Delta);
+	void AddInstanceLinearVelocity(size_t InstanceIndex, const XMVECTOR& Delta);
+
 // Material
 public:
 	void AddMaterial(const CMaterialData& MaterialData);
@@ -355,10 +525,29 @@ public:
 public:
 	void UpdateWorldMatrix();
 	void UpdateInstanceWorldMatrix(const std::string& InstanceName, bool bUpdateInstanceBuffer = true);
+	void UpdateInstanceWorldMatrix(size_t InstanceIndex, bool bUpdateInstanceBuffer = true);
 	// @warning: this function doesn't update internal InstanceCPUData
 	void UpdateInstanceWorldMatrix(const std::string& InstanceName, const XMMATRIX& WorldMatrix);
+	// @important: only the world matrices of dirty instances (transformed since their last update) are recomputed
 	void UpdateAllInstances(bool bUpdateWorldMatrix = true);
 
+private:
+	void MarkInstanceDirty(size_t InstanceIndex);
+	void MarkAllInstancesDirty();
+	void UpdateDirtyInstanceWorldMatrices();
+	void ComposeInstanceWorldMatrices(const STransformPack4& Pack, const uint32_t* const InstanceIndices, uint32_t LaneCount);
+	void LimitInstanceTransform(SObject3DInstanceCPUData& InstanceCPUData);
+
+// Instance movement tracking (for the physics engine)
+public:
+	// Moves the indices of the instances moved since the last call into vOutInstanceIndices (may hold duplicates & stale indices)
+	// @important: returns true if every instance must be considered moved, then vOutInstanceIndices is empty
+	bool ConsumeMovedInstanceIndices(std::vector<uint32_t>& vOutInstanceIndices);
+
+private:
+	void MarkInstanceMoved(size_t InstanceIndex);
+	void MarkAllInstancesMoved();
+
 public:
 	void SetInstanceHighlight(const std::string& InstanceName, bool bShouldHighlight);
 	void SetAllInstancesHighlightOff();
@@ -367,11 +556,22 @@ private:
 	void UpdateCBMaterial(const CMaterialData& MaterialData, uint32_t TotalMaterialCount) const;
 
 public:
+	// @important: touches no GPU resource (it may run on a worker thread),
+	// call UpdateInstanceBuffers() afterwards on the rendering thread if the object is instanced
 	void Animate(float DeltaTime);
 
 private:
-	void AnimateInstance(const std::string& InstanceName, float DeltaTime);
-	void CalculateAnimatedBoneMatrices(const SMeshAnimation& CurrentAnimation, float AnimationTick, const SMeshTreeNode& Node, XMMATRIX ParentTransform);
+	void AnimateInstance(size_t InstanceIndex, float DeltaTime);
+	void CalculateAnimatedBoneMatrices(uint32_t AnimationID, float AnimationTick);
+	void _CalculateAnimatedBoneMatrices(uint32_t AnimationID, float AnimationTick, XMMATRIX* const OutBoneMatrices,
+		SAnimationEvaluationScratch& Scratch) const;
+	static void BakeAnimationTextureJob(void* Context, size_t Begin, size_t End, size_t WorkerIndex);
+
+// Animation LOD
+public:
+	// @important: call once per frame, ticks advance every frame but the pose is evaluated every FrameInterval frames
+	void UpdateAnimationLOD(uint32_t FrameInterval);
+	bool ShouldEvaluateAnimationPose() const;
 
 public:
 	void Draw(EFlagsObject3DRendering eFlagsRendering = EFlagsObject3DRendering::None, size_t OneInstanceIndex = 0) const;
@@ -428,6 +628,12 @@ private:
 	static constexpr int32_t KAnimationTextureWidth{ 4 * (int32_t)KMaxBoneMatrixCount };
 	static constexpr int32_t KAnimationTextureReservedHeight{ 1 };
 	static constexpr int32_t KAnimationTextureReservedFirstPixelCount{ 2 };
+	static constexpr int32_t KAnimationTextureInfoPixelCount{ 2 }; // per animation (Matrix4x4): info, name (16 bytes)
+	static constexpr int32_t KAnimationTexturePackedInfoPixelCount{ 5 }; // per animation (Affine3x4*): info, name (a character per channel)
+	static constexpr int32_t KMaxHalfAnimationTextureHeight{ 2048 }; // rows are addressed by integers that half precision represents exactly
+	static constexpr size_t KAnimationBakeGrainSize{ 8 }; // rows per job
+	static constexpr uint32_t KInstanceUploadRangeMergeGap{ 8 }; // clean instances between two dirty ones that are uploaded anyway
+	static constexpr size_t KMaxInstanceUploadRangeCount{ 16 }; // more ranges than this are coalesced into one
 
 private:
 	ID3D11Device* const										m_PtrDevice{};
@@ -451,6 +657,7 @@ private:
 	bool													m_bShouldTesselate{ false };
 	std::unique_ptr<SMESHData>								m_Model{};
 	std::vector<std::unique_ptr<CMaterialTextureSet>>		m_vMaterialTextureSets{};
+	std::vector<std::unique_ptr<CTriangleBVH>>				m_vTriangleBVHs{};
 
 private:
 	std::vector<SMeshBuffers>								m_vMeshBuffers{};
@@ -471,8 +678,21 @@ private:
 private:
 	XMMATRIX												m_AnimatedBoneMatrices[KMaxBoneMatrixCount]{};
 	bool													m_bIsBakedAnimationLoaded{ false };
+	bool													m_bShouldCompressAnimations{ true };
 	std::unique_ptr<CTexture>								m_BakedAnimationTexture{};
 	SCBAnimationData										m_CBAnimationData{};
+	SAnimationEvaluationScratch								m_AnimationEvaluationScratch{};
+
+// Animation node tables (built whenever animations are added or loaded)
+private:
+	std::vector<uint32_t>									m_vAnimationNodeOrder{}; // tree node indices, parents first
+	std::vector<int32_t>									m_vAnimationNodeParentIndices{}; // per tree node (-1 for the root)
+	std::vector<std::vector<int32_t>>						m_vAnimationNodeAnimationIndices{}; // [AnimationID][tree node index] -> node animation index (-1 if not animated)
+
+// Animation LOD
+private:
+	uint32_t												m_AnimationEvaluationFrameCountdown{}; // frames until the next pose evaluation
+	bool													m_bShouldEvaluateAnimationPose{ true };
 
 private:
 	std::unordered_map<EAnimationRegistrationType, size_t>	m_umapRegisteredAnimationTypeToIndex{};
@@ -483,7 +703,39 @@ private:
 private:
 	std::vector<SObject3DInstanceGPUData>					m_vInstanceGPUData{};
 	std::vector<SObject3DInstanceCPUData>					m_vInstanceCPUData{};
-	std::map<std::string, size_t>							m_mapInstanceNameToIndex{};
+	std::map<std::string, size_t>							m_mapInstanceNameToIndex{}; // editor only
+
+// Instance slot map (SInstanceHandle::Slot -> instance index)
+private:
+	struct SInstanceSlot
+	{
+		uint32_t	InstanceIndex{};
+		uint32_t	Generation{};
+	};
+
+	std::vector<SInstanceSlot>								m_vInstanceSlots{};
+	std::vector<uint32_t>									m_vInstanceSlotIndices{}; // instance index -> slot
+	std::vector<uint32_t>									m_vFreeInstanceSlots{};
+
+// Instance dirty tracking (per instance index)
+private:
+	std::vector<uint8_t>									m_vInstanceDirtyFlags{};
+	std::vector<uint32_t>									m_vDirtyInstanceIndices{}; // may hold stale indices, flags decide
+
+// Instance movement tracking
+private:
+	std::vector<uint32_t>									m_vMovedInstanceIndices{}; // may hold duplicates & stale indices
+	bool													m_bHaveAllInstancesMoved{ true };
+
+// Instance buffer upload (dirty ranges are staged once in the ring, then copied into the instance buffer of every mesh)
+private:
+	ComPtr<ID3D11Buffer>									m_InstanceUploadRing{};
+	uint32_t												m_InstanceBufferCapacity{}; // of both the ring and the instance buffers
+	UINT													m_InstanceUploadRingOffset{};
+	std::vector<uint32_t>									m_vGPUDirtyInstanceIndices{}; // may hold duplicates and stale indices
+	bool													m_bShouldUploadAllInstances{};
+	std::vector<SInstanceUploadRange>						m_vInstanceUploadRanges{};
+	SInstanceUploadStatistics								m_InstanceUploadStatistics{};
 };
 
 ENUM_CLASS_FLAG(CObject3D::EFlagsRendering)
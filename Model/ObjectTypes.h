@@ -45,15 +45,34 @@ struct SMesh
 	uint8_t							MaterialID{};
 };
 
+// Generational handle of an instance of CObject3D
+// It stays valid across deletions of other instances, and becomes stale (not reused) once its instance is deleted.
+struct SInstanceHandle
+{
+	static constexpr uint32_t KInvalidSlot{ 0xFFFFFFFF };
+
+	bool IsNull() const { return (Slot == KInvalidSlot); }
+	bool operator==(const SInstanceHandle& b) const { return (Slot == b.Slot && Generation == b.Generation); }
+	bool operator!=(const SInstanceHandle& b) const { return !(*this == b); }
+
+	uint32_t	Slot{ KInvalidSlot };
+	uint32_t	Generation{};
+};
+
 class CObject3D;
 struct SObjectIdentifier
 {
 	SObjectIdentifier() {}
 	SObjectIdentifier(CObject3D* _Object3D) : Object3D{ _Object3D } {}
+	SObjectIdentifier(CObject3D* _Object3D, const SInstanceHandle& _InstanceHandle) : Object3D{ _Object3D }, InstanceHandle{ _InstanceHandle } {}
+	// @important: name-based identifiers are resolved by name lookup on every call, prefer handles
 	SObjectIdentifier(CObject3D* _Object3D, const std::string& _InstanceName) : Object3D{ _Object3D }, InstanceName{ _InstanceName } {}
 
-	CObject3D*	Object3D{};
-	std::string	InstanceName{};
+	bool IsInstance() const { return (!InstanceHandle.IsNull() || InstanceName.size()); }
+
+	CObject3D*		Object3D{};
+	SInstanceHandle	InstanceHandle{};
+	std::string		InstanceName{}; // optional (editor)
 };
 
 struct SObject3DInstanceCPUData
@@ -0,0 +1,458 @@
+#include "DynamicAABBTree.h"
+
+using std::max;
+using std::min;
+
+CDynamicAABBTree::CDynamicAABBTree()
+{
+}
+
+CDynamicAABBTree::~CDynamicAABBTree()
+{
+}
+
+void CDynamicAABBTree::Clear()
+{
+	m_vNodes.clear();
+	m_RootNode = KNullNode;
+	m_FreeList = KNullNode;
+	m_ProxyCount = 0;
+}
+
+int32_t CDynamicAABBTree::CreateProxy(const SAABB& AABB, void* UserData, size_t UserIndex)
+{
+	int32_t ProxyID{ AllocateNode() };
+
+	XMVECTOR Margin{ XMVectorReplicate(KFatMargin) };
+	m_vNodes[ProxyID].AABB.Min = AABB.Min - Margin;
+	m_vNodes[ProxyID].AABB.Max = AABB.Max + Margin;
+	m_vNodes[ProxyID].UserData = UserData;
+	m_vNodes[ProxyID].UserIndex = UserIndex;
+	m_vNodes[ProxyID].Height = 0;
+
+	InsertLeaf(ProxyID);
+
+	++m_ProxyCount;
+
+	return ProxyID;
+}
+
+void CDynamicAABBTree::DestroyProxy(int32_t ProxyID)
+{
+	assert(ProxyID >= 0 && ProxyID < (int32_t)m_vNodes.size());
+	assert(m_vNodes[ProxyID].IsLeaf());
+
+	RemoveLeaf(ProxyID);
+	FreeNode(ProxyID);
+
+	--m_ProxyCount;
+}
+
+bool CDynamicAABBTree::MoveProxy(int32_t ProxyID, const SAABB& AABB)
+{
+	assert(ProxyID >= 0 && ProxyID < (int32_t)m_vNodes.size());
+	assert(m_vNodes[ProxyID].IsLeaf());
+
+	// @important: still inside the fattened AABB, no need to touch the tree
+	if (Contains(m_vNodes[ProxyID].AABB, AABB)) return false;
+
+	RemoveLeaf(ProxyID);
+
+	XMVECTOR Margin{ XMVectorReplicate(KFatMargin) };
+	m_vNodes[ProxyID].AABB.Min = AABB.Min - Margin;
+	m_vNodes[ProxyID].AABB.Max = AABB.Max + Margin;
+
+	InsertLeaf(ProxyID);
+
+	return true;
+}
+
+void* CDynamicAABBTree::GetUserData(int32_t ProxyID) const
+{
+	return m_vNodes[ProxyID].UserData;
+}
+
+size_t CDynamicAABBTree::GetUserIndex(int32_t ProxyID) const
+{
+	return m_vNodes[ProxyID].UserIndex;
+}
+
+const SAABB& CDynamicAABBTree::GetFatAABB(int32_t ProxyID) const
+{
+	return m_vNodes[ProxyID].AABB;
+}
+
+int32_t CDynamicAABBTree::GetHeight() const
+{
+	if (m_RootNode == KNullNode) return 0;
+	return m_vNodes[m_RootNode].Height;
+}
+
+size_t CDynamicAABBTree::GetProxyCount() const
+{
+	return m_ProxyCount;
+}
+
+void CDynamicAABBTree::Query(const SAABB& AABB, std::vector<int32_t>& vOutProxyIDs) const
+{
+	Query(AABB, vOutProxyIDs, m_vQueryStack);
+}
+
+void CDynamicAABBTree::Query(const SAABB& AABB, std::vector<int32_t>& vOutProxyIDs, std::vector<int32_t>& vStack) const
+{
+	if (m_RootNode == KNullNode) return;
+
+	vStack.clear();
+	vStack.emplace_back(m_RootNode);
+	while (vStack.size())
+	{
+		int32_t NodeID{ vStack.back() };
+		vStack.pop_back();
+
+		const SNode& Node{ m_vNodes[NodeID] };
+		if (!Overlaps(Node.AABB, AABB)) continue;
+
+		if (Node.IsLeaf())
+		{
+			vOutProxyIDs.emplace_back(NodeID);
+		}
+		else
+		{
+			vStack.emplace_back(Node.ChildA);
+			vStack.emplace_back(Node.ChildB);
+		}
+	}
+}
+
+void CDynamicAABBTree::QueryRayPacket(const SRayPacket& Packet, const float* const MaxTs,
+	std::vector<std::pair<int32_t, uint32_t>>& vOutProxyRayMasks, std::vector<std::pair<int32_t, uint32_t>>& vStack) const
+{
+	if (m_RootNode == KNullNode || Packet.RayCount == 0) return;
+
+	uint32_t AllRayMask{ (Packet.RayCount >= 32) ? 0xFFFFFFFF : ((1u << Packet.RayCount) - 1) };
+
+	vStack.clear();
+	vStack.emplace_back(m_RootNode, AllRayMask);
+	while (vStack.size())
+	{
+		auto Item{ vStack.back() };
+		vStack.pop_back();
+
+		// @important: children are only tested against the rays that have hit their parent
+		const SNode& Node{ m_vNodes[Item.first] };
+		uint32_t RayMask{ IntersectRayPacket(Node.AABB, Packet, Item.second, MaxTs) };
+		if (RayMask == 0) continue;
+
+		if (Node.IsLeaf())
+		{
+			vOutProxyRayMasks.emplace_back(Item.first, RayMask);
+		}
+		else
+		{
+			vStack.emplace_back(Node.ChildA, RayMask);
+			vStack.emplace_back(Node.ChildB, RayMask);
+		}
+	}
+}
+
+SAABB CDynamicAABBTree::MakeSphereAABB(const XMVECTOR& Center, float Radius)
+{
+	XMVECTOR Extent{ XMVectorSet(Radius, Radius, Radius, 0) };
+	return SAABB(Center - Extent, Center + Extent);
+}
+
+bool CDynamicAABBTree::Overlaps(const SAABB& A, const SAABB& B)
+{
+	return XMVector3LessOrEqual(A.Min, B.Max) && XMVector3LessOrEqual(B.Min, A.Max);
+}
+
+bool CDynamicAABBTree::Contains(const SAABB& Outer, const SAABB& Inner)
+{
+	return XMVector3LessOrEqual(Outer.Min, Inner.Min) && XMVector3LessOrEqual(Inner.Max, Outer.Max);
+}
+
+int32_t CDynamicAABBTree::AllocateNode()
+{
+	if (m_FreeList == KNullNode)
+	{
+		m_vNodes.emplace_back();
+		return (int32_t)m_vNodes.size() - 1;
+	}
+
+	int32_t NodeID{ m_FreeList };
+	m_FreeList = m_vNodes[NodeID].Parent;
+	m_vNodes[NodeID] = SNode();
+	return NodeID;
+}
+
+void CDynamicAABBTree::FreeNode(int32_t NodeID)
+{
+	m_vNodes[NodeID].Parent = m_FreeList;
+	m_vNodes[NodeID].Height = -1;
+	m_vNodes[NodeID].UserData = nullptr;
+	m_FreeList = NodeID;
+}
+
+void CDynamicAABBTree::InsertLeaf(int32_t LeafID)
+{
+	if (m_RootNode == KNullNode)
+	{
+		m_RootNode = LeafID;
+		m_vNodes[m_RootNode].Parent = KNullNode;
+		return;
+	}
+
+	// Find the best sibling (surface area heuristic)
+	const SAABB LeafAABB{ m_vNodes[LeafID].AABB };
+	int32_t Index{ m_RootNode };
+	while (!m_vNodes[Index].IsLeaf())
+	{
+		const SNode& Node{ m_vNodes[Index] };
+
+		float Area{ GetSurfaceArea(Node.AABB) };
+		float CombinedArea{ GetSurfaceArea(Union(Node.AABB, LeafAABB)) };
+
+		// Cost of creating a new parent for this node and the new leaf
+		float Cost{ 2.0f * CombinedArea };
+
+		// Minimum cost of pushing the leaf further down the tree
+		float InheritanceCost{ 2.0f * (CombinedArea - Area) };
+
+		float CostA{ GetSurfaceArea(Union(LeafAABB, m_vNodes[Node.ChildA].AABB)) + InheritanceCost };
+		if (!m_vNodes[Node.ChildA].IsLeaf()) CostA -= GetSurfaceArea(m_vNodes[Node.ChildA].AABB);
+
+		float CostB{ GetSurfaceArea(Union(LeafAABB, m_vNodes[Node.ChildB].AABB)) + InheritanceCost };
+		if (!m_vNodes[Node.ChildB].IsLeaf()) CostB -= GetSurfaceArea(m_vNodes[Node.ChildB].AABB);
+
+		if (Cost < CostA && Cost < CostB) break;
+
+		Index = (CostA < CostB) ? Node.ChildA : Node.ChildB;
+	}
+	int32_t Sibling{ Index };
+
+	// Create a new parent
+	int32_t OldParent{ m_vNodes[Sibling].Parent };
+	int32_t NewParent{ AllocateNode() };
+	m_vNodes[NewParent].Parent = OldParent;
+	m_vNodes[NewParent].AABB = Union(LeafAABB, m_vNodes[Sibling].AABB);
+	m_vNodes[NewParent].Height = m_vNodes[Sibling].Height + 1;
+	m_vNodes[NewParent].ChildA = Sibling;
+	m_vNodes[NewParent].ChildB = LeafID;
+	m_vNodes[Sibling].Parent = NewParent;
+	m_vNodes[LeafID].Parent = NewParent;
+
+	if (OldParent == KNullNode)
+	{
+		m_RootNode = NewParent;
+	}
+	else
+	{
+		if (m_vNodes[OldParent].ChildA == Sibling)
+		{
+			m_vNodes[OldParent].ChildA = NewParent;
+		}
+		else
+		{
+			m_vNodes[OldParent].ChildB = NewParent;
+		}
+	}
+
+	RefitAncestors(m_vNodes[LeafID].Parent);
+}
+
+void CDynamicAABBTree::RemoveLeaf(int32_t LeafID)
+{
+	if (LeafID == m_RootNode)
+	{
+		m_RootNode = KNullNode;
+		return;
+	}
+
+	int32_t Parent{ m_vNodes[LeafID].Parent };
+	int32_t GrandParent{ m_vNodes[Parent].Parent };
+	int32_t Sibling{ (m_vNodes[Parent].ChildA == LeafID) ? m_vNodes[Parent].ChildB : m_vNodes[Parent].ChildA };
+
+	if (GrandParent == KNullNode)
+	{
+		m_RootNode = Sibling;
+		m_vNodes[Sibling].Parent = KNullNode;
+		FreeNode(Parent);
+		return;
+	}
+
+	// Destroy parent and connect sibling to grand parent
+	if (m_vNodes[GrandParent].ChildA == Parent)
+	{
+		m_vNodes[GrandParent].ChildA = Sibling;
+	}
+	else
+	{
+		m_vNodes[GrandParent].ChildB = Sibling;
+	}
+	m_vNodes[Sibling].Parent = GrandParent;
+	FreeNode(Parent);
+
+	RefitAncestors(GrandParent);
+}
+
+void CDynamicAABBTree::RefitAncestors(int32_t NodeID)
+{
+	int32_t Index{ NodeID };
+	while (Index != KNullNode)
+	{
+		Index = Balance(Index);
+
+		SNode& Node{ m_vNodes[Index] };
+		const SNode& ChildA{ m_vNodes[Node.ChildA] };
+		const SNode& ChildB{ m_vNodes[Node.ChildB] };
+
+		Node.Height = 1 + max(ChildA.Height, ChildB.Height);
+		Node.AABB = Union(ChildA.AABB, ChildB.AABB);
+
+		Index = Node.Parent;
+	}
+}
+
+// Performs a left or right rotation if node A is imbalanced.
+// Returns the new root index of the rotated sub-tree.
+int32_t CDynamicAABBTree::Balance(int32_t iA)
+{
+	SNode& A{ m_vNodes[iA] };
+	if (A.IsLeaf() || A.Height < 2) return iA;
+
+	int32_t iB{ A.ChildA };
+	int32_t iC{ A.ChildB };
+	int32_t BalanceFactor{ m_vNodes[iC].Height - m_vNodes[iB].Height };
+
+	// Rotate C up
+	if (BalanceFactor > 1)
+	{
+		SNode& C{ m_vNodes[iC] };
+		int32_t iF{ C.ChildA };
+		int32_t iG{ C.ChildB };
+
+		C.ChildA = iA;
+		C.Parent = A.Parent;
+		A.Parent = iC;
+
+		if (C.Parent != KNullNode)
+		{
+			if (m_vNodes[C.Parent].ChildA == iA)
+			{
+				m_vNodes[C.Parent].ChildA = iC;
+			}
+			else
+			{
+				m_vNodes[C.Parent].ChildB = iC;
+			}
+		}
+		else
+		{
+			m_RootNode = iC;
+		}
+
+		if (m_vNodes[iF].Height > m_vNodes[iG].Height)
+		{
+			C.ChildB = iF;
+			A.ChildB = iG;
+			m_vNodes[iG].Parent = iA;
+		}
+		else
+		{
+			C.ChildB = iG;
+			A.ChildB = iF;
+			m_vNodes[iF].Parent = iA;
+		}
+
+		A.AABB = Union(m_vNodes[A.ChildA].AABB, m_vNodes[A.ChildB].AABB);
+		A.Height = 1 + max(m_vNodes[A.ChildA].Height, m_vNodes[A.ChildB].Height);
+		C.AABB = Union(A.AABB, m_vNodes[C.ChildB].AABB);
+		C.Height = 1 + max(A.Height, m_vNodes[C.ChildB].Height);
+
+		return iC;
+	}
+
+	// Rotate B up
+	if (BalanceFactor < -1)
+	{
+		SNode& B{ m_vNodes[iB] };
+		int32_t iD{ B.ChildA };
+		int32_t iE{ B.ChildB };
+
+		B.ChildA = iA;
+		B.Parent = A.Parent;
+		A.Parent = iB;
+
+		if (B.Parent != KNullNode)
+		{
+			if (m_vNodes[B.Parent].ChildA == iA)
+			{
+				m_vNodes[B.Parent].ChildA = iB;
+			}
+			else
+			{
+				m_vNodes[B.Parent].ChildB = iB;
+			}
+		}
+		else
+		{
+			m_RootNode = iB;
+		}
+
+		if (m_vNodes[iD].Height > m_vNodes[iE].Height)
+		{
+			B.ChildB = iD;
+			A.ChildA = iE;
+			m_vNodes[iE].Parent = iA;
+		}
+		else
+		{
+			B.ChildB = iE;
+			A.ChildA = iD;
+			m_vNodes[iD].Parent = iA;
+		}
+
+		A.AABB = Union(m_vNodes[A.ChildA].AABB, m_vNodes[A.ChildB].AABB);
+		A.Height = 1 + max(m_vNodes[A.ChildA].Height, m_vNodes[A.ChildB].Height);
+		B.AABB = Union(A.AABB, m_vNodes[B.ChildB].AABB);
+		B.Height = 1 + max(A.Height, m_vNodes[B.ChildB].Height);
+
+		return iB;
+	}
+
+	return iA;
+}
+
+uint32_t CDynamicAABBTree::IntersectRayPacket(const SAABB& AABB, const SRayPacket& Packet, uint32_t RayMask, const float* const MaxTs)
+{
+	uint32_t HitMask{};
+	for (uint32_t iRay = 0; iRay < Packet.RayCount; ++iRay)
+	{
+		if ((RayMask & (1u << iRay)) == 0) continue;
+
+		// Slab test
+		XMVECTOR T0{ (AABB.Min - Packet.Origins[iRay]) * Packet.InverseDirections[iRay] };
+		XMVECTOR T1{ (AABB.Max - Packet.Origins[iRay]) * Packet.InverseDirections[iRay] };
+		XMVECTOR TMin{ XMVectorMin(T0, T1) };
+		XMVECTOR TMax{ XMVectorMax(T0, T1) };
+
+		float Enter{ max(XMVectorGetX(TMin), max(XMVectorGetY(TMin), XMVectorGetZ(TMin))) };
+		float Exit{ min(XMVectorGetX(TMax), min(XMVectorGetY(TMax), XMVectorGetZ(TMax))) };
+		if (Enter <= Exit && Exit >= 0.0f && Enter < MaxTs[iRay]) HitMask |= (1u << iRay);
+	}
+	return HitMask;
+}
+
+SAABB CDynamicAABBTree::Union(const SAABB& A, const SAABB& B)
+{
+	return SAABB(XMVectorMin(A.Min, B.Min), XMVectorMax(A.Max, B.Max));
+}
+
+float CDynamicAABBTree::GetSurfaceArea(const SAABB& AABB)
+{
+	XMVECTOR Extent{ AABB.Max - AABB.Min };
+	float X{ XMVectorGetX(Extent) };
+	float Y{ XMVectorGetY(Extent) };
+	float Z{ XMVectorGetZ(Extent) };
+	return 2.0f * (X * Y + Y * Z + Z * X);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "../Core/SharedHeader.h"
+
+struct SAABB
+{
+	SAABB() {}
+	SAABB(const XMVECTOR& _Min, const XMVECTOR& _Max) : Min{ _Min }, Max{ _Max } {}
+
+	XMVECTOR	Min{};
+	XMVECTOR	Max{};
+};
+
+// Rays that are traversed together (one bit of a ray mask per ray)
+// Rays of a packet should be coherent (similar origins & directions), or the packet degrades to single rays.
+struct SRayPacket
+{
+	static constexpr uint32_t KMaxRayCount{ 32 };
+
+	XMVECTOR	Origins[KMaxRayCount]{};
+	XMVECTOR	Directions[KMaxRayCount]{};
+	XMVECTOR	InverseDirections[KMaxRayCount]{};
+	uint32_t	RayCount{};
+};
+
+// Dynamic bounding volume hierarchy (incrementally updated, balanced by tree rotations)
+// Leaves are stored with "fattened" AABBs, so small movements don't touch the tree at all.
+class CDynamicAABBTree final
+{
+public:
+	static constexpr int32_t KNullNode{ -1 };
+	static constexpr float KFatMargin{ 0.25f };
+
+private:
+	struct SNode
+	{
+		bool IsLeaf() const { return (ChildA == KNullNode); }
+
+		SAABB		AABB{};
+		void*		UserData{};
+		size_t		UserIndex{};
+		int32_t		Parent{ KNullNode }; // or next free node
+		int32_t		ChildA{ KNullNode };
+		int32_t		ChildB{ KNullNode };
+		int32_t		Height{ -1 }; // leaf: 0, free node: -1
+	};
+
+public:
+	CDynamicAABBTree();
+	~CDynamicAABBTree();
+
+public:
+	void Clear();
+
+public:
+	int32_t CreateProxy(const SAABB& AABB, void* UserData, size_t UserIndex);
+	void DestroyProxy(int32_t ProxyID);
+
+	// @important: returns true only if the tree was modified
+	bool MoveProxy(int32_t ProxyID, const SAABB& AABB);
+
+public:
+	void* GetUserData(int32_t ProxyID) const;
+	size_t GetUserIndex(int32_t ProxyID) const;
+	const SAABB& GetFatAABB(int32_t ProxyID) const;
+	int32_t GetHeight() const;
+	size_t GetProxyCount() const;
+
+public:
+	void Query(const SAABB& AABB, std::vector<int32_t>& vOutProxyIDs) const;
+	// @important: thread-safe as long as every thread passes its own stack
+	void Query(const SAABB& AABB, std::vector<int32_t>& vOutProxyIDs, std::vector<int32_t>& vStack) const;
+	// (ProxyID, mask of the rays that have hit its fattened AABB), rays are culled by MaxTs[] as well
+	// @important: thread-safe as long as every thread passes its own stack
+	void QueryRayPacket(const SRayPacket& Packet, const float* const MaxTs, std::vector<std::pair<int32_t, uint32_t>>& vOutProxyRayMasks,
+		std::vector<std::pair<int32_t, uint32_t>>& vStack) const;
+
+public:
+	static SAABB MakeSphereAABB(const XMVECTOR& Center, float Radius);
+	static bool Overlaps(const SAABB& A, const SAABB& B);
+	static bool Contains(const SAABB& Outer, const SAABB& Inner);
+	// @important: returns the mask of the rays in RayMask that hit the AABB before their MaxTs[]
+	static uint32_t IntersectRayPacket(const SAABB& AABB, const SRayPacket& Packet, uint32_t RayMask, const float* const MaxTs);
+
+private:
+	int32_t AllocateNode();
+	void FreeNode(int32_t NodeID);
+
+	void InsertLeaf(int32_t LeafID);
+	void RemoveLeaf(int32_t LeafID);
+	void RefitAncestors(int32_t NodeID);
+	int32_t Balance(int32_t NodeID);
+
+private:
+	static SAABB Union(const SAABB& A, const SAABB& B);
+	static float GetSurfaceArea(const SAABB& AABB);
+
+private:
+	std::vector<SNode>				m_vNodes{};
+	int32_t							m_RootNode{ KNullNode };
+	int32_t							m_FreeList{ KNullNode };
+	size_t							m_ProxyCount{};
+
+private:
+	mutable std::vector<int32_t>	m_vQueryStack{};
+};
@@ -0,0 +1,193 @@
+#include "HeightField.h"
+#include "../Core/Math.h"
+#include "../Core/Material.h"
+#include "../Model/MeshPorter.h"
+
+using std::max;
+using std::min;
+
+CHeightField::CHeightField()
+{
+}
+
+CHeightField::~CHeightField()
+{
+}
+
+void CHeightField::Build(const STERRData& TerrainData)
+{
+	Clear();
+
+	uint32_t SampleCountX{ (uint32_t)TerrainData.SizeX + 1 };
+	uint32_t SampleCountZ{ (uint32_t)TerrainData.SizeZ + 1 };
+	if (SampleCountX < 2 || SampleCountZ < 2) return;
+	if (TerrainData.vHeightMapTextureRawData.size() < (size_t)SampleCountX * SampleCountZ) return;
+
+	float Scaling{ (TerrainData.UniformScalingFactor > 0.0f) ? TerrainData.UniformScalingFactor : 1.0f };
+	m_SampleCountX = SampleCountX;
+	m_SampleCountZ = SampleCountZ;
+	m_InverseCellSize = 1.0f / Scaling;
+	m_OriginX = -(float)(int)(TerrainData.SizeX * 0.5f) * Scaling;
+	m_OriginZ = +(float)(int)(TerrainData.SizeZ * 0.5f) * Scaling;
+
+	// Same as the terrain vertex shader: [0, 255] -> [-HeightRange / 2, +HeightRange / 2]
+	m_vHeights.resize((size_t)SampleCountX * SampleCountZ);
+	for (size_t iSample = 0; iSample < m_vHeights.size(); ++iSample)
+	{
+		float NormalizedHeight{ (float)TerrainData.vHeightMapTextureRawData[iSample].R / 255.0f };
+		m_vHeights[iSample] = (NormalizedHeight * TerrainData.HeightRange - TerrainData.HeightRange * 0.5f) * Scaling;
+	}
+}
+
+void CHeightField::Clear()
+{
+	m_vHeights.clear();
+	m_SampleCountX = 0;
+	m_SampleCountZ = 0;
+}
+
+bool CHeightField::GetHeight(float X, float Z, float* const OutPtrHeight, XMVECTOR* const OutPtrNormal) const
+{
+	if (!IsBuilt()) return false;
+
+	XMVECTOR Position{ XMVectorSet(X, 0, Z, 1) };
+	float Height{};
+	XMVECTOR Normal{};
+	GetHeights4(&Position, 1, &Height, &Normal);
+	if (Height == -FLT_MAX) return false;
+
+	if (OutPtrHeight) *OutPtrHeight = Height;
+	if (OutPtrNormal) *OutPtrNormal = Normal;
+	return true;
+}
+
+void CHeightField::GetHeights(const XMVECTOR* const Positions, size_t Count, float* const OutHeights, XMVECTOR* const OutNormals) const
+{
+	for (size_t iFirst = 0; iFirst < Count; iFirst += KLaneCount)
+	{
+		uint32_t LaneCount{ (uint32_t)min(Count - iFirst, (size_t)KLaneCount) };
+		if (IsBuilt())
+		{
+			GetHeights4(&Positions[iFirst], LaneCount, &OutHeights[iFirst], (OutNormals) ? &OutNormals[iFirst] : nullptr);
+		}
+		else
+		{
+			for (uint32_t iLane = 0; iLane < LaneCount; ++iLane)
+			{
+				OutHeights[iFirst + iLane] = -FLT_MAX;
+				if (OutNormals) OutNormals[iFirst + iLane] = XMVectorSet(0, 1, 0, 0);
+			}
+		}
+	}
+}
+
+bool CHeightField::IsBuilt() const
+{
+	return !m_vHeights.empty();
+}
+
+uint32_t CHeightField::GetSampleCountX() const
+{
+	return m_SampleCountX;
+}
+
+uint32_t CHeightField::GetSampleCountZ() const
+{
+	return m_SampleCountZ;
+}
+
+void CHeightField::GetHeights4(const XMVECTOR* const Positions, uint32_t LaneCount, float* const OutHeights, XMVECTOR* const OutNormals) const
+{
+	// Unused lanes repeat the first position
+	float Xs[KLaneCount]{};
+	float Zs[KLaneCount]{};
+	for (uint32_t iLane = 0; iLane < KLaneCount; ++iLane)
+	{
+		const XMVECTOR& Position{ Positions[(iLane < LaneCount) ? iLane : 0] };
+		Xs[iLane] = XMVectorGetX(Position);
+		Zs[iLane] = XMVectorGetZ(Position);
+	}
+
+	// Grid space (row 0 is at the greatest Z)
+	const XMVECTOR KInverseCellSize{ XMVectorReplicate(m_InverseCellSize) };
+	const XMVECTOR KMaxCellX{ XMVectorReplicate((float)(m_SampleCountX - 2)) };
+	const XMVECTOR KMaxCellZ{ XMVectorReplicate((float)(m_SampleCountZ - 2)) };
+	XMVECTOR GridX{ (XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Xs)) - XMVectorReplicate(m_OriginX)) * KInverseCellSize };
+	XMVECTOR GridZ{ (XMVectorReplicate(m_OriginZ) - XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Zs))) * KInverseCellSize };
+	XMVECTOR CellX{ XMVectorMin(XMVectorFloor(XMVectorMax(GridX, KVectorZero)), KMaxCellX) };
+	XMVECTOR CellZ{ XMVectorMin(XMVectorFloor(XMVectorMax(GridZ, KVectorZero)), KMaxCellZ) };
+	XMVECTOR FractionX{ GridX - CellX };
+	XMVECTOR FractionZ{ GridZ - CellZ };
+
+	// Gather
+	XMFLOAT4 GridXs{}, GridZs{}, CellXs{}, CellZs{};
+	XMStoreFloat4(&GridXs, GridX);
+	XMStoreFloat4(&GridZs, GridZ);
+	XMStoreFloat4(&CellXs, CellX);
+	XMStoreFloat4(&CellZs, CellZ);
+	const float* const PtrGridXs{ &GridXs.x };
+	const float* const PtrGridZs{ &GridZs.x };
+	const float* const PtrCellXs{ &CellXs.x };
+	const float* const PtrCellZs{ &CellZs.x };
+	float H00s[KLaneCount]{};
+	float H10s[KLaneCount]{};
+	float H01s[KLaneCount]{};
+	float H11s[KLaneCount]{};
+	bool bIsInside[KLaneCount]{};
+	for (uint32_t iLane = 0; iLane < KLaneCount; ++iLane)
+	{
+		uint32_t Column{ (uint32_t)PtrCellXs[iLane] };
+		uint32_t Row{ (uint32_t)PtrCellZs[iLane] };
+		H00s[iLane] = GetSample(Column, Row);
+		H10s[iLane] = GetSample(Column + 1, Row);
+		H01s[iLane] = GetSample(Column, Row + 1);
+		H11s[iLane] = GetSample(Column + 1, Row + 1);
+		bIsInside[iLane] = (PtrGridXs[iLane] >= 0.0f && PtrGridXs[iLane] <= (float)(m_SampleCountX - 1) &&
+			PtrGridZs[iLane] >= 0.0f && PtrGridZs[iLane] <= (float)(m_SampleCountZ - 1));
+	}
+
+	// Bilinear filter
+	XMVECTOR H00{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(H00s)) };
+	XMVECTOR H10{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(H10s)) };
+	XMVECTOR H01{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(H01s)) };
+	XMVECTOR H11{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(H11s)) };
+	XMVECTOR DeltaX0{ H10 - H00 };
+	XMVECTOR DeltaX1{ H11 - H01 };
+	XMVECTOR DeltaZ0{ H01 - H00 };
+	XMVECTOR DeltaZ1{ H11 - H10 };
+	XMVECTOR Height0{ H00 + DeltaX0 * FractionX };
+	XMVECTOR Height1{ H01 + DeltaX1 * FractionX };
+	XMVECTOR Height{ Height0 + (Height1 - Height0) * FractionZ };
+
+	XMFLOAT4 Heights{};
+	XMStoreFloat4(&Heights, Height);
+	const float* const PtrHeights{ &Heights.x };
+	for (uint32_t iLane = 0; iLane < LaneCount; ++iLane)
+	{
+		OutHeights[iLane] = (bIsInside[iLane]) ? PtrHeights[iLane] : -FLT_MAX;
+	}
+
+	if (!OutNormals) return;
+
+	// Normal = normalize(-dH/dX, 1, -dH/dZ) (grid Z is the opposite of world Z)
+	XMVECTOR NormalX{ -(DeltaX0 + (DeltaX1 - DeltaX0) * FractionZ) * KInverseCellSize };
+	XMVECTOR NormalZ{ (DeltaZ0 + (DeltaZ1 - DeltaZ0) * FractionX) * KInverseCellSize };
+	XMVECTOR InverseLength{ XMVectorReciprocal(XMVectorSqrt(NormalX * NormalX + NormalZ * NormalZ + XMVectorReplicate(1.0f))) };
+	NormalX = NormalX * InverseLength;
+	NormalZ = NormalZ * InverseLength;
+
+	XMFLOAT4 NormalXs{}, NormalYs{}, NormalZs{};
+	XMStoreFloat4(&NormalXs, NormalX);
+	XMStoreFloat4(&NormalYs, InverseLength);
+	XMStoreFloat4(&NormalZs, NormalZ);
+	for (uint32_t iLane = 0; iLane < LaneCount; ++iLane)
+	{
+		OutNormals[iLane] = (bIsInside[iLane]) ?
+			XMVectorSet((&NormalXs.x)[iLane], (&NormalYs.x)[iLane], (&NormalZs.x)[iLane], 0) : XMVectorSet(0, 1, 0, 0);
+	}
+}
+
+float CHeightField::GetSample(uint32_t Column, uint32_t Row) const
+{
+	return m_vHeights[(size_t)Row * m_SampleCountX + Column];
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../Core/SharedHeader.h"
+
+struct STERRData;
+
+// Height field collider of a terrain, built from its height map (STERRData::vHeightMapTextureRawData)
+// Samples are converted to world space heights once, so that a query is a bilinear filter of 4 samples
+// with one sample per terrain vertex (the same mapping as CTerrain::GetTerrainHeightAt(int, int)).
+class CHeightField final
+{
+public:
+	static constexpr uint32_t KLaneCount{ 4 };
+
+public:
+	CHeightField();
+	~CHeightField();
+
+public:
+	// @important: the terrain is scaled by its uniform scaling factor and is not translated
+	void Build(const STERRData& TerrainData);
+	void Clear();
+
+public:
+	// @important: returns false if (X, Z) is outside of the height field
+	bool GetHeight(float X, float Z, float* const OutPtrHeight, XMVECTOR* const OutPtrNormal = nullptr) const;
+
+	// Batched query of 4 positions at a time (only X & Z of Positions are used, OutNormals may be null)
+	// @important: heights of positions outside of the height field are -FLT_MAX, their normals are +Y
+	void GetHeights(const XMVECTOR* const Positions, size_t Count, float* const OutHeights, XMVECTOR* const OutNormals) const;
+
+public:
+	bool IsBuilt() const;
+	uint32_t GetSampleCountX() const;
+	uint32_t GetSampleCountZ() const;
+
+private:
+	void GetHeights4(const XMVECTOR* const Positions, uint32_t LaneCount, float* const OutHeights, XMVECTOR* const OutNormals) const;
+	float GetSample(uint32_t Column, uint32_t Row) const;
+
+private:
+	std::vector<float>	m_vHeights{}; // world space, row-major (row 0 is at the greatest Z)
+	uint32_t			m_SampleCountX{};
+	uint32_t			m_SampleCountZ{};
+	float				m_OriginX{}; // world X of column 0
+	float				m_OriginZ{}; // world Z of row 0
+	float				m_InverseCellSize{ 1.0f };
+};
@@ -1,12 +1,14 @@
 #include "PhysicsEngine.h"
 #include "../Core/Math.h"
 #include "../Model/Object3D.h"
+#include "TriangleBVH.h"
 
 using std::sort;
 using std::swap;
 
 CPhysicsEngine::CPhysicsEngine()
 {
+	m_vCollisionScratches.resize(1);
 }
 
 CPhysicsEngine::~CPhysicsEngine()
@@ -20,10 +22,27 @@ void CPhysicsEngine::ClearData()
 	m_vEnvironmentObjects.clear();
 	m_mapEnvironmentObjects.clear();
 
+	m_EnvironmentTree.Clear();
+	m_umapEnvironmentProxyIDs.clear();
+	m_umapEnvironmentProxyAABBs.clear();
+	m_vDisturbedEnvironmentAABBs.clear();
+	m_bIsWholeEnvironmentDisturbed = false;
+
 	m_vMonsterObjects.clear();
 	m_mapMonsterObjects.clear();
 
+	m_Bodies.Clear();
+	m_vDynamicObjects.clear();
+	m_vContactCaches.clear();
+
+	m_vSweepEntries.clear();
+
+	m_HeightField.Clear();
+
 	m_WorldFloorHeight = KDefaultWorldFloorHeight;
+
+	m_TimeAccumulator = 0;
+	m_InterpolationAlpha = 1.0f;
 }
 
 void CPhysicsEngine::SetWorldFloorHeight(float WorldFloorHeight)
@@ -39,6 +58,65 @@ float CPhysicsEngine::GetWorldFloorHeight() const
 void CPhysicsEngine::SetGravity(const XMVECTOR& Gravity)
 {
 	m_Gravity = Gravity;
+
+	// @important: resting bodies depend on the gravity
+	m_Bodies.WakeUpAll();
+}
+
+void CPhysicsEngine::SetTerrain(const STERRData& TerrainData)
+{
+	m_HeightField.Build(TerrainData);
+
+	m_Bodies.WakeUpAll();
+}
+
+void CPhysicsEngine::ClearTerrain()
+{
+	m_HeightField.Clear();
+
+	m_Bodies.WakeUpAll();
+}
+
+bool CPhysicsEngine::HasTerrain() const
+{
+	return m_HeightField.IsBuilt();
+}
+
+const CHeightField& CPhysicsEngine::GetHeightField() const
+{
+	return m_HeightField;
+}
+
+void CPhysicsEngine::SetTickRate(float TicksPerSecond)
+{
+	if (TicksPerSecond <= 0) return;
+
+	m_FixedTimeStep = 1.0f / TicksPerSecond;
+}
+
+float CPhysicsEngine::GetTickRate() const
+{
+	return 1.0f / m_FixedTimeStep;
+}
+
+void CPhysicsEngine::SetMaxSubstepCount(uint32_t MaxSubstepCount)
+{
+	m_MaxSubstepCount = max(MaxSubstepCount, (uint32_t)1);
+}
+
+uint32_t CPhysicsEngine::GetMaxSubstepCount() const
+{
+	return m_MaxSubstepCount;
+}
+
+void CPhysicsEngine::ShouldInterpolateStates(bool Value)
+{
+	m_bShouldInterpolateStates = Value;
+}
+
+float CPhysicsEngine::GetInterpolationAlpha() const
+{
+	return m_InterpolationAlpha;
 }
 
 void CPhysicsEngine::RegisterObject(CObject3D* const Object3D, EObjectRole eObjectRole)
@@ -73,16 +151,10 @@ void CPhysicsEngine::RegisterPlayerObject(CObject3D* const Object3D)
 	if (!Object3D) return;
 
 	// invariant
-	if (m_mapEnvironmentObjects.find(Object3D) != m_mapEnvironmentObjects.end())
-	{
-		m_mapEnvironmentObjects.erase(Object3D);
-	}
+	DeregisterEnvironmentObject(Object3D);
 
 	// invariant
-	if (m_mapMonsterObjects.find(Object3D) != m_mapMonsterObjects.end())
-	{
-		m_mapMonsterObjects.erase(Object3D);
-	}
+	DeregisterMonsterObject(Object3D);
 
 	m_PlayerObject = Object3D;
 }
@@ -96,13 +168,12 @@ void CPhysicsEngine::RegisterEnvironmentObject(CObject3D* const Object3D)
 	if (m_mapEnvironmentObjects.find(Object3D) != m_mapEnvironmentObjects.end()) return;
 
 	// invariant
-	if (m_mapMonsterObjects.find(Object3D) != m_mapMonsterObjects.end())
-	{
-		m_mapMonsterObjects.erase(Object3D);
-	}
+	DeregisterMonsterObject(Object3D);
 
 	m_vEnvironmentObjects.emplace_back(Object3D);
 	m_mapEnvironmentObjects[Object3D] = 1;
+
+	CreateEnvironmentProxies(Object3D);
 }
 
 void CPhysicsEngine::RegisterMonsterObject(CObject3D* const Object3D)
@@ -114,10 +185,7 @@ void CPhysicsEngine::RegisterMonsterObject(CObject3D* const Object3D)
 	if (m_mapMonsterObjects.find(Object3D) != m_mapMonsterObjects.end()) return;
 
 	// invariant
-	if (m_mapEnvironmentObjects.find(Object3D) != m_mapEnvironmentObjects.end())
-	{
-		m_mapEnvironmentObjects.erase(Object3D);
-	}
+	DeregisterEnvironmentObject(Object3D);
 
 	m_vMonsterObjects.emplace_back(Object3D);
 	m_mapMonsterObjects[Object3D] = 1;
@@ -132,6 +200,9 @@ void CPhysicsEngine::DeregisterEnvironmentObject(CObject3D* const Object3D)
 {
 	if (m_mapEnvironmentObjects.find(Object3D) != m_mapEnvironmentObjects.end())
 	{
+		DestroyEnvironmentProxies(Object3D);
+		InvalidateContactCaches();
+
 		m_mapEnvironmentObjects.erase(Object3D);
 		size_t iObject{};
 		for (const auto& EnvironmentObject : m_vEnvironmentObjects)
@@ -197,48 +268,204 @@ CObject3D* CPhysicsEngine::GetPlayerObject() const
 
 void CPhysicsEngine::ShouldApplyGravity(bool Value)
 {
+	// @important: resting bodies depend on the gravity
+	if (m_bShouldApplyGravity != Value) m_Bodies.WakeUpAll();
+
 	m_bShouldApplyGravity = Value;
 }
 
-bool CPhysicsEngine::PickObject(const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection)
+void CPhysicsEngine::ShouldUseParallelUpdate(bool Value, size_t WorkerCount)
+{
+	m_bShouldUseParallelUpdate = Value;
+
+	if (m_bShouldUseParallelUpdate)
+	{
+		m_WorkerPool.Create(WorkerCount);
+	}
+	else
+	{
+		m_WorkerPool.Destroy();
+	}
+
+	m_vCollisionScratches.resize(m_WorkerPool.GetThreadCount());
+}
+
+void CPhysicsEngine::ShouldUseDeterministicUpdate(bool Value)
+{
+	m_bShouldUseDeterministicUpdate = Value;
+}
+
+void CPhysicsEngine::ShouldAllowSleeping(bool Value)
+{
+	m_bShouldAllowSleeping = Value;
+
+	if (!m_bShouldAllowSleeping) m_Bodies.WakeUpAll();
+}
+
+void CPhysicsEngine::SetSleepThreshold(float SleepLinearSpeed, uint32_t SleepTickCount)
 {
-	XMVECTOR TCmp{ KVectorGreatest };
-	bool bIntersected{ false };
+	m_SleepLinearSpeed = max(SleepLinearSpeed, 0.0f);
+	m_SleepTickCount = max(SleepTickCount, (uint32_t)1);
+}
+
+size_t CPhysicsEngine::GetAsleepBodyCount() const
+{
+	return m_Bodies.GetAsleepBodyCount();
+}
 
+void CPhysicsEngine::ShouldUseTriangleCollisions(bool Value)
+{
+	m_bShouldUseTriangleCollisions = Value;
+
+	InvalidateContactCaches();
+}
+
+bool CPhysicsEngine::PickObject(const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection)
+{
 	m_PickedPoint = KVectorZero;
 
-	for (const auto& EnvironmentObject : m_vEnvironmentObjects)
+	m_vPickingRays.clear();
+	m_vPickingRays.emplace_back(RayOrigin, RayDirection);
+	RayCast(m_vPickingRays, m_vPickingHits);
+
+	const SRayHit& Hit{ m_vPickingHits.front() };
+	if (!Hit.bHasHit) return false;
+
+	m_PickedObject = Hit.PtrObject3D;
+	m_PickedPoint = Hit.Point;
+	return true;
+}
+
+void CPhysicsEngine::RayCast(const std::vector<SRay>& vRays, std::vector<SRayHit>& vOutHits)
+{
+	vOutHits.clear();
+	vOutHits.resize(vRays.size());
+	if (vRays.empty()) return;
+
+	// @important: objects might have been moved since the last Update()
+	RefitEnvironmentTree();
+
+	// Counting sort by direction octants
+	uint32_t OctantOffsets[9]{};
+	for (const auto& Ray : vRays)
 	{
-		if (EnvironmentObject->IsInstanced())
+		++OctantOffsets[GetRayOctant(Ray.Direction) + 1];
+	}
+	for (uint32_t iOctant = 0; iOctant < 8; ++iOctant)
+	{
+		OctantOffsets[iOctant + 1] += OctantOffsets[iOctant];
+	}
+	uint32_t OctantCursors[8]{};
+	memcpy(OctantCursors, OctantOffsets, sizeof(OctantCursors));
+	m_vRayOrder.resize(vRays.size());
+	for (uint32_t iRay = 0; iRay < (uint32_t)vRays.size(); ++iRay)
+	{
+		m_vRayOrder[OctantCursors[GetRayOctant(vRays[iRay].Direction)]++] = iRay;
+	}
+
+	SRayPacket Packet{};
+	for (uint32_t iOctant = 0; iOctant < 8; ++iOctant)
+	{
+		for (uint32_t iFirst = OctantOffsets[iOctant]; iFirst < OctantOffsets[iOctant + 1]; iFirst += SRayPacket::KMaxRayCount)
 		{
-			for (const auto& Instance : EnvironmentObject->GetInstanceCPUDataVector())
+			Packet.RayCount = min(SRayPacket::KMaxRayCount, OctantOffsets[iOctant + 1] - iFirst);
+			for (uint32_t iRay = 0; iRay < Packet.RayCount; ++iRay)
 			{
-				if (DetectRayObjectIntersection(RayOrigin, RayDirection, Instance.Transform.Translation,
-					EnvironmentObject->GetOuterBoundingSphere(), EnvironmentObject->GetInnerBoundingVolumeVector(), TCmp))
-				{
-					bIntersected = true;
-					m_PickedObject = EnvironmentObject;
-					break;
-				}
+				const SRay& Ray{ vRays[m_vRayOrder[iFirst + iRay]] };
+				Packet.Origins[iRay] = Ray.Origin;
+				Packet.Directions[iRay] = Ray.Direction;
+				Packet.InverseDirections[iRay] = XMVectorReciprocal(Ray.Direction);
+			}
+			RayCastPacket(Packet, &m_vRayOrder[iFirst], vRays, vOutHits);
+		}
+	}
+}
+
+void CPhysicsEngine::RayCastPacket(const SRayPacket& Packet, const uint32_t* const RayIndices, const std::vector<SRay>& vRays,
+	std::vector<SRayHit>& vOutHits)
+{
+	float Ts[SRayPacket::KMaxRayCount]{};
+	for (uint32_t iRay = 0; iRay < Packet.RayCount; ++iRay)
+	{
+		Ts[iRay] = vRays[RayIndices[iRay]].MaxT;
+	}
+
+	m_vRayQueryResult.clear();
+	m_EnvironmentTree.QueryRayPacket(Packet, Ts, m_vRayQueryResult, m_vRayQueryStack);
+
+	SRayPacket ModelSpacePacket{};
+	for (const auto& ProxyRayMask : m_vRayQueryResult)
+	{
+		CObject3D* const Object3D{ (CObject3D*)m_EnvironmentTree.GetUserData(ProxyRayMask.first) };
+		size_t InstanceIndex{ m_EnvironmentTree.GetUserIndex(ProxyRayMask.first) };
+		uint32_t RayMask{ ProxyRayMask.second };
+		uint32_t HitMask{};
+
+		if (Object3D->GetInnerBoundingVolumeVector().empty() && CanUseTriangleCollisions(Object3D))
+		{
+			// @important: directions are not normalized, so that T is the same in both spaces
+			const XMMATRIX& WorldMatrix{ (Object3D->IsInstanced()) ? Object3D->GetInstanceWorldMatrix(InstanceIndex) : Object3D->GetWorldMatrix() };
+			const XMMATRIX InverseWorldMatrix{ XMMatrixInverse(nullptr, WorldMatrix) };
+			ModelSpacePacket.RayCount = Packet.RayCount;
+			for (uint32_t iRay = 0; iRay < Packet.RayCount; ++iRay)
+			{
+				if ((RayMask & (1u << iRay)) == 0) continue;
+
+				ModelSpacePacket.Origins[iRay] = XMVector3TransformCoord(Packet.Origins[iRay], InverseWorldMatrix);
+				ModelSpacePacket.Directions[iRay] = XMVector3TransformNormal(Packet.Directions[iRay], InverseWorldMatrix);
+				ModelSpacePacket.InverseDirections[iRay] = XMVectorReciprocal(ModelSpacePacket.Directions[iRay]);
+			}
+
+			for (size_t iMesh = 0; iMesh < Object3D->GetTriangleBVHCount(); ++iMesh)
+			{
+				HitMask |= Object3D->GetTriangleBVH(iMesh).RayCastPacket(ModelSpacePacket, RayMask, Ts, nullptr);
 			}
 		}
 		else
 		{
-			if (DetectRayObjectIntersection(RayOrigin, RayDirection, EnvironmentObject->GetTransform().Translation,
-				EnvironmentObject->GetOuterBoundingSphere(), EnvironmentObject->GetInnerBoundingVolumeVector(), TCmp))
+			const XMVECTOR& Translation{ (Object3D->IsInstanced()) ?
+				Object3D->GetInstanceCPUDataVector()[InstanceIndex].Transform.Translation : Object3D->GetTransform().Translation };
+			for (uint32_t iRay = 0; iRay < Packet.RayCount; ++iRay)
 			{
-				bIntersected = true;
-				m_PickedObject = EnvironmentObject;
+				if ((RayMask & (1u << iRay)) == 0) continue;
+
+				XMVECTOR T{ KVectorGreatest };
+				if (DetectRayObjectIntersection(Packet.Origins[iRay], Packet.Directions[iRay], Translation,
+					Object3D->GetOuterBoundingSphere(), Object3D->GetInnerBoundingVolumeVector(), T))
+				{
+					if (XMVectorGetX(T) < Ts[iRay])
+					{
+						Ts[iRay] = XMVectorGetX(T);
+						HitMask |= (1u << iRay);
+					}
+				}
 			}
 		}
+
+		for (uint32_t iRay = 0; iRay < Packet.RayCount; ++iRay)
+		{
+			if ((HitMask & (1u << iRay)) == 0) continue;
+
+			SRayHit& Hit{ vOutHits[RayIndices[iRay]] };
+			Hit.bHasHit = true;
+			Hit.PtrObject3D = Object3D;
+			Hit.InstanceIndex = InstanceIndex;
+		}
 	}
 
-	if (bIntersected)
+	for (uint32_t iRay = 0; iRay < Packet.RayCount; ++iRay)
 	{
-		m_PickedPoint = RayOrigin + RayDirection * TCmp;
+		SRayHit& Hit{ vOutHits[RayIndices[iRay]] };
+		if (!Hit.bHasHit) continue;
+
+		Hit.T = Ts[iRay];
+		Hit.Point = Packet.Origins[iRay] + Packet.Directions[iRay] * Ts[iRay];
 	}
+}
 
-	return bIntersected;
+uint32_t CPhysicsEngine::GetRayOctant(const XMVECTOR& RayDirection) const
+{
+	return ((XMVectorGetX(RayDirection) < 0) ? 1 : 0) | ((XMVectorGetY(RayDirection) < 0) ? 2 : 0) | ((XMVectorGetZ(RayDirection) < 0) ? 4 : 0);
 }
 
 bool CPhysicsEngine::DetectRayObjectIntersection(const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection,
@@ -304,136 +531,540 @@ CObject3D* CPhysicsEngine::GetPickedObject() const
 	return m_PickedObject;
 }
 
-void CPhysicsEngine::Update(float DeltaTime)
+void CPhysicsEngine::CreateEnvironmentProxies(CObject3D* const Object3D)
 {
-	if (DeltaTime <= 0) return;
+	auto& vProxyIDs{ m_umapEnvironmentProxyIDs[Object3D] };
+	auto& vProxyAABBs{ m_umapEnvironmentProxyAABBs[Object3D] };
+	vProxyIDs.clear();
+	vProxyAABBs.clear();
+
+	size_t ProxyCount{ (Object3D->IsInstanced()) ? Object3D->GetInstanceCount() : 1 };
+	vProxyIDs.reserve(ProxyCount);
+	vProxyAABBs.reserve(ProxyCount);
+	for (size_t iProxy = 0; iProxy < ProxyCount; ++iProxy)
+	{
+		vProxyAABBs.emplace_back(GetEnvironmentProxyAABB(Object3D, iProxy));
+		vProxyIDs.emplace_back(m_EnvironmentTree.CreateProxy(vProxyAABBs.back(), Object3D, iProxy));
+		AddDisturbedEnvironmentAABB(vProxyAABBs.back());
+	}
+}
 
-	UpdateObject(DeltaTime, m_PlayerObject);
+void CPhysicsEngine::DestroyEnvironmentProxies(CObject3D* const Object3D)
+{
+	if (m_umapEnvironmentProxyIDs.find(Object3D) == m_umapEnvironmentProxyIDs.end()) return;
 
-	for (auto& Monster : m_vMonsterObjects)
+	for (const auto& ProxyID : m_umapEnvironmentProxyIDs.at(Object3D))
 	{
-		UpdateObject(DeltaTime, Monster);
+		m_EnvironmentTree.DestroyProxy(ProxyID);
 	}
+	for (const auto& ProxyAABB : m_umapEnvironmentProxyAABBs.at(Object3D))
+	{
+		AddDisturbedEnvironmentAABB(ProxyAABB);
+	}
+	m_umapEnvironmentProxyIDs.erase(Object3D);
+	m_umapEnvironmentProxyAABBs.erase(Object3D);
+}
+
+void CPhysicsEngine::RefitEnvironmentTree()
+{
+	for (auto& EnvironmentObject : m_vEnvironmentObjects)
+	{
+		// @important: consumed before the rebuild check, so that moved instances don't pile up
+		bool bHaveAllInstancesMoved{ EnvironmentObject->ConsumeMovedInstanceIndices(m_vMovedInstanceIndices) };
+
+		const auto& vProxyIDs{ m_umapEnvironmentProxyIDs.at(EnvironmentObject) };
+		size_t ProxyCount{ (EnvironmentObject->IsInstanced()) ? EnvironmentObject->GetInstanceCount() : 1 };
+		if (vProxyIDs.size() != ProxyCount)
+		{
+			// Instances were inserted or deleted
+			DestroyEnvironmentProxies(EnvironmentObject);
+			CreateEnvironmentProxies(EnvironmentObject);
+			continue;
+		}
+
+		if (!EnvironmentObject->IsInstanced() || bHaveAllInstancesMoved)
+		{
+			for (size_t iProxy = 0; iProxy < ProxyCount; ++iProxy)
+			{
+				MoveEnvironmentProxy(EnvironmentObject, iProxy);
+			}
+		}
+		else
+		{
+			// Only the instances moved since the last refit
+			for (uint32_t InstanceIndex : m_vMovedInstanceIndices)
+			{
+				if (InstanceIndex >= ProxyCount) continue; // deleted
+
+				MoveEnvironmentProxy(EnvironmentObject, InstanceIndex);
+			}
+		}
+	}
+}
+
+void CPhysicsEngine::MoveEnvironmentProxy(CObject3D* const Object3D, size_t ProxyIndex)
+{
+	SAABB& LastAABB{ m_umapEnvironmentProxyAABBs.at(Object3D)[ProxyIndex] };
+	SAABB AABB{ GetEnvironmentProxyAABB(Object3D, ProxyIndex) };
+	if (XMVector3Equal(AABB.Min, LastAABB.Min) && XMVector3Equal(AABB.Max, LastAABB.Max)) return;
+
+	// @important: bodies resting on the volume are woken up even if the tree isn't touched
+	AddDisturbedEnvironmentAABB(SAABB(XMVectorMin(LastAABB.Min, AABB.Min), XMVectorMax(LastAABB.Max, AABB.Max)));
+	LastAABB = AABB;
+
+	// @important: MoveProxy() doesn't touch the tree unless the volume has left its fattened AABB
+	m_EnvironmentTree.MoveProxy(m_umapEnvironmentProxyIDs.at(Object3D)[ProxyIndex], AABB);
 }
 
-void CPhysicsEngine::UpdateObject(float DeltaTime, CObject3D* const Object)
+void CPhysicsEngine::AddDisturbedEnvironmentAABB(const SAABB& AABB)
 {
-	if (!Object) return;
+	if (m_bIsWholeEnvironmentDisturbed) return;
+	if (m_vDisturbedEnvironmentAABBs.size() >= KMaxDisturbedEnvironmentAABBCount)
+	{
+		// Too many to test every sleeping body against
+		m_bIsWholeEnvironmentDisturbed = true;
+		m_vDisturbedEnvironmentAABBs.clear();
+		return;
+	}
 
-	SObjectIdentifier Identifier{ Object };
-	if (Object->IsInstanced())
+	XMVECTOR Margin{ XMVectorReplicate(KDisturbedEnvironmentMargin) };
+	m_vDisturbedEnvironmentAABBs.emplace_back(AABB.Min - Margin, AABB.Max + Margin);
+}
+
+void CPhysicsEngine::WakeUpBodiesInDisturbedEnvironment()
+{
+	if (m_bIsWholeEnvironmentDisturbed)
 	{
-		for (const auto& Instance : Object->GetInstanceCPUDataVector())
+		m_Bodies.WakeUpAll();
+	}
+	else if (m_vDisturbedEnvironmentAABBs.size())
+	{
+		for (uint32_t iBody = 0; iBody < (uint32_t)m_Bodies.GetBodyCount(); ++iBody)
 		{
-			Identifier.InstanceName = Instance.Name;
+			if (!m_Bodies.IsAsleep(iBody)) continue;
+
+			const SBoundingVolume& BS{ m_Bodies.GetOuterBoundingSphere(iBody) };
+			SAABB BodyAABB{ CDynamicAABBTree::MakeSphereAABB(m_Bodies.GetPosition(iBody) + BS.Center, BS.Data.BS.Radius) };
+			for (const auto& DisturbedAABB : m_vDisturbedEnvironmentAABBs)
+			{
+				if (!CDynamicAABBTree::Overlaps(BodyAABB, DisturbedAABB)) continue;
 
-			_UpdateObject(Identifier, DeltaTime);
+				m_Bodies.WakeUp(iBody);
+				break;
+			}
 		}
+	}
+
+	m_vDisturbedEnvironmentAABBs.clear();
+	m_bIsWholeEnvironmentDisturbed = false;
+}
+
+SAABB CPhysicsEngine::GetEnvironmentProxyAABB(CObject3D* const Object3D, size_t InstanceIndex) const
+{
+	if (Object3D->IsInstanced())
+	{
+		const auto& InstanceCPUData{ Object3D->GetInstanceCPUDataVector()[InstanceIndex] };
+		return CDynamicAABBTree::MakeSphereAABB(InstanceCPUData.Transform.Translation + InstanceCPUData.EditorBoundingSphere.Center,
+			InstanceCPUData.EditorBoundingSphere.Data.BS.Radius);
+	}
+	return CDynamicAABBTree::MakeSphereAABB(Object3D->GetTransform().Translation + Object3D->GetOuterBoundingSphere().Center,
+		Object3D->GetOuterBoundingSphere().Data.BS.Radius);
+}
+
+void CPhysicsEngine::Update(float DeltaTime)
+{
+	if (DeltaTime <= 0) return;
+
+	RefitEnvironmentTree();
 
-		Object->UpdateAllInstances(); // @important
+	CollectDynamicObjects();
+	if (m_Bodies.SyncMembership(m_vDynamicObjects))
+	{
+		RebuildSweepEntries();
+		RebuildContactCaches();
+	}
+	m_Bodies.PullFromObjects();
+
+	// @important: after the membership sync, so that body indices are current
+	WakeUpBodiesInDisturbedEnvironment();
+
+	m_TimeAccumulator += DeltaTime;
+	uint32_t SubstepCount{};
+	while (m_TimeAccumulator >= m_FixedTimeStep && SubstepCount < m_MaxSubstepCount)
+	{
+		m_Bodies.SavePreviousPositions();
+
+		Step(m_FixedTimeStep);
+
+		m_TimeAccumulator -= m_FixedTimeStep;
+		++SubstepCount;
+	}
+	if (m_TimeAccumulator >= m_FixedTimeStep)
+	{
+		// @important: we can't catch up, so drop the time (otherwise it would snowball)
+		m_TimeAccumulator = fmod(m_TimeAccumulator, m_FixedTimeStep);
+	}
+	m_InterpolationAlpha = (m_bShouldInterpolateStates) ? m_TimeAccumulator / m_FixedTimeStep : 1.0f;
+
+	m_Bodies.PushToObjects(m_InterpolationAlpha);
+
+	// @important: objects whose bodies are all asleep (and untouched) don't need their instances updated
+	for (size_t iObject = 0; iObject < m_vDynamicObjects.size(); ++iObject)
+	{
+		CObject3D* const Object3D{ m_vDynamicObjects[iObject] };
+		if (Object3D->IsInstanced() && m_Bodies.IsObjectPushed(iObject)) Object3D->UpdateAllInstances();
+	}
+}
+
+void CPhysicsEngine::Step(float TimeStep)
+{
+	// Integration & environment collisions (bodies are independent of each other here)
+	for (auto& Scratch : m_vCollisionScratches)
+	{
+		Scratch.bHasProcessedBody = false;
+	}
+	m_StepDeltaTime = TimeStep;
+	size_t BodyCount{ m_Bodies.GetBodyCount() };
+	if (m_bShouldUseParallelUpdate && m_WorkerPool.IsCreated() && BodyCount >= KParallelUpdateMinBodyCount)
+	{
+		m_WorkerPool.ParallelFor(BodyCount, KParallelUpdateGrainSize, StepBodiesJob, this);
 	}
 	else
 	{
-		_UpdateObject(Identifier, DeltaTime);
+		StepBodies(0, (uint32_t)BodyCount, m_vCollisionScratches[0]);
 	}
+	MergeCollisionScratches();
+
+	if (m_HeightField.IsBuilt()) ResolveHeightFieldCollisions();
+
+	// @important: bodies affect each other from here on, so this stays serial
+	DetectResolveDynamicCollisions();
+
+	if (m_bShouldAllowSleeping) m_Bodies.UpdateSleepStates(m_SleepLinearSpeed, m_SleepTickCount);
 }
 
-void CPhysicsEngine::_UpdateObject(const SObjectIdentifier& Identifier, float DeltaTime)
+void CPhysicsEngine::CollectDynamicObjects()
 {
-	auto& Translation{ Identifier.Object3D->GetTransform(Identifier).Translation };
-	auto& LinearAcceleration{ Identifier.Object3D->GetPhysics(Identifier).LinearAcceleration };
-	auto& LinearVelocity{ Identifier.Object3D->GetPhysics(Identifier).LinearVelocity };
+	m_vDynamicObjects.clear();
+	if (m_PlayerObject) m_vDynamicObjects.emplace_back(m_PlayerObject);
+	m_vDynamicObjects.insert(m_vDynamicObjects.end(), m_vMonsterObjects.begin(), m_vMonsterObjects.end());
+}
 
-	if (m_bShouldApplyGravity)
+void CPhysicsEngine::StepBodies(uint32_t BodyBegin, uint32_t BodyEnd, SCollisionScratch& Scratch)
+{
+	m_Bodies.Integrate(BodyBegin, BodyEnd, m_StepDeltaTime, m_Gravity, m_bShouldApplyGravity, m_WorldFloorHeight);
+
+	for (uint32_t iBody = BodyBegin; iBody < BodyEnd; ++iBody)
 	{
-		Identifier.Object3D->AddLinearAcceleration(Identifier, m_Gravity); // Gravity
+		if (m_Bodies.IsAsleep(iBody) || m_Bodies.IsOnWorldFloor(iBody)) continue;
+
+		SweepEnvironmentCollisions(iBody, Scratch);
+		DetectResolveEnvironmentCollisions(iBody, Scratch);
 	}
+}
 
-	Identifier.Object3D->AddLinearVelocity(Identifier, LinearAcceleration * DeltaTime);
-	Identifier.Object3D->Translate(Identifier, LinearVelocity * DeltaTime);
-	Identifier.Object3D->SetLinearAcceleration(Identifier, KVectorZero);
+void CPhysicsEngine::StepBodiesJob(void* Context, size_t Begin, size_t End, size_t WorkerIndex)
+{
+	CPhysicsEngine* const PhysicsEngine{ static_cast<CPhysicsEngine*>(Context) };
+	PhysicsEngine->StepBodies((uint32_t)Begin, (uint32_t)End, PhysicsEngine->m_vCollisionScratches[WorkerIndex]);
+}
 
-	if (XMVectorGetY(Translation) < m_WorldFloorHeight)
+void CPhysicsEngine::ResolveHeightFieldCollisions()
+{
+	m_vHeightFieldBodies.clear();
+	m_vHeightFieldPositions.clear();
+	for (uint32_t iBody = 0; iBody < (uint32_t)m_Bodies.GetBodyCount(); ++iBody)
 	{
-		Identifier.Object3D->TranslateTo(Identifier, XMVectorSetY(Translation, m_WorldFloorHeight));
-		Identifier.Object3D->SetLinearVelocity(Identifier, XMVectorSetY(LinearVelocity, 0.0f));
+		if (m_Bodies.IsAsleep(iBody)) continue;
+
+		m_vHeightFieldBodies.emplace_back(iBody);
+		m_vHeightFieldPositions.emplace_back(m_Bodies.GetPosition(iBody));
 	}
-	else
+	m_vHeightFieldHeights.resize(m_vHeightFieldBodies.size());
+	m_vHeightFieldNormals.resize(m_vHeightFieldBodies.size());
+
+	m_HeightField.GetHeights(m_vHeightFieldPositions.data(), m_vHeightFieldPositions.size(),
+		m_vHeightFieldHeights.data(), m_vHeightFieldNormals.data());
+
+	for (size_t iItem = 0; iItem < m_vHeightFieldBodies.size(); ++iItem)
 	{
-		DetectResolveEnvironmentCollisions(Identifier);
+		float Height{ m_vHeightFieldHeights[iItem] };
+		uint32_t Body{ m_vHeightFieldBodies[iItem] };
+		XMVECTOR& Position{ m_Bodies.GetPosition(Body) };
+		if (XMVectorGetY(Position) >= Height) continue;
+
+		const XMVECTOR& Normal{ m_vHeightFieldNormals[iItem] };
+		XMVECTOR& LinearVelocity{ m_Bodies.GetLinearVelocity(Body) };
+		Position = XMVectorSetY(Position, Height);
+		if (XMVectorGetY(Normal) >= KWalkableNormalY)
+		{
+			// Same as the world floor
+			LinearVelocity = XMVectorSetY(LinearVelocity, 0.0f);
+		}
+		else
+		{
+			// Too steep, slide along the slope
+			float Speed{ XMVectorGetX(XMVector3Dot(LinearVelocity, Normal)) };
+			if (Speed < 0.0f) LinearVelocity -= Normal * Speed;
+		}
 	}
 }
 
-bool CPhysicsEngine::DetectResolveEnvironmentCollisions(const SObjectIdentifier& A_Identifier)
+void CPhysicsEngine::MergeCollisionScratches()
 {
-	bool bCollisionDetected{ false };
+	// @important: the serial path leaves the debugging output of the last processed body.
+	// Each thread claims ranges in ascending order, so LastProcessedBody of a scratch is its greatest body.
+	const SCollisionScratch* Merged{};
+	for (const auto& Scratch : m_vCollisionScratches)
+	{
+		if (!Scratch.bHasProcessedBody) continue;
+		if (!Merged || (m_bShouldUseDeterministicUpdate && Scratch.LastProcessedBody > Merged->LastProcessedBody))
+		{
+			Merged = &Scratch;
+		}
+	}
+	if (!Merged) return;
 
-	// Initialize data
-	m_DynamicClosestPoint = m_StaticClosestPoint = KVectorZero;
-	m_vCoarseCollisionList.clear();
+	m_DynamicClosestPoint = Merged->DynamicClosestPoint;
+	m_StaticClosestPoint = Merged->StaticClosestPoint;
+	m_CollisionNormal = Merged->CollisionNormal;
+	m_PenetrationDepth = Merged->PenetrationDepth;
+}
 
-	// @important: A is dynamic && B(Environment) is static
+bool CPhysicsEngine::SweepEnvironmentCollisions(uint32_t A_Body, SCollisionScratch& Scratch)
+{
+	const XMVECTOR& A_Start{ m_Bodies.GetPreviousPosition(A_Body) };
+	XMVECTOR& A_End{ m_Bodies.GetPosition(A_Body) };
+	XMVECTOR A_Displacement{ A_End - A_Start };
+	float A_DisplacementLength{ XMVectorGetX(XMVector3Length(A_Displacement)) };
+
+	// @important: inner volumes are swept by their inscribed spheres,
+	// so that the fine phase always sees an overlap after the body is stopped
+	const SBoundingVolume& A_OuterBS{ m_Bodies.GetOuterBoundingSphere(A_Body) };
+	const auto& A_vInnerBVs{ m_Bodies.GetInnerBoundingVolumes(A_Body) };
+	float A_MinRadius{ A_OuterBS.Data.BS.Radius };
+	for (const auto& A_BV : A_vInnerBVs)
+	{
+		A_MinRadius = min(A_MinRadius, GetSweptRadius(A_BV));
+	}
+	if (A_DisplacementLength <= A_MinRadius) return false;
+
+	// Broad phase (AABB of the swept outer bounding sphere)
+	XMVECTOR A_Center{ A_Start + A_OuterBS.Center };
+	SAABB A_StartAABB{ CDynamicAABBTree::MakeSphereAABB(A_Center, A_OuterBS.Data.BS.Radius) };
+	SAABB A_EndAABB{ CDynamicAABBTree::MakeSphereAABB(A_Center + A_Displacement, A_OuterBS.Data.BS.Radius) };
+	SAABB A_SweptAABB{ XMVectorMin(A_StartAABB.Min, A_EndAABB.Min), XMVectorMax(A_StartAABB.Max, A_EndAABB.Max) };
+
+	Scratch.vEnvironmentQueryResult.clear();
+	m_EnvironmentTree.Query(A_SweptAABB, Scratch.vEnvironmentQueryResult, Scratch.vEnvironmentQueryStack);
+
+	float TOI{ 1.0f };
+	XMVECTOR A_HitCenter{};
+	XMVECTOR B_HitCenter{};
+	const SBoundingVolume* B_HitBV{};
+	for (const auto& ProxyID : Scratch.vEnvironmentQueryResult)
 	{
-		for (auto& EnvironmentObject : m_vEnvironmentObjects)
+		CObject3D* const B{ static_cast<CObject3D*>(m_EnvironmentTree.GetUserData(ProxyID)) };
+		const XMVECTOR* B_Translation{ &B->GetTransform().Translation };
+		const SBoundingVolume* B_OuterBS{ &B->GetOuterBoundingSphere() };
+		if (B->IsInstanced())
 		{
-			CObject3D* const B{ EnvironmentObject };
-			SObjectIdentifier B_Identifier{ B };
-			if (B->IsInstanced())
+			const auto& B_InstanceCPUData{ B->GetInstanceCPUDataVector()[m_EnvironmentTree.GetUserIndex(ProxyID)] };
+			B_Translation = &B_InstanceCPUData.Transform.Translation;
+			B_OuterBS = &B_InstanceCPUData.EditorBoundingSphere;
+		}
+		const auto& B_vInnerBVs{ B->GetInnerBoundingVolumeVector() };
+
+		// @important: triangles are not swept, their outer bounding sphere is not a real surface
+		if (B_vInnerBVs.empty() && CanUseTriangleCollisions(B)) continue;
+
+		size_t A_VolumeCount{ max(A_vInnerBVs.size(), (size_t)1) };
+		size_t B_VolumeCount{ max(B_vInnerBVs.size(), (size_t)1) };
+		for (size_t iA = 0; iA < A_VolumeCount; ++iA)
+		{
+			const SBoundingVolume& A_BV{ (A_vInnerBVs.empty()) ? A_OuterBS : A_vInnerBVs[iA] };
+			XMVECTOR A_BV_Center{ A_Start + A_BV.Center };
+			float A_BV_Radius{ GetSweptRadius(A_BV) };
+			for (size_t iB = 0; iB < B_VolumeCount; ++iB)
 			{
-				for (const auto& InstanceCPUData : B->GetInstanceCPUDataVector())
+				const SBoundingVolume& B_BV{ (B_vInnerBVs.empty()) ? *B_OuterBS : B_vInnerBVs[iB] };
+				XMVECTOR B_BV_Center{ *B_Translation + B_BV.Center };
+				if (GetTimeOfImpact(A_BV_Center, A_BV_Radius, A_Displacement, B_BV_Center, B_BV, &TOI))
 				{
-					B_Identifier.InstanceName = InstanceCPUData.Name;
-					DetectEnvironmentCoarseCollision(A_Identifier, B_Identifier);
+					A_HitCenter = A_BV_Center;
+					B_HitCenter = B_BV_Center;
+					B_HitBV = &B_BV;
 				}
 			}
-			else
-			{
-				DetectEnvironmentCoarseCollision(A_Identifier, B_Identifier);
-			}
 		}
+	}
+
+	if (!B_HitBV) return false;
+
+	// Stop at the first contact (slightly inside of it, so that the fine phase resolves it)
+	float StopT{ min(TOI + KContinuousCollisionSkin / A_DisplacementLength, 1.0f) };
+
+	// ... and slide along the contact for the rest of the step
+	A_HitCenter += A_Displacement * TOI;
+	XMVECTOR B_ClosestPoint{ B_HitCenter };
+	if (B_HitBV->eType == EBoundingVolumeType::AxisAlignedBoundingBox)
+	{
+		B_ClosestPoint = GetClosestPointAABB(A_HitCenter,
+			B_HitCenter, B_HitBV->Data.AABBHalfSizes.x, B_HitBV->Data.AABBHalfSizes.y, B_HitBV->Data.AABBHalfSizes.z);
+	}
+	XMVECTOR N{ XMVector3Normalize(A_HitCenter - B_ClosestPoint) };
+	XMVECTOR Remainder{ A_Displacement * (1.0f - StopT) };
+	float RemainderDotN{ XMVectorGetX(XMVector3Dot(Remainder, N)) };
+	if (RemainderDotN < 0.0f) Remainder -= N * RemainderDotN;
+
+	A_End = A_Start + A_Displacement * StopT + Remainder;
+	return true;
+}
+
+float CPhysicsEngine::GetSweptRadius(const SBoundingVolume& BV) const
+{
+	if (BV.eType == EBoundingVolumeType::BoundingSphere) return BV.Data.BS.Radius;
+	return min(BV.Data.AABBHalfSizes.x, min(BV.Data.AABBHalfSizes.y, BV.Data.AABBHalfSizes.z));
+}
+
+bool CPhysicsEngine::GetTimeOfImpact(const XMVECTOR& A_Center, float A_Radius, const XMVECTOR& A_Displacement,
+	const XMVECTOR& B_Center, const SBoundingVolume& B_BV, float* const OutPtrTOI) const
+{
+	float TOI{};
+	bool bHit{};
+	if (B_BV.eType == EBoundingVolumeType::BoundingSphere)
+	{
+		bHit = SweepSphereSphere(A_Center, A_Radius, A_Displacement, B_Center, B_BV.Data.BS.Radius, &TOI);
+	}
+	else
+	{
+		bHit = SweepSphereAABB(A_Center, A_Radius, A_Displacement,
+			B_Center, B_BV.Data.AABBHalfSizes.x, B_BV.Data.AABBHalfSizes.y, B_BV.Data.AABBHalfSizes.z, &TOI);
+	}
+
+	// @important: pairs that already overlap are left to the fine phase, and only the earliest hit is kept
+	if (!bHit || TOI <= 0.0f || TOI >= *OutPtrTOI) return false;
+
+	*OutPtrTOI = TOI;
+	return true;
+}
+
+bool CPhysicsEngine::DetectResolveEnvironmentCollisions(uint32_t A_Body, SCollisionScratch& Scratch)
+{
+	bool bCollisionDetected{ false };
+
+	// Initialize data
+	Scratch.DynamicClosestPoint = Scratch.StaticClosestPoint = KVectorZero;
+	Scratch.vCoarseCollisionList.clear();
+	Scratch.bHasProcessedBody = true;
+	Scratch.LastProcessedBody = A_Body;
+
+	SContactCache& ContactCache{ m_vContactCaches[A_Body] };
+	ContactCache.vNextContacts.clear();
+	ContactCache.ContactCursor = 0;
+
+	// @important: A is dynamic && B(Environment) is static
+	{
+		// Broad phase (environment AABB tree)
+		const SBoundingVolume& A_BS{ m_Bodies.GetOuterBoundingSphere(A_Body) };
+		XMVECTOR A_Center{ m_Bodies.GetPosition(A_Body) + A_BS.Center };
+
+		Scratch.vEnvironmentQueryResult.clear();
+		m_EnvironmentTree.Query(CDynamicAABBTree::MakeSphereAABB(A_Center, A_BS.Data.BS.Radius),
+			Scratch.vEnvironmentQueryResult, Scratch.vEnvironmentQueryStack);
+
+		// Coarse phase (sphere-sphere)
+		DetectEnvironmentCoarseCollisions(A_Body, Scratch);
 		
 		// Time to fine collision
-		sort(m_vCoarseCollisionList.begin(), m_vCoarseCollisionList.end(), std::less<SCollisionItem>());
-		for (const auto& CoarseCollision : m_vCoarseCollisionList)
+		for (const auto& CoarseCollision : SortCoarseCollisions(A_Body, Scratch))
 		{
-			if (DetectResolveFineCollision(CoarseCollision))
+			if (DetectResolveFineCollision(CoarseCollision, Scratch))
 			{
 				bCollisionDetected = true;
 			}
 		}
 	}
 
+	// @important: contacts that didn't occur in this tick are dropped
+	swap(ContactCache.vContacts, ContactCache.vNextContacts);
+
 	return bCollisionDetected;
 }
 
-bool CPhysicsEngine::DetectEnvironmentCoarseCollision(const SObjectIdentifier& A, const SObjectIdentifier& B)
+void CPhysicsEngine::DetectEnvironmentCoarseCollisions(uint32_t A_Body, SCollisionScratch& Scratch)
 {
-	const XMVECTOR* A_Translation{ &A.Object3D->GetTransform(A).Translation };
-	const SBoundingVolume* A_BS{ &A.Object3D->GetOuterBoundingSphere(A) };
-	const XMVECTOR* B_Translation{ &B.Object3D->GetTransform(B).Translation };
-	const SBoundingVolume* B_BS{ &B.Object3D->GetOuterBoundingSphere(B) };
-	
-	// Coarse collision (sphere-sphere)
-	XMVECTOR _A_T{ *A_Translation + A_BS->Center };
-	XMVECTOR _B_T{ *B_Translation + B_BS->Center };
-
-	if (DetectIntersection(_A_T, *A_BS, _B_T, *B_BS))
-	{
-		XMVECTOR Diff{ _B_T - _A_T };
-		m_vCoarseCollisionList.emplace_back();
-		m_vCoarseCollisionList.back().A = A;
-		m_vCoarseCollisionList.back().A_Translation = A_Translation;
-		m_vCoarseCollisionList.back().A_BS = A_BS;
-		m_vCoarseCollisionList.back().B = B;
-		m_vCoarseCollisionList.back().B_Translation = B_Translation;
-		m_vCoarseCollisionList.back().B_BS = B_BS;
-		m_vCoarseCollisionList.back().DistanceSquare = XMVectorGetX(XMVector3LengthSq(Diff));
-		return true;
+	const SBoundingVolume& A_BS{ m_Bodies.GetOuterBoundingSphere(A_Body) };
+	XMVECTOR A_Center{ m_Bodies.GetPosition(A_Body) + A_BS.Center };
+
+	const auto& vProxyIDs{ Scratch.vEnvironmentQueryResult };
+	for (size_t iFirst = 0; iFirst < vProxyIDs.size(); iFirst += SSpherePack4::KLaneCount)
+	{
+		uint32_t LaneCount{ (uint32_t)min(vProxyIDs.size() - iFirst, (size_t)SSpherePack4::KLaneCount) };
+
+		SSpherePack4 B_Pack{};
+		for (uint32_t iLane = 0; iLane < LaneCount; ++iLane)
+		{
+			int32_t ProxyID{ vProxyIDs[iFirst + iLane] };
+			const XMVECTOR* B_Translation{};
+			const SBoundingVolume* B_BS{};
+			GetEnvironmentBoundingSphere(static_cast<CObject3D*>(m_EnvironmentTree.GetUserData(ProxyID)), m_EnvironmentTree.GetUserIndex(ProxyID),
+				B_Translation, B_BS);
+			SetSpherePackLane(B_Pack, iLane, *B_Translation + B_BS->Center, B_BS->Data.BS.Radius);
+		}
+
+		uint32_t HitMask{ IntersectSphereSpheres4(A_Center, A_BS.Data.BS.Radius, B_Pack) & GetLaneMask(LaneCount) };
+		for (uint32_t iLane = 0; iLane < LaneCount; ++iLane)
+		{
+			if ((HitMask & (1u << iLane)) == 0) continue;
+
+			int32_t ProxyID{ vProxyIDs[iFirst + iLane] };
+			AddEnvironmentCoarseCollision(A_Body, static_cast<CObject3D*>(m_EnvironmentTree.GetUserData(ProxyID)),
+				m_EnvironmentTree.GetUserIndex(ProxyID), Scratch);
+		}
+	}
+}
+
+void CPhysicsEngine::AddEnvironmentCoarseCollision(uint32_t A_Body, CObject3D* const B_Object3D, size_t B_InstanceIndex,
+	SCollisionScratch& Scratch)
+{
+	const XMVECTOR* A_Translation{ &m_Bodies.GetPosition(A_Body) };
+	const SBoundingVolume* A_BS{ &m_Bodies.GetOuterBoundingSphere(A_Body) };
+	const XMVECTOR* B_Translation{};
+	const SBoundingVolume* B_BS{};
+	GetEnvironmentBoundingSphere(B_Object3D, B_InstanceIndex, B_Translation, B_BS);
+
+	XMVECTOR Diff{ (*B_Translation + B_BS->Center) - (*A_Translation + A_BS->Center) };
+	auto& vCoarseCollisionList{ Scratch.vCoarseCollisionList };
+	vCoarseCollisionList.emplace_back();
+	vCoarseCollisionList.back().A_Body = A_Body;
+	vCoarseCollisionList.back().A_Translation = A_Translation;
+	vCoarseCollisionList.back().A_BS = A_BS;
+	vCoarseCollisionList.back().B_Object3D = B_Object3D;
+	vCoarseCollisionList.back().B_InstanceIndex = B_InstanceIndex;
+	vCoarseCollisionList.back().B_Translation = B_Translation;
+	vCoarseCollisionList.back().B_BS = B_BS;
+	vCoarseCollisionList.back().DistanceSquare = XMVectorGetX(XMVector3LengthSq(Diff));
+	vCoarseCollisionList.back().CoarseIndex = (uint32_t)(vCoarseCollisionList.size() - 1);
+}
+
+void CPhysicsEngine::GetEnvironmentBoundingSphere(CObject3D* const Object3D, size_t InstanceIndex,
+	const XMVECTOR*& OutPtrTranslation, const SBoundingVolume*& OutPtrBS) const
+{
+	if (Object3D->IsInstanced())
+	{
+		const auto& InstanceCPUData{ Object3D->GetInstanceCPUDataVector()[InstanceIndex] };
+		OutPtrTranslation = &InstanceCPUData.Transform.Translation;
+		OutPtrBS = &InstanceCPUData.EditorBoundingSphere;
+	}
+	else
+	{
+		OutPtrTranslation = &Object3D->GetTransform().Translation;
+		OutPtrBS = &Object3D->GetOuterBoundingSphere();
 	}
-	return false;
 }
 
-bool CPhysicsEngine::DetectResolveFineCollision(const SCollisionItem& Coarse)
+bool CPhysicsEngine::DetectResolveFineCollision(const SCollisionItem& Coarse, SCollisionScratch& Scratch)
 {
 	bool bCollided{ false };
 	
@@ -442,8 +1073,13 @@ bool CPhysicsEngine::DetectResolveFineCollision(const SCollisionItem& Coarse)
 	const SBoundingVolume& A_OuterBS{ *Coarse.A_BS };
 	const SBoundingVolume& B_OuterBS{ *Coarse.B_BS };
 
-	const auto& A_vInnerBVs{ Coarse.A.Object3D->GetInnerBoundingVolumeVector() };
-	const auto& B_vInnerBVs{ Coarse.B.Object3D->GetInnerBoundingVolumeVector() };
+	const auto& A_vInnerBVs{ m_Bodies.GetInnerBoundingVolumes(Coarse.A_Body) };
+	const auto& B_vInnerBVs{ Coarse.B_Object3D->GetInnerBoundingVolumeVector() };
+
+	if (B_vInnerBVs.empty() && CanUseTriangleCollisions(Coarse.B_Object3D))
+	{
+		return DetectResolveTriangleCollisions(Coarse, Scratch);
+	}
 
 	XMVECTOR _A_T{ A_Translation + Coarse.A_BS->Center };
 	XMVECTOR _B_T{ B_Translation + Coarse.B_BS->Center };
@@ -454,9 +1090,7 @@ bool CPhysicsEngine::DetectResolveFineCollision(const SCollisionItem& Coarse)
 		{
 			if (DetectIntersection(_A_T, A_OuterBS, _B_T, B_OuterBS))
 			{
-				GetClosestPoints(_A_T, A_OuterBS, _B_T, B_OuterBS);
-
-				ResolvePenetration(Coarse);
+				ResolveContact(Coarse, _A_T, _B_T, Scratch);
 
 				bCollided = true;
 			}
@@ -469,11 +1103,9 @@ bool CPhysicsEngine::DetectResolveFineCollision(const SCollisionItem& Coarse)
 				
 				if (DetectIntersection(_A_T, A_BV_Item, _B_T, B_OuterBS))
 				{
-					GetClosestPoints(_A_T, A_BV_Item, _B_T, B_OuterBS);
-
 					SCollisionItem Fine{ Coarse };
 					Fine.A_BS = &A_BV_Item;
-					ResolvePenetration(Fine);
+					ResolveContact(Fine, _A_T, _B_T, Scratch);
 
 					bCollided = true;
 				}
@@ -490,11 +1122,9 @@ bool CPhysicsEngine::DetectResolveFineCollision(const SCollisionItem& Coarse)
 
 				if (DetectIntersection(_A_T, A_OuterBS, _B_T, B_BV_Item))
 				{
-					GetClosestPoints(_A_T, A_OuterBS, _B_T, B_BV_Item);
-
 					SCollisionItem Fine{ Coarse };
 					Fine.B_BS = &B_BV_Item;
-					ResolvePenetration(Fine);
+					ResolveContact(Fine, _A_T, _B_T, Scratch);
 
 					bCollided = true;
 				}
@@ -512,12 +1142,10 @@ bool CPhysicsEngine::DetectResolveFineCollision(const SCollisionItem& Coarse)
 					
 					if (DetectIntersection(_A_T, A_BV_Item, _B_T, B_BV_Item))
 					{
-						GetClosestPoints(_A_T, A_BV_Item, _B_T, B_BV_Item);
-
 						SCollisionItem Fine{ Coarse };
 						Fine.A_BS = &A_BV_Item;
 						Fine.B_BS = &B_BV_Item;
-						ResolvePenetration(Fine);
+						ResolveContact(Fine, _A_T, _B_T, Scratch);
 
 						bCollided = true;
 					}
@@ -529,6 +1157,384 @@ bool CPhysicsEngine::DetectResolveFineCollision(const SCollisionItem& Coarse)
 	return bCollided;
 }
 
+bool CPhysicsEngine::CanUseTriangleCollisions(const CObject3D* const B_Object3D) const
+{
+	return (m_bShouldUseTriangleCollisions && B_Object3D->HasTriangleBVHs());
+}
+
+bool CPhysicsEngine::DetectResolveTriangleCollisions(const SCollisionItem& Coarse, SCollisionScratch& Scratch)
+{
+	bool bCollided{ false };
+
+	CObject3D* const B{ Coarse.B_Object3D };
+	const XMVECTOR& B_Scaling{ (B->IsInstanced()) ?
+		B->GetInstanceCPUDataVector()[Coarse.B_InstanceIndex].Transform.Scaling : B->GetTransform().Scaling };
+
+	// @important: mirrored (negative) scaling is fine, but a degenerate (zero) scaling has neither an inverse nor a volume to collide with
+	float B_MinScaling{ min(abs(XMVectorGetX(B_Scaling)), min(abs(XMVectorGetY(B_Scaling)), abs(XMVectorGetZ(B_Scaling)))) };
+	if (B_MinScaling <= FLT_EPSILON) return false;
+
+	const XMMATRIX& B_WorldMatrix{ (B->IsInstanced()) ? B->GetInstanceWorldMatrix(Coarse.B_InstanceIndex) : B->GetWorldMatrix() };
+	const XMMATRIX B_InverseWorldMatrix{ XMMatrixInverse(nullptr, B_WorldMatrix) };
+
+	XMVECTOR& A_Translation{ m_Bodies.GetPosition(Coarse.A_Body) };
+	XMVECTOR& A_LinearVelocity{ m_Bodies.GetLinearVelocity(Coarse.A_Body) };
+	const auto& A_vInnerBVs{ m_Bodies.GetInnerBoundingVolumes(Coarse.A_Body) };
+	size_t A_VolumeCount{ max(A_vInnerBVs.size(), (size_t)1) };
+	for (size_t iA = 0; iA < A_VolumeCount; ++iA)
+	{
+		const SBoundingVolume& A_BV{ (A_vInnerBVs.empty()) ? *Coarse.A_BS : A_vInnerBVs[iA] };
+		float A_Radius{ GetSweptRadius(A_BV) };
+
+		for (size_t iMesh = 0; iMesh < B->GetTriangleBVHCount(); ++iMesh)
+		{
+			// Broad phase in model space (the radius is conservative under non-uniform scaling)
+			const CTriangleBVH& BVH{ B->GetTriangleBVH(iMesh) };
+			XMVECTOR A_ModelCenter{ XMVector3TransformCoord(A_Translation + A_BV.Center, B_InverseWorldMatrix) };
+			Scratch.vTriangleQueryResult.clear();
+			BVH.QuerySphere(A_ModelCenter, A_Radius / B_MinScaling, Scratch.vTriangleQueryResult);
+
+			// Fine phase in world space (candidates only)
+			for (const auto& TriangleIndex : Scratch.vTriangleQueryResult)
+			{
+				XMVECTOR V0{}, V1{}, V2{};
+				BVH.GetTriangle(TriangleIndex, V0, V1, V2);
+				V0 = XMVector3TransformCoord(V0, B_WorldMatrix);
+				V1 = XMVector3TransformCoord(V1, B_WorldMatrix);
+				V2 = XMVector3TransformCoord(V2, B_WorldMatrix);
+
+				XMVECTOR A_Center{ A_Translation + A_BV.Center };
+				XMVECTOR ClosestPoint{ GetClosestPointTriangle(A_Center, V0, V1, V2) };
+				XMVECTOR Diff{ A_Center - ClosestPoint };
+				float DistanceSquare{ XMVectorGetX(XMVector3LengthSq(Diff)) };
+				if (DistanceSquare >= A_Radius * A_Radius) continue;
+
+				float Distance{ sqrt(DistanceSquare) };
+				XMVECTOR N{ (Distance > FLT_EPSILON) ? Diff / Distance : CalculateTriangleNormal(V0, V1, V2) };
+
+				Scratch.StaticClosestPoint = ClosestPoint;
+				Scratch.DynamicClosestPoint = A_Center - N * A_Radius;
+				Scratch.PenetrationDepth = A_Radius - Distance;
+				Scratch.CollisionNormal = N;
+
+				if (XMVectorGetY(N) >= KWalkableNormalY)
+				{
+					// @important
+					A_LinearVelocity = XMVectorSetY(A_LinearVelocity, -0.01f);
+				}
+				A_Translation += N * Scratch.PenetrationDepth;
+
+				bCollided = true;
+			}
+		}
+	}
+
+	return bCollided;
+}
+
+const std::vector<SCollisionItem>& CPhysicsEngine::SortCoarseCollisions(uint32_t A_Body, SCollisionScratch& Scratch)
+{
+	SContactCache& ContactCache{ m_vContactCaches[A_Body] };
+	auto& vCoarseCollisionList{ Scratch.vCoarseCollisionList };
+
+	bool bIsSameMembership{ ContactCache.vCoarseKeys.size() == vCoarseCollisionList.size() };
+	for (size_t iCoarse = 0; bIsSameMembership && iCoarse < vCoarseCollisionList.size(); ++iCoarse)
+	{
+		if (ContactCache.vCoarseKeys[iCoarse].first != vCoarseCollisionList[iCoarse].B_Object3D ||
+			ContactCache.vCoarseKeys[iCoarse].second != vCoarseCollisionList[iCoarse].B_InstanceIndex)
+		{
+			bIsSameMembership = false;
+		}
+	}
+
+	const std::vector<SCollisionItem>* Sorted{ &vCoarseCollisionList };
+	if (bIsSameMembership)
+	{
+		// @important: start from the last order, so that insertion sort is linear as long as the order still holds
+		auto& vSortedCoarseCollisionList{ Scratch.vSortedCoarseCollisionList };
+		vSortedCoarseCollisionList.clear();
+		for (const auto& iCoarse : ContactCache.vCoarseOrder)
+		{
+			vSortedCoarseCollisionList.emplace_back(vCoarseCollisionList[iCoarse]);
+		}
+		for (size_t i = 1; i < vSortedCoarseCollisionList.size(); ++i)
+		{
+			SCollisionItem Item{ vSortedCoarseCollisionList[i] };
+			size_t j{ i };
+			while (j > 0 && Item < vSortedCoarseCollisionList[j - 1])
+			{
+				vSortedCoarseCollisionList[j] = vSortedCoarseCollisionList[j - 1];
+				--j;
+			}
+			vSortedCoarseCollisionList[j] = Item;
+		}
+		Sorted = &vSortedCoarseCollisionList;
+	}
+	else
+	{
+		sort(vCoarseCollisionList.begin(), vCoarseCollisionList.end(), std::less<SCollisionItem>());
+
+		ContactCache.vCoarseKeys.resize(vCoarseCollisionList.size());
+		for (const auto& CoarseCollision : vCoarseCollisionList)
+		{
+			ContactCache.vCoarseKeys[CoarseCollision.CoarseIndex] = { CoarseCollision.B_Object3D, CoarseCollision.B_InstanceIndex };
+		}
+	}
+
+	ContactCache.vCoarseOrder.resize(Sorted->size());
+	for (size_t iSorted = 0; iSorted < Sorted->size(); ++iSorted)
+	{
+		ContactCache.vCoarseOrder[iSorted] = (*Sorted)[iSorted].CoarseIndex;
+	}
+	return *Sorted;
+}
+
+void CPhysicsEngine::ResolveContact(const SCollisionItem& Fine, const XMVECTOR& A_Center, const XMVECTOR& B_Center,
+	SCollisionScratch& Scratch)
+{
+	SContactCache& ContactCache{ m_vContactCaches[Fine.A_Body] };
+	XMVECTOR& A_Translation{ m_Bodies.GetPosition(Fine.A_Body) };
+	XMVECTOR& A_LinearVelocity{ m_Bodies.GetLinearVelocity(Fine.A_Body) };
+
+	// @important: the cached contact is kept as is (not the warm-started one), so the error can't accumulate over ticks
+	const SContact* const LastContact{ FindContact(ContactCache, Fine) };
+	if (LastContact && WarmStartContact(*LastContact, Fine, Scratch))
+	{
+		ContactCache.vNextContacts.emplace_back(*LastContact);
+		return;
+	}
+
+	SContact Contact{};
+	Contact.B_Object3D = Fine.B_Object3D;
+	Contact.B_InstanceIndex = Fine.B_InstanceIndex;
+	Contact.A_BVPtr = Fine.A_BS;
+	Contact.B_BVPtr = Fine.B_BS;
+	Contact.A_BV = *Fine.A_BS;
+	Contact.B_BV = *Fine.B_BS;
+	Contact.A_Translation = A_Translation;
+	Contact.B_Translation = *Fine.B_Translation;
+	Contact.A_LinearVelocity = A_LinearVelocity;
+
+	GetClosestPoints(A_Center, *Fine.A_BS, B_Center, *Fine.B_BS, Scratch);
+
+	Scratch.CollisionNormal = KVectorZero;
+	Scratch.PenetrationDepth = 0;
+	ResolvePenetration(Fine, Scratch);
+
+	Contact.DynamicClosestPoint = Scratch.DynamicClosestPoint;
+	Contact.StaticClosestPoint = Scratch.StaticClosestPoint;
+	Contact.CollisionNormal = Scratch.CollisionNormal;
+	Contact.PenetrationDepth = Scratch.PenetrationDepth;
+	Contact.bHasClampedLinearVelocity = !XMVector4Equal(A_LinearVelocity, Contact.A_LinearVelocity);
+	ContactCache.vNextContacts.emplace_back(Contact);
+}
+
+bool CPhysicsEngine::WarmStartContact(const SContact& LastContact, const SCollisionItem& Fine, SCollisionScratch& Scratch)
+{
+	// A contact that hasn't been resolved has no normal to start from
+	if (LastContact.PenetrationDepth <= 0) return false;
+	if (!IsSameBoundingVolume(LastContact.A_BV, *Fine.A_BS) || !IsSameBoundingVolume(LastContact.B_BV, *Fine.B_BS)) return false;
+
+	XMVECTOR& A_Translation{ m_Bodies.GetPosition(Fine.A_Body) };
+	XMVECTOR& A_LinearVelocity{ m_Bodies.GetLinearVelocity(Fine.A_Body) };
+
+	// The pair must not have moved relative to each other further than the tolerance
+	XMVECTOR A_Delta{ A_Translation - LastContact.A_Translation };
+	XMVECTOR B_Delta{ *Fine.B_Translation - LastContact.B_Translation };
+	XMVECTOR RelativeDelta{ A_Delta - B_Delta };
+	if (XMVectorGetX(XMVector3LengthSq(RelativeDelta)) > KContactWarmStartDistance * KContactWarmStartDistance) return false;
+
+	// Some normals are computed from the moving direction, so it must not have turned either
+	XMVECTOR LastMovingDir{ XMVector3Normalize(LastContact.A_LinearVelocity) };
+	XMVECTOR MovingDir{ XMVector3Normalize(A_LinearVelocity) };
+	if (!XMVector3Equal(LastMovingDir, MovingDir) &&
+		XMVectorGetX(XMVector3Dot(LastMovingDir, MovingDir)) < KContactWarmStartCosine) return false;
+
+	// Validate the cached normal against the new relative position: A must still be on the same side of B
+	const XMVECTOR& N{ LastContact.CollisionNormal };
+	XMVECTOR LastBToA{ (LastContact.A_Translation + LastContact.A_BV.Center) - (LastContact.B_Translation + LastContact.B_BV.Center) };
+	XMVECTOR BToA{ LastBToA + RelativeDelta };
+	if (XMVectorGetX(XMVector3Dot(LastBToA, N)) * XMVectorGetX(XMVector3Dot(BToA, N)) < 0) return false;
+
+	// Refine the depth along the cached normal
+	float PenetrationDepth{ LastContact.PenetrationDepth - XMVectorGetX(XMVector3Dot(RelativeDelta, N)) };
+	if (PenetrationDepth <= 0) return false;
+
+	Scratch.DynamicClosestPoint = LastContact.DynamicClosestPoint + A_Delta;
+	Scratch.StaticClosestPoint = LastContact.StaticClosestPoint + B_Delta;
+	Scratch.CollisionNormal = N;
+	Scratch.PenetrationDepth = PenetrationDepth;
+
+	if (LastContact.bHasClampedLinearVelocity)
+	{
+		// @important
+		A_LinearVelocity = XMVectorSetY(A_LinearVelocity, -0.01f);
+	}
+	A_Translation += N * PenetrationDepth;
+	return true;
+}
+
+SContact* CPhysicsEngine::FindContact(SContactCache& ContactCache, const SCollisionItem& Fine)
+{
+	size_t ContactCount{ ContactCache.vContacts.size() };
+	for (size_t i = 0; i < ContactCount; ++i)
+	{
+		size_t iContact{ (ContactCache.ContactCursor + i) % ContactCount };
+		SContact& Contact{ ContactCache.vContacts[iContact] };
+		if (Contact.B_Object3D == Fine.B_Object3D && Contact.B_InstanceIndex == Fine.B_InstanceIndex &&
+			Contact.A_BVPtr == Fine.A_BS && Contact.B_BVPtr == Fine.B_BS)
+		{
+			ContactCache.ContactCursor = iContact + 1;
+			return &Contact;
+		}
+	}
+	return nullptr;
+}
+
+bool CPhysicsEngine::IsSameBoundingVolume(const SBoundingVolume& A, const SBoundingVolume& B) const
+{
+	if (A.eType != B.eType) return false;
+	if (!XMVector4Equal(A.Center, B.Center)) return false;
+	if (A.eType == EBoundingVolumeType::BoundingSphere) return (A.Data.BS.Radius == B.Data.BS.Radius);
+	return (A.Data.AABBHalfSizes.x == B.Data.AABBHalfSizes.x &&
+		A.Data.AABBHalfSizes.y == B.Data.AABBHalfSizes.y &&
+		A.Data.AABBHalfSizes.z == B.Data.AABBHalfSizes.z);
+}
+
+void CPhysicsEngine::RebuildContactCaches()
+{
+	m_vContactCaches.clear();
+	m_vContactCaches.resize(m_Bodies.GetBodyCount());
+}
+
+void CPhysicsEngine::InvalidateContactCaches()
+{
+	for (auto& ContactCache : m_vContactCaches)
+	{
+		ContactCache.vContacts.clear();
+		ContactCache.vCoarseKeys.clear();
+		ContactCache.vCoarseOrder.clear();
+	}
+}
+
+void CPhysicsEngine::DetectResolveDynamicCollisions()
+{
+	UpdateSweepEntries();
+
+	// Incremental insertion sort (bodies barely move between ticks, so this is nearly linear)
+	for (size_t i = 1; i < m_vSweepEntries.size(); ++i)
+	{
+		SSweepEntry Entry{ m_vSweepEntries[i] };
+		size_t j{ i };
+		while (j > 0 && m_vSweepEntries[j - 1].MinX > Entry.MinX)
+		{
+			m_vSweepEntries[j] = m_vSweepEntries[j - 1];
+			--j;
+		}
+		m_vSweepEntries[j] = Entry;
+	}
+
+	// Sweep
+	m_vPushedBodies.clear();
+	for (size_t i = 0; i < m_vSweepEntries.size(); ++i)
+	{
+		const SSweepEntry& A{ m_vSweepEntries[i] };
+		for (size_t j = i + 1; j < m_vSweepEntries.size(); ++j)
+		{
+			const SSweepEntry& B{ m_vSweepEntries[j] };
+			if (B.MinX > A.MaxX) break;
+
+			if (DetectResolveDynamicPair(A.Body, B.Body))
+			{
+				m_vPushedBodies.emplace_back(A.Body);
+				m_vPushedBodies.emplace_back(B.Body);
+			}
+		}
+	}
+
+	// @important: a push may have moved a body into the environment, so the pushed bodies are resolved against it again
+	sort(m_vPushedBodies.begin(), m_vPushedBodies.end());
+	m_vPushedBodies.erase(std::unique(m_vPushedBodies.begin(), m_vPushedBodies.end()), m_vPushedBodies.end());
+	for (uint32_t iBody : m_vPushedBodies)
+	{
+		if (m_Bodies.IsOnWorldFloor(iBody)) continue;
+
+		DetectResolveEnvironmentCollisions(iBody, m_vCollisionScratches[0]);
+	}
+}
+
+void CPhysicsEngine::RebuildSweepEntries()
+{
+	m_vSweepEntries.clear();
+	m_vSweepEntries.resize(m_Bodies.GetBodyCount());
+	for (uint32_t iBody = 0; iBody < (uint32_t)m_vSweepEntries.size(); ++iBody)
+	{
+		m_vSweepEntries[iBody].Body = iBody;
+	}
+}
+
+void CPhysicsEngine::UpdateSweepEntries()
+{
+	for (auto& Entry : m_vSweepEntries)
+	{
+		const SBoundingVolume& BS{ m_Bodies.GetOuterBoundingSphere(Entry.Body) };
+		float CenterX{ XMVectorGetX(m_Bodies.GetPosition(Entry.Body) + BS.Center) };
+		Entry.MinX = CenterX - BS.Data.BS.Radius;
+		Entry.MaxX = CenterX + BS.Data.BS.Radius;
+	}
+}
+
+bool CPhysicsEngine::DetectResolveDynamicPair(uint32_t A_Body, uint32_t B_Body)
+{
+	// @important: sleeping bodies can't move into each other
+	if (m_Bodies.IsAsleep(A_Body) && m_Bodies.IsAsleep(B_Body)) return false;
+
+	const SBoundingVolume& A_BS{ m_Bodies.GetOuterBoundingSphere(A_Body) };
+	const SBoundingVolume& B_BS{ m_Bodies.GetOuterBoundingSphere(B_Body) };
+	XMVECTOR _A_T{ m_Bodies.GetPosition(A_Body) + A_BS.Center };
+	XMVECTOR _B_T{ m_Bodies.GetPosition(B_Body) + B_BS.Center };
+
+	if (!DetectIntersection(_A_T, A_BS, _B_T, B_BS)) return false;
+
+	XMVECTOR Diff{ _A_T - _B_T };
+	float Distance{ XMVectorGetX(XMVector3Length(Diff)) };
+	float RadiusSum{ A_BS.Data.BS.Radius + B_BS.Data.BS.Radius };
+	if (Distance >= RadiusSum) return false;
+
+	// Only the actual penetration is resolved
+	float PenetrationDepth{ RadiusSum - Distance };
+
+	// @important: crowds are separated on XZ plane only, so that bodies are not pushed into the floor
+	XMVECTOR DiffXZ{ XMVectorSetY(Diff, 0) };
+	float DistanceXZ{ XMVectorGetX(XMVector3Length(DiffXZ)) };
+	XMVECTOR N{};
+	if (DistanceXZ > FLT_EPSILON)
+	{
+		N = DiffXZ / DistanceXZ;
+	}
+	else
+	{
+		// Stacked or co-spawned bodies: the fallback direction differs per pair, so that a crowd spreads out instead of drifting along one axis
+		float Angle{ (float)((A_Body * 73856093u) ^ (B_Body * 19349663u)) * (XM_2PI / 4294967296.0f) };
+		N = XMVectorSet(cosf(Angle), 0, sinf(Angle), 0);
+	}
+
+	// Split the resolution by inverse masses (evenly if both are zero)
+	float A_InverseMass{ m_Bodies.GetInverseMass(A_Body) };
+	float B_InverseMass{ m_Bodies.GetInverseMass(B_Body) };
+	float InverseMassSum{ A_InverseMass + B_InverseMass };
+	float A_Ratio{ (InverseMassSum > 0) ? A_InverseMass / InverseMassSum : 0.5f };
+
+	m_Bodies.GetPosition(A_Body) += N * (PenetrationDepth * A_Ratio);
+	m_Bodies.GetPosition(B_Body) -= N * (PenetrationDepth * (1.0f - A_Ratio));
+
+	// A sleeping body that has been pushed has to fall (or be pushed) again
+	m_Bodies.WakeUp(A_Body);
+	m_Bodies.WakeUp(B_Body);
+
+	return true;
+}
+
 bool CPhysicsEngine::DetectIntersection(const XMVECTOR& APos, const SBoundingVolume& ABV, const XMVECTOR& BPos, const SBoundingVolume& BBV)
 {
 	if (ABV.eType == EBoundingVolumeType::BoundingSphere)
@@ -564,16 +1570,17 @@ bool CPhysicsEngine::DetectIntersection(const XMVECTOR& APos, const SBoundingVol
 	return false;
 }
 
-void CPhysicsEngine::ResolvePenetration(const SCollisionItem& FineCollision)
+void CPhysicsEngine::ResolvePenetration(const SCollisionItem& FineCollision, SCollisionScratch& Scratch)
 {
-	CObject3D* const A_Object{ FineCollision.A.Object3D };
+	XMVECTOR& A_Translation{ m_Bodies.GetPosition(FineCollision.A_Body) };
+	XMVECTOR& A_LinearVelocity{ m_Bodies.GetLinearVelocity(FineCollision.A_Body) };
 
 	const SBoundingVolume& A_BS{ *FineCollision.A_BS };
 	const SBoundingVolume& B_BS{ *FineCollision.B_BS };
 	XMVECTOR _A_T{ *FineCollision.A_Translation + A_BS.Center };
 	XMVECTOR _B_T{ *FineCollision.B_Translation + B_BS.Center };
 
-	XMVECTOR A_MovingDir{ XMVector3Normalize(A_Object->GetPhysics(FineCollision.A).LinearVelocity) };
+	XMVECTOR A_MovingDir{ XMVector3Normalize(A_LinearVelocity) };
 	XMVECTOR AToB{ _B_T - _A_T };
 
 	if (A_BS.eType == EBoundingVolumeType::BoundingSphere)
@@ -604,29 +1611,31 @@ void CPhysicsEngine::ResolvePenetration(const SCollisionItem& FineCollision)
 			if (discriminant > 0)
 			{
 				float x_bigger{ (-b + sqrt(discriminant)) / (2.0f * a) };
-				m_PenetrationDepth = abs(x_bigger);
+				Scratch.PenetrationDepth = abs(x_bigger);
 
 				XMVECTOR Resolution{ -A_MovingDir * x_bigger };
 
-				A_Object->Translate(FineCollision.A, Resolution);
+				A_Translation += Resolution;
+				Scratch.CollisionNormal = XMVector3Normalize(Resolution);
 			}
 		}
 		else
 		{
 			// dynamic Sphere - static AABB
 
-			XMVECTOR Diff{ m_StaticClosestPoint - m_DynamicClosestPoint };
+			XMVECTOR Diff{ Scratch.StaticClosestPoint - Scratch.DynamicClosestPoint };
 			XMVECTOR N{ XMVector3Normalize(Diff) };
 
 			XMVECTOR Resolution{ Diff };
-			m_PenetrationDepth = XMVectorGetX(XMVector3Length(Resolution));
+			Scratch.PenetrationDepth = XMVectorGetX(XMVector3Length(Resolution));
 
 			if (XMVectorGetY(N) == +1.0f)
 			{
 				// @important
-				A_Object->SetLinearVelocity(FineCollision.A, XMVectorSetY(A_Object->GetPhysics(FineCollision.A).LinearVelocity, -0.01f));
+				A_LinearVelocity = XMVectorSetY(A_LinearVelocity, -0.01f);
 			}
-			A_Object->Translate(FineCollision.A, Resolution);
+			A_Translation += Resolution;
+			Scratch.CollisionNormal = XMVector3Normalize(Resolution);
 		}
 	}
 	else
@@ -635,21 +1644,22 @@ void CPhysicsEngine::ResolvePenetration(const SCollisionItem& FineCollision)
 		{
 			// dynamic AABB - static Sphere
 
-			XMVECTOR Diff{ m_DynamicClosestPoint - _B_T };
+			XMVECTOR Diff{ Scratch.DynamicClosestPoint - _B_T };
 			float Distance{ XMVectorGetX(XMVector3Length(Diff)) };
 			XMVECTOR N{ XMVector3Normalize(Diff) };
 
-			m_PenetrationDepth = B_BS.Data.BS.Radius - Distance;
-			XMVECTOR Resolution{ m_PenetrationDepth * N };
+			Scratch.PenetrationDepth = B_BS.Data.BS.Radius - Distance;
+			XMVECTOR Resolution{ Scratch.PenetrationDepth * N };
 
-			A_Object->Translate(FineCollision.A, Resolution);
+			A_Translation += Resolution;
+			Scratch.CollisionNormal = XMVector3Normalize(Resolution);
 		}
 		else
 		{
 			// AABB - AABB
 
-			XMVECTOR Diff{ m_StaticClosestPoint - m_DynamicClosestPoint };
-			XMVECTOR N{ GetAABBAABBCollisionNormal(A_MovingDir, m_DynamicClosestPoint,
+			XMVECTOR Diff{ Scratch.StaticClosestPoint - Scratch.DynamicClosestPoint };
+			XMVECTOR N{ GetAABBAABBCollisionNormal(A_MovingDir, Scratch.DynamicClosestPoint,
 				_B_T, B_BS.Data.AABBHalfSizes.x, B_BS.Data.AABBHalfSizes.y, B_BS.Data.AABBHalfSizes.z) };
 
 			XMVECTOR Resolution{ XMVector3Dot(Diff, N) * N };
@@ -657,35 +1667,37 @@ void CPhysicsEngine::ResolvePenetration(const SCollisionItem& FineCollision)
 			float Dot{ XMVectorGetX(XMVector3Dot(XMVector3Normalize(Resolution), N)) };
 			if (Dot >= 0)
 			{
-				m_PenetrationDepth = XMVectorGetX(XMVector3Length(Resolution));
+				Scratch.PenetrationDepth = XMVectorGetX(XMVector3Length(Resolution));
 
 				if (XMVectorGetY(N) == +1.0f)
 				{
 					// @important
-					A_Object->SetLinearVelocity(FineCollision.A, XMVectorSetY(A_Object->GetPhysics(FineCollision.A).LinearVelocity, -0.01f));
+					A_LinearVelocity = XMVectorSetY(A_LinearVelocity, -0.01f);
 				}
-				A_Object->Translate(FineCollision.A, Resolution);
+				A_Translation += Resolution;
+				Scratch.CollisionNormal = XMVector3Normalize(Resolution);
 			}
 		}
 	}
 }
 
-void CPhysicsEngine::GetClosestPoints(const XMVECTOR& DynamicPos, const SBoundingVolume& DynamicBV, const XMVECTOR& StaticPos, const SBoundingVolume& StaticBV)
+void CPhysicsEngine::GetClosestPoints(const XMVECTOR& DynamicPos, const SBoundingVolume& DynamicBV, const XMVECTOR& StaticPos, const SBoundingVolume& StaticBV,
+	SCollisionScratch& Scratch)
 {
 	if (DynamicBV.eType == EBoundingVolumeType::BoundingSphere)
 	{
 		if (StaticBV.eType == EBoundingVolumeType::BoundingSphere)
 		{
 			// dynamic Sphere - static Sphere
-			m_DynamicClosestPoint = GetClosestPointSphere(StaticPos, DynamicPos, DynamicBV.Data.BS.Radius);
-			m_StaticClosestPoint = GetClosestPointSphere(DynamicPos, StaticPos, StaticBV.Data.BS.Radius);
+			Scratch.DynamicClosestPoint = GetClosestPointSphere(StaticPos, DynamicPos, DynamicBV.Data.BS.Radius);
+			Scratch.StaticClosestPoint = GetClosestPointSphere(DynamicPos, StaticPos, StaticBV.Data.BS.Radius);
 		}
 		else
 		{
 			// dynamic Sphere - static AABB
-			m_StaticClosestPoint = GetClosestPointAABB(DynamicPos,
+			Scratch.StaticClosestPoint = GetClosestPointAABB(DynamicPos,
 				StaticPos, StaticBV.Data.AABBHalfSizes.x, StaticBV.Data.AABBHalfSizes.y, StaticBV.Data.AABBHalfSizes.z);
-			m_DynamicClosestPoint = GetClosestPointSphere(m_StaticClosestPoint, DynamicPos, DynamicBV.Data.BS.Radius);
+			Scratch.DynamicClosestPoint = GetClosestPointSphere(Scratch.StaticClosestPoint, DynamicPos, DynamicBV.Data.BS.Radius);
 		}
 	}
 	else
@@ -693,16 +1705,16 @@ void CPhysicsEngine::GetClosestPoints(const XMVECTOR& DynamicPos, const SBoundin
 		if (StaticBV.eType == EBoundingVolumeType::BoundingSphere)
 		{
 			// dynamic AABB - static Sphere
-			m_DynamicClosestPoint = GetClosestPointAABB(StaticPos, 
+			Scratch.DynamicClosestPoint = GetClosestPointAABB(StaticPos, 
 				DynamicPos, DynamicBV.Data.AABBHalfSizes.x, DynamicBV.Data.AABBHalfSizes.y, DynamicBV.Data.AABBHalfSizes.z);
-			m_StaticClosestPoint = GetClosestPointSphere(m_DynamicClosestPoint, StaticPos, StaticBV.Data.BS.Radius);
+			Scratch.StaticClosestPoint = GetClosestPointSphere(Scratch.DynamicClosestPoint, StaticPos, StaticBV.Data.BS.Radius);
 		}
 		else
 		{
 			// dynamic AABB - static AABB
-			m_DynamicClosestPoint = GetClosestPointAABB(StaticPos,
+			Scratch.DynamicClosestPoint = GetClosestPointAABB(StaticPos,
 				DynamicPos, DynamicBV.Data.AABBHalfSizes.x, DynamicBV.Data.AABBHalfSizes.y, DynamicBV.Data.AABBHalfSizes.z);
-			m_StaticClosestPoint = GetClosestPointAABB(DynamicPos, 
+			Scratch.StaticClosestPoint = GetClosestPointAABB(DynamicPos, 
 				StaticPos, StaticBV.Data.AABBHalfSizes.x, StaticBV.Data.AABBHalfSizes.y, StaticBV.Data.AABBHalfSizes.z);
 		}
 	}
@@ -717,3 +1729,8 @@ const XMVECTOR& CPhysicsEngine::GetStaticClosestPoint() const
 {
 	return m_StaticClosestPoint;
 }
+
+const XMVECTOR& CPhysicsEngine::GetCollisionNormal() const
+{
+	return m_CollisionNormal;
+}
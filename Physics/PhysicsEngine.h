@@ -2,8 +2,13 @@
 
 #include "../Core/SharedHeader.h"
 #include "../Model/ObjectTypes.h"
+#include "DynamicAABBTree.h"
+#include "RigidBodyStore.h"
+#include "HeightField.h"
+#include "../Core/WorkerPool.h"
 
 class CObject3D;
+struct STERRData;
 
 enum class EObjectRole
 {
@@ -13,15 +18,37 @@ enum class EObjectRole
 	Monster
 };
 
+struct SRay
+{
+	SRay() {}
+	SRay(const XMVECTOR& _Origin, const XMVECTOR& _Direction, float _MaxT = FLT_MAX) : Origin{ _Origin }, Direction{ _Direction }, MaxT{ _MaxT } {}
+
+	XMVECTOR	Origin{};
+	XMVECTOR	Direction{};
+	float		MaxT{ FLT_MAX }; // in units of Direction
+};
+
+struct SRayHit
+{
+	bool		bHasHit{};
+	CObject3D*	PtrObject3D{};
+	size_t		InstanceIndex{};
+	XMVECTOR	Point{};
+	float		T{ FLT_MAX }; // in units of Direction
+};
+
+// A is a dynamic rigid body (handle), B is a static environment object
 struct SCollisionItem
 {
-	SObjectIdentifier		A{};
+	uint32_t				A_Body{};
 	const XMVECTOR*			A_Translation{};
 	const SBoundingVolume*	A_BS{};
-	SObjectIdentifier		B{};
+	CObject3D*				B_Object3D{};
+	size_t					B_InstanceIndex{};
 	const XMVECTOR*			B_Translation{};
 	const SBoundingVolume*	B_BS{};
 	float					DistanceSquare{};
+	uint32_t				CoarseIndex{}; // index before sorting
 
 	bool operator<(const SCollisionItem& b) const
 	{
@@ -29,6 +56,68 @@ struct SCollisionItem
 	}
 };
 
+// Fine collision of a volume pair (A is a dynamic body, B is an environment object), kept for the next tick.
+// While the pair stays within a tolerance of the inputs, the resolution is warm-started from the outputs instead of being recomputed.
+struct SContact
+{
+	// Key
+	CObject3D*				B_Object3D{};
+	size_t					B_InstanceIndex{};
+	const SBoundingVolume*	A_BVPtr{};
+	const SBoundingVolume*	B_BVPtr{};
+
+	// Inputs
+	SBoundingVolume			A_BV{};
+	SBoundingVolume			B_BV{};
+	XMVECTOR				A_Translation{};
+	XMVECTOR				B_Translation{};
+	XMVECTOR				A_LinearVelocity{};
+
+	// Outputs
+	XMVECTOR				DynamicClosestPoint{};
+	XMVECTOR				StaticClosestPoint{};
+	XMVECTOR				CollisionNormal{}; // From B to A
+	float					PenetrationDepth{};
+	bool					bHasClampedLinearVelocity{}; // resting on top of B
+};
+
+// Contacts of a dynamic body from the last tick it has been stepped
+struct SContactCache
+{
+	std::vector<SContact>						vContacts{};
+	std::vector<SContact>						vNextContacts{};
+	size_t										ContactCursor{}; // contacts are likely to come in the same order
+
+	std::vector<std::pair<CObject3D*, size_t>>	vCoarseKeys{}; // coarse list before sorting
+	std::vector<uint32_t>						vCoarseOrder{}; // sorted order of vCoarseKeys
+};
+
+// Sort-and-sweep broadphase entry for dynamic (player & monster) bodies
+struct SSweepEntry
+{
+	uint32_t	Body{};
+	float		MinX{};
+	float		MaxX{};
+};
+
+// Per-thread scratch data for narrow phase, so that bodies can be processed concurrently
+struct SCollisionScratch
+{
+	std::vector<SCollisionItem>	vCoarseCollisionList{};
+	std::vector<SCollisionItem>	vSortedCoarseCollisionList{};
+	std::vector<int32_t>		vEnvironmentQueryResult{};
+	std::vector<int32_t>		vEnvironmentQueryStack{};
+	std::vector<uint32_t>		vTriangleQueryResult{};
+
+	XMVECTOR					DynamicClosestPoint{};
+	XMVECTOR					StaticClosestPoint{};
+	XMVECTOR					CollisionNormal{};
+	float						PenetrationDepth{};
+
+	bool						bHasProcessedBody{};
+	uint32_t					LastProcessedBody{};
+};
+
 class CPhysicsEngine final
 {
 public:
@@ -44,6 +133,27 @@ public:
 
 	void SetGravity(const XMVECTOR& Gravity);
 
+// Terrain
+public:
+	// @important: call again whenever the terrain's heights have been changed
+	void SetTerrain(const STERRData& TerrainData);
+	void ClearTerrain();
+	bool HasTerrain() const;
+	const CHeightField& GetHeightField() const;
+
+// Fixed time step
+public:
+	void SetTickRate(float TicksPerSecond);
+	float GetTickRate() const;
+
+	// @important: the rest of the accumulated time is dropped when a frame needs more substeps than this
+	void SetMaxSubstepCount(uint32_t MaxSubstepCount);
+	uint32_t GetMaxSubstepCount() const;
+
+	// Positions pushed to objects are interpolated between the last two physics states
+	void ShouldInterpolateStates(bool Value);
+	float GetInterpolationAlpha() const;
+
 // Object registration & deregistration
 public:
 	void RegisterObject(CObject3D* const Object3D, EObjectRole eObjectRole);
@@ -71,9 +181,32 @@ public:
 public:
 	void ShouldApplyGravity(bool Value);
 
+	// WorkerCount == 0 means (hardware concurrency - 1)
+	void ShouldUseParallelUpdate(bool Value, size_t WorkerCount = 0);
+	// @important: physics state is always identical to the serial path,
+	// this flag makes the debugging output (closest points) identical as well
+	void ShouldUseDeterministicUpdate(bool Value);
+
+	// Bodies slower than SleepLinearSpeed for SleepTickCount ticks fall asleep (they are woken up when disabled)
+	void ShouldAllowSleeping(bool Value);
+	void SetSleepThreshold(float SleepLinearSpeed, uint32_t SleepTickCount);
+	size_t GetAsleepBodyCount() const;
+
+	// Environment objects without inner bounding volumes collide by their triangles (static models only)
+	void ShouldUseTriangleCollisions(bool Value);
+
 public:
 	bool PickObject(const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection);
 
+	// Closest environment object hit by each ray (vOutHits[i] is for vRays[i])
+	// Rays are sorted into packets by their direction octants, so coherent rays are traversed together.
+	// @important: objects without inner bounding volumes are hit by their triangles when triangle collisions are used
+	void RayCast(const std::vector<SRay>& vRays, std::vector<SRayHit>& vOutHits);
+
+private:
+	void RayCastPacket(const SRayPacket& Packet, const uint32_t* const RayIndices, const std::vector<SRay>& vRays, std::vector<SRayHit>& vOutHits);
+	uint32_t GetRayOctant(const XMVECTOR& RayDirection) const;
+
 private:
 	bool DetectRayObjectIntersection(const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection,
 		const XMVECTOR& Position, const SBoundingVolume& OuterBS, const std::vector<SBoundingVolume>& vInnerBVs, XMVECTOR& T);
@@ -86,27 +219,89 @@ public:
 	void Update(float DeltaTime);
 
 private:
-	void UpdateObject(float DeltaTime, CObject3D* const Object);
-	void _UpdateObject(const SObjectIdentifier& Identifier, float DeltaTime);
+	void CreateEnvironmentProxies(CObject3D* const Object3D);
+	void DestroyEnvironmentProxies(CObject3D* const Object3D);
+	void RefitEnvironmentTree();
+	SAABB GetEnvironmentProxyAABB(CObject3D* const Object3D, size_t InstanceIndex) const;
+	void MoveEnvironmentProxy(CObject3D* const Object3D, size_t ProxyIndex);
+	// Sleeping bodies around environment proxies that have been created, destroyed or moved have to be woken up
+	void AddDisturbedEnvironmentAABB(const SAABB& AABB);
+	void WakeUpBodiesInDisturbedEnvironment();
+
+private:
+	void Step(float TimeStep);
+	void CollectDynamicObjects();
+	void StepBodies(uint32_t BodyBegin, uint32_t BodyEnd, SCollisionScratch& Scratch);
+	static void StepBodiesJob(void* Context, size_t Begin, size_t End, size_t WorkerIndex);
+	void MergeCollisionScratches();
+	// All awake bodies at once (batched height field query)
+	void ResolveHeightFieldCollisions();
+
+private:
+	// Continuous collision detection for bodies that move farther than their radius in a step
+	bool SweepEnvironmentCollisions(uint32_t A_Body, SCollisionScratch& Scratch);
+	float GetSweptRadius(const SBoundingVolume& BV) const;
+	// @important: returns true only if it's earlier than *OutPtrTOI (which is then updated)
+	bool GetTimeOfImpact(const XMVECTOR& A_Center, float A_Radius, const XMVECTOR& A_Displacement,
+		const XMVECTOR& B_Center, const SBoundingVolume& B_BV, float* const OutPtrTOI) const;
 
 private:
-	bool DetectResolveEnvironmentCollisions(const SObjectIdentifier& A_Identifier);
-	bool DetectEnvironmentCoarseCollision(const SObjectIdentifier& A, const SObjectIdentifier& B);
-	bool DetectResolveFineCollision(const SCollisionItem& Coarse);
+	bool DetectResolveEnvironmentCollisions(uint32_t A_Body, SCollisionScratch& Scratch);
+	// @important: over Scratch.vEnvironmentQueryResult, 4 proxies at a time
+	void DetectEnvironmentCoarseCollisions(uint32_t A_Body, SCollisionScratch& Scratch);
+	void AddEnvironmentCoarseCollision(uint32_t A_Body, CObject3D* const B_Object3D, size_t B_InstanceIndex, SCollisionScratch& Scratch);
+	void GetEnvironmentBoundingSphere(CObject3D* const Object3D, size_t InstanceIndex,
+		const XMVECTOR*& OutPtrTranslation, const SBoundingVolume*& OutPtrBS) const;
+	bool DetectResolveFineCollision(const SCollisionItem& Coarse, SCollisionScratch& Scratch);
+	const std::vector<SCollisionItem>& SortCoarseCollisions(uint32_t A_Body, SCollisionScratch& Scratch);
+
+private:
+	bool CanUseTriangleCollisions(const CObject3D* const B_Object3D) const;
+	// @important: A's volumes are treated as spheres (AABBs by their inscribed spheres)
+	bool DetectResolveTriangleCollisions(const SCollisionItem& Coarse, SCollisionScratch& Scratch);
+
+private:
+	// Warm-started by the contact of the last tick
+	void ResolveContact(const SCollisionItem& Fine, const XMVECTOR& A_Center, const XMVECTOR& B_Center, SCollisionScratch& Scratch);
+	bool WarmStartContact(const SContact& LastContact, const SCollisionItem& Fine, SCollisionScratch& Scratch);
+	SContact* FindContact(SContactCache& Cache, const SCollisionItem& Fine);
+	bool IsSameBoundingVolume(const SBoundingVolume& A, const SBoundingVolume& B) const;
+	void RebuildContactCaches();
+	void InvalidateContactCaches();
+
+private:
+	void DetectResolveDynamicCollisions();
+	void RebuildSweepEntries();
+	void UpdateSweepEntries();
+	bool DetectResolveDynamicPair(uint32_t A_Body, uint32_t B_Body);
 
 private:
 	bool DetectIntersection(const XMVECTOR& APos, const SBoundingVolume& ABV, const XMVECTOR& BPos, const SBoundingVolume& BBV);
-	void ResolvePenetration(const SCollisionItem& FineCollision);
-	void GetClosestPoints(const XMVECTOR& DynamicPos, const SBoundingVolume& DynamicBV, const XMVECTOR& StaticPos, const SBoundingVolume& StaticBV);
+	void ResolvePenetration(const SCollisionItem& FineCollision, SCollisionScratch& Scratch);
+	void GetClosestPoints(const XMVECTOR& DynamicPos, const SBoundingVolume& DynamicBV, const XMVECTOR& StaticPos, const SBoundingVolume& StaticBV,
+		SCollisionScratch& Scratch);
 
 // DEBUGGING
 public:
 	const XMVECTOR& GetDynamicClosestPoint() const;
 	const XMVECTOR& GetStaticClosestPoint() const;
+	const XMVECTOR& GetCollisionNormal() const;
 
 private:
 	static constexpr XMVECTOR KDefaultGravity{ 0, -10.0f, 0, 0 };
 	static constexpr float KDefaultWorldFloorHeight{ -5.0f };
+	static constexpr float KDefaultTickRate{ 60.0f };
+	static constexpr uint32_t KDefaultMaxSubstepCount{ 4 };
+	static constexpr float KContinuousCollisionSkin{ 0.001f }; // how far a swept body is pushed into the contact
+	static constexpr size_t KParallelUpdateGrainSize{ 32 };
+	static constexpr size_t KParallelUpdateMinBodyCount{ 128 };
+	static constexpr float KDefaultSleepLinearSpeed{ 0.05f };
+	static constexpr uint32_t KDefaultSleepTickCount{ 30 };
+	static constexpr float KWalkableNormalY{ 0.7f }; // triangles steeper than this are walls
+	static constexpr size_t KMaxDisturbedEnvironmentAABBCount{ 64 }; // per update, further ones wake up all bodies
+	static constexpr float KDisturbedEnvironmentMargin{ 0.1f }; // so that bodies resting on a proxy are woken up as well
+	static constexpr float KContactWarmStartDistance{ 0.02f }; // how far a pair may move relative to its cached contact
+	static constexpr float KContactWarmStartCosine{ 0.99f }; // how far the moving direction may turn from its cached contact
 
 private:
 	CObject3D*							m_PlayerObject{};
@@ -115,12 +310,36 @@ private:
 	std::vector<CObject3D*>				m_vEnvironmentObjects{};
 	std::unordered_map<void*, uint32_t>	m_mapEnvironmentObjects{}; // avoid duplication
 
+private:
+	CDynamicAABBTree					m_EnvironmentTree{};
+	std::unordered_map<void*, std::vector<int32_t>>	m_umapEnvironmentProxyIDs{};
+	std::unordered_map<void*, std::vector<SAABB>>	m_umapEnvironmentProxyAABBs{}; // last (unfattened) AABB of each proxy
+	std::vector<uint32_t>				m_vMovedInstanceIndices{}; // of the environment object being refit
+	std::vector<SAABB>					m_vDisturbedEnvironmentAABBs{};
+	bool								m_bIsWholeEnvironmentDisturbed{};
+
 private:
 	std::vector<CObject3D*>				m_vMonsterObjects{};
 	std::unordered_map<void*, uint32_t>	m_mapMonsterObjects{}; // avoid duplication
 
 private:
-	std::vector<SCollisionItem>			m_vCoarseCollisionList{};
+	std::vector<SCollisionScratch>		m_vCollisionScratches{}; // one per thread
+	std::vector<SContactCache>			m_vContactCaches{}; // one per body
+
+private:
+	CHeightField						m_HeightField{};
+	std::vector<uint32_t>				m_vHeightFieldBodies{};
+	std::vector<XMVECTOR>				m_vHeightFieldPositions{};
+	std::vector<float>					m_vHeightFieldHeights{};
+	std::vector<XMVECTOR>				m_vHeightFieldNormals{};
+
+private:
+	CRigidBodyStore						m_Bodies{};
+	std::vector<CObject3D*>				m_vDynamicObjects{};
+
+private:
+	std::vector<SSweepEntry>			m_vSweepEntries{}; // sorted by MinX (temporal coherence)
+	std::vector<uint32_t>				m_vPushedBodies{};
 
 private:
 	XMVECTOR							m_DynamicClosestPoint{};
@@ -128,14 +347,40 @@ private:
 	XMVECTOR							m_CollisionNormal{}; // From B to A
 	float								m_PenetrationDepth{};
 
+private:
+	CWorkerPool							m_WorkerPool{};
+	float								m_StepDeltaTime{};
+
 private:
 	float								m_WorldFloorHeight{ KDefaultWorldFloorHeight };
 	XMVECTOR							m_Gravity{ KDefaultGravity };
 
+private:
+	float								m_FixedTimeStep{ 1.0f / KDefaultTickRate };
+	uint32_t							m_MaxSubstepCount{ KDefaultMaxSubstepCount };
+	float								m_TimeAccumulator{};
+	float								m_InterpolationAlpha{ 1.0f };
+
+private:
+	float								m_SleepLinearSpeed{ KDefaultSleepLinearSpeed };
+	uint32_t							m_SleepTickCount{ KDefaultSleepTickCount };
+
 private:
 	bool								m_bShouldApplyGravity{};
+	bool								m_bShouldInterpolateStates{ true };
+	bool								m_bShouldUseParallelUpdate{};
+	bool								m_bShouldUseDeterministicUpdate{ true };
+	bool								m_bShouldAllowSleeping{ true };
+	bool								m_bShouldUseTriangleCollisions{ true };
 
 private:
 	XMVECTOR							m_PickedPoint{};
 	CObject3D*							m_PickedObject{};
+
+private:
+	std::vector<SRay>					m_vPickingRays{};
+	std::vector<SRayHit>				m_vPickingHits{};
+	std::vector<uint32_t>				m_vRayOrder{}; // ray indices sorted by direction octants
+	std::vector<std::pair<int32_t, uint32_t>>	m_vRayQueryResult{};
+	std::vector<std::pair<int32_t, uint32_t>>	m_vRayQueryStack{};
 };
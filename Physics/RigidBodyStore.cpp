@@ -0,0 +1,338 @@
+#include "RigidBodyStore.h"
+#include "../Core/Math.h"
+#include "../Model/Object3D.h"
+
+CRigidBodyStore::CRigidBodyStore()
+{
+}
+
+CRigidBodyStore::~CRigidBodyStore()
+{
+}
+
+void CRigidBodyStore::Clear()
+{
+	m_vMembership.clear();
+	m_vIsObjectPushed.clear();
+
+	m_vObject3Ds.clear();
+	m_vInstanceIndices.clear();
+	m_vObjectIndices.clear();
+	m_vPositions.clear();
+	m_vPreviousPositions.clear();
+	m_vPresentedTransforms.clear();
+	m_vPresentedLinearVelocities.clear();
+	m_vLinearVelocities.clear();
+	m_vLinearAccelerations.clear();
+	m_vInverseMasses.clear();
+	m_vOuterBoundingSpheres.clear();
+	m_vIsOnWorldFloor.clear();
+	m_vIsPresented.clear();
+	m_vIsAsleep.clear();
+	m_vIsPresentedAsleep.clear();
+	m_vRestingTickCounts.clear();
+}
+
+bool CRigidBodyStore::SyncMembership(const std::vector<CObject3D*>& vDynamicObjects)
+{
+	bool bMembershipChanged{ vDynamicObjects.size() != m_vMembership.size() };
+	for (size_t iObject = 0; !bMembershipChanged && iObject < vDynamicObjects.size(); ++iObject)
+	{
+		CObject3D* const Object3D{ vDynamicObjects[iObject] };
+		size_t BodyCount{ (Object3D->IsInstanced()) ? Object3D->GetInstanceCount() : 1 };
+		if (m_vMembership[iObject].first != Object3D || m_vMembership[iObject].second != BodyCount)
+		{
+			bMembershipChanged = true;
+		}
+	}
+	if (!bMembershipChanged) return false;
+
+	Clear();
+
+	size_t TotalBodyCount{};
+	for (const auto& Object3D : vDynamicObjects)
+	{
+		TotalBodyCount += (Object3D->IsInstanced()) ? Object3D->GetInstanceCount() : 1;
+	}
+	m_vObject3Ds.reserve(TotalBodyCount);
+	m_vInstanceIndices.reserve(TotalBodyCount);
+	m_vObjectIndices.reserve(TotalBodyCount);
+
+	for (const auto& Object3D : vDynamicObjects)
+	{
+		size_t BodyCount{ (Object3D->IsInstanced()) ? Object3D->GetInstanceCount() : 1 };
+		for (size_t iBody = 0; iBody < BodyCount; ++iBody)
+		{
+			m_vObject3Ds.emplace_back(Object3D);
+			m_vInstanceIndices.emplace_back(iBody);
+			m_vObjectIndices.emplace_back((uint32_t)m_vMembership.size());
+		}
+		m_vMembership.emplace_back(Object3D, BodyCount);
+	}
+	m_vIsObjectPushed.resize(m_vMembership.size());
+
+	m_vPositions.resize(TotalBodyCount);
+	m_vPreviousPositions.resize(TotalBodyCount);
+	m_vPresentedTransforms.resize(TotalBodyCount);
+	m_vPresentedLinearVelocities.resize(TotalBodyCount);
+	m_vLinearVelocities.resize(TotalBodyCount);
+	m_vLinearAccelerations.resize(TotalBodyCount);
+	m_vInverseMasses.resize(TotalBodyCount);
+	m_vOuterBoundingSpheres.resize(TotalBodyCount);
+	m_vIsOnWorldFloor.resize(TotalBodyCount);
+	m_vIsPresented.resize(TotalBodyCount);
+	m_vIsAsleep.resize(TotalBodyCount);
+	m_vIsPresentedAsleep.resize(TotalBodyCount);
+	m_vRestingTickCounts.resize(TotalBodyCount);
+
+	return true;
+}
+
+void CRigidBodyStore::PullFromObjects()
+{
+	for (size_t iBody = 0; iBody < m_vObject3Ds.size(); ++iBody)
+	{
+		const CObject3D* const Object3D{ m_vObject3Ds[iBody] };
+		const SComponentTransform* Transform{ &Object3D->GetTransform() };
+		const SComponentPhysics* Physics{ &Object3D->GetPhysics() };
+		const SBoundingVolume* OuterBS{ &Object3D->GetOuterBoundingSphere() };
+		if (Object3D->IsInstanced())
+		{
+			const auto& InstanceCPUData{ Object3D->GetInstanceCPUDataVector()[m_vInstanceIndices[iBody]] };
+			Transform = &InstanceCPUData.Transform;
+			Physics = &InstanceCPUData.Physics;
+			OuterBS = &InstanceCPUData.EditorBoundingSphere;
+		}
+		m_vLinearVelocities[iBody] = Physics->LinearVelocity;
+		m_vLinearAccelerations[iBody] = Physics->LinearAcceleration;
+		m_vInverseMasses[iBody] = Physics->InverseMass;
+		m_vOuterBoundingSpheres[iBody] = *OuterBS;
+
+		// @important: if the object has been moved by someone else, it's a teleport (no interpolation)
+		const SComponentTransform& PresentedTransform{ m_vPresentedTransforms[iBody] };
+		bool bIsTeleported{ !m_vIsPresented[iBody] || !XMVector3Equal(Transform->Translation, PresentedTransform.Translation) };
+		if (bIsTeleported)
+		{
+			m_vPositions[iBody] = Transform->Translation;
+			m_vPreviousPositions[iBody] = Transform->Translation;
+		}
+
+		// @important: values are compared instead of calls,
+		// so that behaviors which keep setting the same velocity (e.g. Wait) don't wake the body up
+		if (m_vIsAsleep[iBody])
+		{
+			if (bIsTeleported ||
+				!XMVector3Equal(Physics->LinearVelocity, m_vPresentedLinearVelocities[iBody]) ||
+				!XMVector3Equal(Physics->LinearAcceleration, KVectorZero) ||
+				!XMVector3Equal(Transform->Scaling, PresentedTransform.Scaling) ||
+				Transform->Pitch != PresentedTransform.Pitch ||
+				Transform->Yaw != PresentedTransform.Yaw ||
+				Transform->Roll != PresentedTransform.Roll)
+			{
+				WakeUp((uint32_t)iBody);
+			}
+		}
+	}
+}
+
+void CRigidBodyStore::PushToObjects(float InterpolationAlpha)
+{
+	for (auto& IsObjectPushed : m_vIsObjectPushed)
+	{
+		IsObjectPushed = 0;
+	}
+
+	for (size_t iBody = 0; iBody < m_vObject3Ds.size(); ++iBody)
+	{
+		// @important: the object already holds the final state of a sleeping body
+		if (m_vIsAsleep[iBody] && m_vIsPresentedAsleep[iBody]) continue;
+
+		XMVECTOR PresentedPosition{ (InterpolationAlpha >= 1.0f) ? m_vPositions[iBody] :
+			XMVectorLerp(m_vPreviousPositions[iBody], m_vPositions[iBody], InterpolationAlpha) };
+
+		CObject3D* const Object3D{ m_vObject3Ds[iBody] };
+		if (Object3D->IsInstanced())
+		{
+			size_t iInstance{ m_vInstanceIndices[iBody] };
+			Object3D->TranslateInstanceTo(iInstance, PresentedPosition);
+			Object3D->SetInstanceLinearVelocity(iInstance, m_vLinearVelocities[iBody]);
+			Object3D->SetInstanceLinearAcceleration(iInstance, m_vLinearAccelerations[iBody]);
+			m_vPresentedTransforms[iBody] = Object3D->GetInstanceCPUDataVector()[iInstance].Transform;
+		}
+		else
+		{
+			Object3D->TranslateTo(PresentedPosition);
+			Object3D->SetLinearVelocity(m_vLinearVelocities[iBody]);
+			Object3D->SetLinearAcceleration(m_vLinearAccelerations[iBody]);
+			m_vPresentedTransforms[iBody] = Object3D->GetTransform();
+		}
+		m_vPresentedLinearVelocities[iBody] = m_vLinearVelocities[iBody];
+		m_vIsPresented[iBody] = 1;
+		m_vIsPresentedAsleep[iBody] = m_vIsAsleep[iBody];
+		m_vIsObjectPushed[m_vObjectIndices[iBody]] = 1;
+	}
+}
+
+void CRigidBodyStore::SavePreviousPositions()
+{
+	m_vPreviousPositions = m_vPositions;
+}
+
+void CRigidBodyStore::UpdateSleepStates(float SleepLinearSpeed, uint32_t SleepTickCount)
+{
+	const float SleepLinearSpeedSquare{ SleepLinearSpeed * SleepLinearSpeed };
+	for (size_t iBody = 0; iBody < m_vObject3Ds.size(); ++iBody)
+	{
+		if (m_vIsAsleep[iBody]) continue;
+
+		if (XMVectorGetX(XMVector3LengthSq(m_vLinearVelocities[iBody])) < SleepLinearSpeedSquare)
+		{
+			if (++m_vRestingTickCounts[iBody] >= SleepTickCount)
+			{
+				m_vIsAsleep[iBody] = 1;
+				m_vLinearVelocities[iBody] = KVectorZero;
+				m_vLinearAccelerations[iBody] = KVectorZero;
+			}
+		}
+		else
+		{
+			m_vRestingTickCounts[iBody] = 0;
+		}
+	}
+}
+
+void CRigidBodyStore::WakeUp(uint32_t Body)
+{
+	m_vIsAsleep[Body] = 0;
+	m_vRestingTickCounts[Body] = 0;
+}
+
+void CRigidBodyStore::WakeUpAll()
+{
+	for (uint32_t iBody = 0; iBody < (uint32_t)m_vObject3Ds.size(); ++iBody)
+	{
+		WakeUp(iBody);
+	}
+}
+
+bool CRigidBodyStore::IsAsleep(uint32_t Body) const
+{
+	return (m_vIsAsleep[Body] != 0);
+}
+
+bool CRigidBodyStore::IsObjectPushed(size_t ObjectIndex) const
+{
+	if (ObjectIndex >= m_vIsObjectPushed.size()) return false;
+	return (m_vIsObjectPushed[ObjectIndex] != 0);
+}
+
+size_t CRigidBodyStore::GetAsleepBodyCount() const
+{
+	size_t Result{};
+	for (const auto& IsAsleep : m_vIsAsleep)
+	{
+		if (IsAsleep) ++Result;
+	}
+	return Result;
+}
+
+void CRigidBodyStore::Integrate(float DeltaTime, const XMVECTOR& Gravity, bool bShouldApplyGravity, float WorldFloorHeight)
+{
+	Integrate(0, (uint32_t)m_vPositions.size(), DeltaTime, Gravity, bShouldApplyGravity, WorldFloorHeight);
+}
+
+void CRigidBodyStore::Integrate(uint32_t BodyBegin, uint32_t BodyEnd,
+	float DeltaTime, const XMVECTOR& Gravity, bool bShouldApplyGravity, float WorldFloorHeight)
+{
+	XMVECTOR* const Positions{ m_vPositions.data() };
+	XMVECTOR* const LinearVelocities{ m_vLinearVelocities.data() };
+	XMVECTOR* const LinearAccelerations{ m_vLinearAccelerations.data() };
+	const XMVECTOR AppliedGravity{ (bShouldApplyGravity) ? Gravity : KVectorZero };
+
+	// Semi-implicit Euler
+	for (uint32_t iBody = BodyBegin; iBody < BodyEnd; ++iBody)
+	{
+		if (m_vIsAsleep[iBody]) continue;
+
+		LinearVelocities[iBody] += (LinearAccelerations[iBody] + AppliedGravity) * DeltaTime;
+		Positions[iBody] += LinearVelocities[iBody] * DeltaTime;
+		LinearAccelerations[iBody] = KVectorZero;
+	}
+
+	// World floor
+	for (uint32_t iBody = BodyBegin; iBody < BodyEnd; ++iBody)
+	{
+		if (m_vIsAsleep[iBody]) continue;
+
+		if (XMVectorGetY(Positions[iBody]) < WorldFloorHeight)
+		{
+			Positions[iBody] = XMVectorSetY(Positions[iBody], WorldFloorHeight);
+			LinearVelocities[iBody] = XMVectorSetY(LinearVelocities[iBody], 0.0f);
+			m_vIsOnWorldFloor[iBody] = 1;
+		}
+		else
+		{
+			m_vIsOnWorldFloor[iBody] = 0;
+		}
+	}
+}
+
+size_t CRigidBodyStore::GetBodyCount() const
+{
+	return m_vObject3Ds.size();
+}
+
+CObject3D* CRigidBodyStore::GetObject3D(uint32_t Body) const
+{
+	return m_vObject3Ds[Body];
+}
+
+size_t CRigidBodyStore::GetInstanceIndex(uint32_t Body) const
+{
+	return m_vInstanceIndices[Body];
+}
+
+const std::vector<SBoundingVolume>& CRigidBodyStore::GetInnerBoundingVolumes(uint32_t Body) const
+{
+	return m_vObject3Ds[Body]->GetInnerBoundingVolumeVector();
+}
+
+XMVECTOR& CRigidBodyStore::GetPosition(uint32_t Body)
+{
+	return m_vPositions[Body];
+}
+
+XMVECTOR& CRigidBodyStore::GetLinearVelocity(uint32_t Body)
+{
+	return m_vLinearVelocities[Body];
+}
+
+const XMVECTOR& CRigidBodyStore::GetPosition(uint32_t Body) const
+{
+	return m_vPositions[Body];
+}
+
+const XMVECTOR& CRigidBodyStore::GetPreviousPosition(uint32_t Body) const
+{
+	return m_vPreviousPositions[Body];
+}
+
+const XMVECTOR& CRigidBodyStore::GetLinearVelocity(uint32_t Body) const
+{
+	return m_vLinearVelocities[Body];
+}
+
+const SBoundingVolume& CRigidBodyStore::GetOuterBoundingSphere(uint32_t Body) const
+{
+	return m_vOuterBoundingSpheres[Body];
+}
+
+float CRigidBodyStore::GetInverseMass(uint32_t Body) const
+{
+	return m_vInverseMasses[Body];
+}
+
+bool CRigidBodyStore::IsOnWorldFloor(uint32_t Body) const
+{
+	return (m_vIsOnWorldFloor[Body] != 0);
+}
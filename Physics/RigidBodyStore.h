@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../Core/SharedHeader.h"
+
+class CObject3D;
+
+// Structure-of-arrays store of dynamic rigid bodies (player & monster instances)
+// Bodies are addressed by integer handles, which stay valid until the membership changes.
+// State is pulled from CObject3D once at the start of a tick and pushed back once at the end,
+// so the physics engine never has to resolve instance names in between.
+// Positions pushed to CObject3D may be interpolated between the last two physics states,
+// so the simulated positions are kept here unless someone else has moved the object in the meantime.
+// Bodies that have been resting for a while fall asleep: they are neither integrated nor pushed back,
+// until something else touches their transform or physics component, or an awake body collides with them.
+class CRigidBodyStore final
+{
+public:
+	CRigidBodyStore();
+	~CRigidBodyStore();
+
+public:
+	void Clear();
+
+	// @important: returns true if the bodies were rebuilt (all handles are invalidated)
+	bool SyncMembership(const std::vector<CObject3D*>& vDynamicObjects);
+
+	void PullFromObjects();
+	// InterpolationAlpha == 0: previous state, InterpolationAlpha == 1: current state
+	void PushToObjects(float InterpolationAlpha);
+
+	void SavePreviousPositions();
+
+// Sleeping
+public:
+	// @important: call once per step, after all collisions have been resolved
+	void UpdateSleepStates(float SleepLinearSpeed, uint32_t SleepTickCount);
+	void WakeUp(uint32_t Body);
+	void WakeUpAll();
+
+	bool IsAsleep(uint32_t Body) const;
+	// @important: false if no body of the object has been pushed in the last PushToObjects()
+	bool IsObjectPushed(size_t ObjectIndex) const;
+	size_t GetAsleepBodyCount() const;
+
+public:
+	void Integrate(float DeltaTime, const XMVECTOR& Gravity, bool bShouldApplyGravity, float WorldFloorHeight);
+
+	// @important: bodies in [BodyBegin, BodyEnd) only, so disjoint ranges can be integrated concurrently
+	void Integrate(uint32_t BodyBegin, uint32_t BodyEnd,
+		float DeltaTime, const XMVECTOR& Gravity, bool bShouldApplyGravity, float WorldFloorHeight);
+
+public:
+	size_t GetBodyCount() const;
+	CObject3D* GetObject3D(uint32_t Body) const;
+	size_t GetInstanceIndex(uint32_t Body) const;
+	const std::vector<SBoundingVolume>& GetInnerBoundingVolumes(uint32_t Body) const;
+
+	XMVECTOR& GetPosition(uint32_t Body);
+	XMVECTOR& GetLinearVelocity(uint32_t Body);
+	const XMVECTOR& GetPosition(uint32_t Body) const;
+	const XMVECTOR& GetPreviousPosition(uint32_t Body) const;
+	const XMVECTOR& GetLinearVelocity(uint32_t Body) const;
+	const SBoundingVolume& GetOuterBoundingSphere(uint32_t Body) const;
+	float GetInverseMass(uint32_t Body) const;
+	bool IsOnWorldFloor(uint32_t Body) const;
+
+private:
+	std::vector<std::pair<CObject3D*, size_t>>	m_vMembership{}; // (Object3D, body count)
+	std::vector<uint8_t>						m_vIsObjectPushed{};
+
+private:
+	std::vector<CObject3D*>						m_vObject3Ds{};
+	std::vector<size_t>							m_vInstanceIndices{};
+	std::vector<uint32_t>						m_vObjectIndices{}; // index into m_vMembership
+	std::vector<XMVECTOR>						m_vPositions{};
+	std::vector<XMVECTOR>						m_vPreviousPositions{};
+	std::vector<SComponentTransform>			m_vPresentedTransforms{}; // last transform pushed to CObject3D
+	std::vector<XMVECTOR>						m_vPresentedLinearVelocities{}; // last velocity pushed to CObject3D
+	std::vector<XMVECTOR>						m_vLinearVelocities{};
+	std::vector<XMVECTOR>						m_vLinearAccelerations{};
+	std::vector<float>							m_vInverseMasses{};
+	std::vector<SBoundingVolume>				m_vOuterBoundingSpheres{};
+	std::vector<uint8_t>						m_vIsOnWorldFloor{};
+	std::vector<uint8_t>						m_vIsPresented{};
+	std::vector<uint8_t>						m_vIsAsleep{};
+	std::vector<uint8_t>						m_vIsPresentedAsleep{}; // asleep when it was last pushed
+	std::vector<uint32_t>						m_vRestingTickCounts{};
+};
@@ -0,0 +1,284 @@
+#include "TriangleBVH.h"
+#include "../Core/Math.h"
+
+using std::nth_element;
+
+CTriangleBVH::CTriangleBVH()
+{
+}
+
+CTriangleBVH::~CTriangleBVH()
+{
+}
+
+void CTriangleBVH::Build(const SMesh& Mesh)
+{
+	Clear();
+
+	uint32_t TriangleCount{ (uint32_t)Mesh.vTriangles.size() };
+	if (TriangleCount == 0) return;
+
+	std::vector<XMVECTOR> vCentroids{};
+	m_vVertices.reserve((size_t)TriangleCount * 3);
+	vCentroids.reserve(TriangleCount);
+	m_vTriangleIndices.reserve(TriangleCount);
+	for (uint32_t iTriangle = 0; iTriangle < TriangleCount; ++iTriangle)
+	{
+		const STriangle& Triangle{ Mesh.vTriangles[iTriangle] };
+		const XMVECTOR& V0{ Mesh.vVertices[Triangle.I0].Position };
+		const XMVECTOR& V1{ Mesh.vVertices[Triangle.I1].Position };
+		const XMVECTOR& V2{ Mesh.vVertices[Triangle.I2].Position };
+		m_vVertices.emplace_back(V0);
+		m_vVertices.emplace_back(V1);
+		m_vVertices.emplace_back(V2);
+		vCentroids.emplace_back((V0 + V1 + V2) / 3.0f);
+		m_vTriangleIndices.emplace_back(iTriangle);
+	}
+
+	// Top-down median split on the longest axis
+	m_vNodes.reserve((size_t)TriangleCount * 2 / KMaxLeafTriangleCount + 1);
+	m_vNodes.emplace_back();
+
+	std::vector<SBuildItem> vBuildStack{};
+	vBuildStack.push_back({ 0, 0, TriangleCount });
+	while (vBuildStack.size())
+	{
+		SBuildItem Item{ vBuildStack.back() };
+		vBuildStack.pop_back();
+
+		SetNodeBounds(m_vNodes[Item.Node], Item.First, Item.Count);
+		if (Item.Count <= KMaxLeafTriangleCount)
+		{
+			m_vNodes[Item.Node].FirstOrChild = Item.First;
+			m_vNodes[Item.Node].TriangleCount = Item.Count;
+			continue;
+		}
+
+		SCentroidLess CentroidLess{};
+		CentroidLess.PtrCentroids = &vCentroids;
+		CentroidLess.Axis = GetLongestAxis(m_vNodes[Item.Node]);
+
+		uint32_t HalfCount{ Item.Count / 2 };
+		auto itFirst{ m_vTriangleIndices.begin() + Item.First };
+		nth_element(itFirst, itFirst + HalfCount, itFirst + Item.Count, CentroidLess);
+
+		uint32_t ChildA{ (uint32_t)m_vNodes.size() };
+		m_vNodes.emplace_back();
+		m_vNodes.emplace_back();
+		m_vNodes[Item.Node].FirstOrChild = ChildA;
+		m_vNodes[Item.Node].TriangleCount = 0;
+
+		vBuildStack.push_back({ ChildA, Item.First, HalfCount });
+		vBuildStack.push_back({ ChildA + 1, Item.First + HalfCount, Item.Count - HalfCount });
+	}
+}
+
+void CTriangleBVH::Clear()
+{
+	m_vNodes.clear();
+	m_vTriangleIndices.clear();
+	m_vVertices.clear();
+}
+
+bool CTriangleBVH::RayCast(const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection, float* const OutPtrT, uint32_t* const OutPtrTriangleIndex) const
+{
+	if (m_vNodes.empty()) return false;
+
+	const XMVECTOR InverseRayDirection{ XMVectorReciprocal(RayDirection) };
+	float ClosestT{ FLT_MAX };
+	bool bHit{ false };
+
+	uint32_t Stack[KMaxDepth]{};
+	uint32_t StackSize{};
+	Stack[StackSize++] = 0;
+	while (StackSize)
+	{
+		const SNode& Node{ m_vNodes[Stack[--StackSize]] };
+		if (!IntersectRayNode(Node, RayOrigin, InverseRayDirection, ClosestT)) continue;
+
+		if (Node.IsLeaf())
+		{
+			for (uint32_t iItem = Node.FirstOrChild; iItem < Node.FirstOrChild + Node.TriangleCount; ++iItem)
+			{
+				uint32_t TriangleIndex{ m_vTriangleIndices[iItem] };
+				const XMVECTOR* const V{ &m_vVertices[(size_t)TriangleIndex * 3] };
+
+				XMVECTOR NewT{};
+				if (IntersectRayTriangle(RayOrigin, RayDirection, V[0], V[1], V[2], &NewT))
+				{
+					if (XMVectorGetX(NewT) < ClosestT)
+					{
+						ClosestT = XMVectorGetX(NewT);
+						if (OutPtrTriangleIndex) *OutPtrTriangleIndex = TriangleIndex;
+						bHit = true;
+					}
+				}
+			}
+		}
+		else
+		{
+			assert(StackSize + 2 <= KMaxDepth);
+			Stack[StackSize++] = Node.FirstOrChild;
+			Stack[StackSize++] = Node.FirstOrChild + 1;
+		}
+	}
+
+	if (bHit && OutPtrT) *OutPtrT = ClosestT;
+	return bHit;
+}
+
+uint32_t CTriangleBVH::RayCastPacket(const SRayPacket& Packet, uint32_t RayMask, float* const InOutTs, uint32_t* const OutTriangleIndices) const
+{
+	if (m_vNodes.empty()) return 0;
+
+	uint32_t HitMask{};
+
+	// @important: every node is pushed with the rays that have hit its parent
+	uint32_t NodeStack[KMaxDepth]{};
+	uint32_t RayMaskStack[KMaxDepth]{};
+	uint32_t StackSize{};
+	NodeStack[StackSize] = 0;
+	RayMaskStack[StackSize++] = RayMask;
+	while (StackSize)
+	{
+		--StackSize;
+		const SNode& Node{ m_vNodes[NodeStack[StackSize]] };
+		uint32_t NodeRayMask{};
+		for (uint32_t iRay = 0; iRay < Packet.RayCount; ++iRay)
+		{
+			if ((RayMaskStack[StackSize] & (1u << iRay)) == 0) continue;
+			if (IntersectRayNode(Node, Packet.Origins[iRay], Packet.InverseDirections[iRay], InOutTs[iRay])) NodeRayMask |= (1u << iRay);
+		}
+		if (NodeRayMask == 0) continue;
+
+		if (Node.IsLeaf())
+		{
+			for (uint32_t iItem = Node.FirstOrChild; iItem < Node.FirstOrChild + Node.TriangleCount; ++iItem)
+			{
+				uint32_t TriangleIndex{ m_vTriangleIndices[iItem] };
+				const XMVECTOR* const V{ &m_vVertices[(size_t)TriangleIndex * 3] };
+				for (uint32_t iRay = 0; iRay < Packet.RayCount; ++iRay)
+				{
+					if ((NodeRayMask & (1u << iRay)) == 0) continue;
+
+					XMVECTOR NewT{};
+					if (IntersectRayTriangle(Packet.Origins[iRay], Packet.Directions[iRay], V[0], V[1], V[2], &NewT))
+					{
+						if (XMVectorGetX(NewT) < InOutTs[iRay])
+						{
+							InOutTs[iRay] = XMVectorGetX(NewT);
+							if (OutTriangleIndices) OutTriangleIndices[iRay] = TriangleIndex;
+							HitMask |= (1u << iRay);
+						}
+					}
+				}
+			}
+		}
+		else
+		{
+			assert(StackSize + 2 <= KMaxDepth);
+			NodeStack[StackSize] = Node.FirstOrChild;
+			RayMaskStack[StackSize++] = NodeRayMask;
+			NodeStack[StackSize] = Node.FirstOrChild + 1;
+			RayMaskStack[StackSize++] = NodeRayMask;
+		}
+	}
+
+	return HitMask;
+}
+
+void CTriangleBVH::QuerySphere(const XMVECTOR& Center, float Radius, std::vector<uint32_t>& vOutTriangleIndices) const
+{
+	if (m_vNodes.empty()) return;
+
+	const float RadiusSquare{ Radius * Radius };
+
+	uint32_t Stack[KMaxDepth]{};
+	uint32_t StackSize{};
+	Stack[StackSize++] = 0;
+	while (StackSize)
+	{
+		const SNode& Node{ m_vNodes[Stack[--StackSize]] };
+		if (!IntersectSphereNode(Node, Center, RadiusSquare)) continue;
+
+		if (Node.IsLeaf())
+		{
+			for (uint32_t iItem = Node.FirstOrChild; iItem < Node.FirstOrChild + Node.TriangleCount; ++iItem)
+			{
+				vOutTriangleIndices.emplace_back(m_vTriangleIndices[iItem]);
+			}
+		}
+		else
+		{
+			assert(StackSize + 2 <= KMaxDepth);
+			Stack[StackSize++] = Node.FirstOrChild;
+			Stack[StackSize++] = Node.FirstOrChild + 1;
+		}
+	}
+}
+
+bool CTriangleBVH::IsBuilt() const
+{
+	return !m_vNodes.empty();
+}
+
+size_t CTriangleBVH::GetNodeCount() const
+{
+	return m_vNodes.size();
+}
+
+size_t CTriangleBVH::GetTriangleCount() const
+{
+	return m_vTriangleIndices.size();
+}
+
+void CTriangleBVH::GetTriangle(uint32_t TriangleIndex, XMVECTOR& OutV0, XMVECTOR& OutV1, XMVECTOR& OutV2) const
+{
+	const XMVECTOR* const V{ &m_vVertices[(size_t)TriangleIndex * 3] };
+	OutV0 = V[0];
+	OutV1 = V[1];
+	OutV2 = V[2];
+}
+
+void CTriangleBVH::SetNodeBounds(SNode& Node, uint32_t First, uint32_t Count) const
+{
+	XMVECTOR Min{ XMVectorReplicate(+FLT_MAX) };
+	XMVECTOR Max{ XMVectorReplicate(-FLT_MAX) };
+	for (uint32_t iItem = First; iItem < First + Count; ++iItem)
+	{
+		const XMVECTOR* const V{ &m_vVertices[(size_t)m_vTriangleIndices[iItem] * 3] };
+		Min = XMVectorMin(Min, XMVectorMin(V[0], XMVectorMin(V[1], V[2])));
+		Max = XMVectorMax(Max, XMVectorMax(V[0], XMVectorMax(V[1], V[2])));
+	}
+	XMStoreFloat3(&Node.Min, Min);
+	XMStoreFloat3(&Node.Max, Max);
+}
+
+uint32_t CTriangleBVH::GetLongestAxis(const SNode& Node) const
+{
+	float ExtentX{ Node.Max.x - Node.Min.x };
+	float ExtentY{ Node.Max.y - Node.Min.y };
+	float ExtentZ{ Node.Max.z - Node.Min.z };
+	if (ExtentX >= ExtentY && ExtentX >= ExtentZ) return 0;
+	if (ExtentY >= ExtentZ) return 1;
+	return 2;
+}
+
+bool CTriangleBVH::IntersectRayNode(const SNode& Node, const XMVECTOR& RayOrigin, const XMVECTOR& InverseRayDirection, float MaxT)
+{
+	// Slab test
+	XMVECTOR T0{ (XMLoadFloat3(&Node.Min) - RayOrigin) * InverseRayDirection };
+	XMVECTOR T1{ (XMLoadFloat3(&Node.Max) - RayOrigin) * InverseRayDirection };
+	XMVECTOR TMin{ XMVectorMin(T0, T1) };
+	XMVECTOR TMax{ XMVectorMax(T0, T1) };
+
+	float Enter{ max(XMVectorGetX(TMin), max(XMVectorGetY(TMin), XMVectorGetZ(TMin))) };
+	float Exit{ min(XMVectorGetX(TMax), min(XMVectorGetY(TMax), XMVectorGetZ(TMax))) };
+	return (Enter <= Exit && Exit > 0.0f && Enter < MaxT);
+}
+
+bool CTriangleBVH::IntersectSphereNode(const SNode& Node, const XMVECTOR& Center, float RadiusSquare)
+{
+	XMVECTOR ClosestPoint{ XMVectorMin(XMVectorMax(Center, XMLoadFloat3(&Node.Min)), XMLoadFloat3(&Node.Max)) };
+	return (XMVectorGetX(XMVector3LengthSq(Center - ClosestPoint)) <= RadiusSquare);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../Core/SharedHeader.h"
+#include "../Model/ObjectTypes.h"
+#include "DynamicAABBTree.h"
+
+// Static bounding volume hierarchy over the triangles of a mesh, built in model space.
+// Queries are expected to be transformed into model space by the caller,
+// so that no vertex needs to be transformed to world space unless it's actually hit.
+class CTriangleBVH final
+{
+public:
+	static constexpr uint32_t KMaxLeafTriangleCount{ 4 };
+	static constexpr uint32_t KMaxDepth{ 64 }; // median splits keep the tree balanced
+
+private:
+	// Internal node: ChildA == FirstOrChild, ChildB == FirstOrChild + 1
+	// Leaf: triangles [FirstOrChild, FirstOrChild + TriangleCount) of m_vTriangleIndices
+	struct SNode
+	{
+		bool IsLeaf() const { return (TriangleCount > 0); }
+
+		XMFLOAT3	Min{};
+		uint32_t	FirstOrChild{};
+		XMFLOAT3	Max{};
+		uint32_t	TriangleCount{};
+	};
+
+	struct SBuildItem
+	{
+		uint32_t	Node{};
+		uint32_t	First{};
+		uint32_t	Count{};
+	};
+
+	struct SCentroidLess
+	{
+		bool operator()(uint32_t a, uint32_t b) const
+		{
+			return XMVectorGetByIndex((*PtrCentroids)[a], Axis) < XMVectorGetByIndex((*PtrCentroids)[b], Axis);
+		}
+
+		const std::vector<XMVECTOR>*	PtrCentroids{};
+		uint32_t						Axis{};
+	};
+
+public:
+	CTriangleBVH();
+	~CTriangleBVH();
+
+public:
+	void Build(const SMesh& Mesh);
+	void Clear();
+
+public:
+	// @important: RayDirection doesn't need to be normalized, *OutPtrT is in units of RayDirection
+	bool RayCast(const XMVECTOR& RayOrigin, const XMVECTOR& RayDirection, float* const OutPtrT, uint32_t* const OutPtrTriangleIndex) const;
+
+	// Rays in RayMask are traversed together, InOutTs[] are the closest hits so far (FLT_MAX if none)
+	// @important: returns the mask of the rays whose InOutTs[] (and OutTriangleIndices[]) have been updated
+	uint32_t RayCastPacket(const SRayPacket& Packet, uint32_t RayMask, float* const InOutTs, uint32_t* const OutTriangleIndices) const;
+
+	// Triangles whose bounds overlap the sphere (candidates only, exact tests are up to the caller)
+	void QuerySphere(const XMVECTOR& Center, float Radius, std::vector<uint32_t>& vOutTriangleIndices) const;
+
+public:
+	bool IsBuilt() const;
+	size_t GetNodeCount() const;
+	size_t GetTriangleCount() const;
+	void GetTriangle(uint32_t TriangleIndex, XMVECTOR& OutV0, XMVECTOR& OutV1, XMVECTOR& OutV2) const;
+
+private:
+	void SetNodeBounds(SNode& Node, uint32_t First, uint32_t Count) const;
+	uint32_t GetLongestAxis(const SNode& Node) const;
+
+private:
+	static bool IntersectRayNode(const SNode& Node, const XMVECTOR& RayOrigin, const XMVECTOR& InverseRayDirection, float MaxT);
+	static bool IntersectSphereNode(const SNode& Node, const XMVECTOR& Center, float RadiusSquare);
+
+private:
+	std::vector<SNode>		m_vNodes{};
+	std::vector<uint32_t>	m_vTriangleIndices{}; // into m_vVertices (3 vertices per triangle), ordered by leaves
+	std::vector<XMVECTOR>	m_vVertices{}; // V0, V1, V2 of every triangle of the mesh
+};
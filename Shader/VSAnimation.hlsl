@@ -16,8 +16,20 @@ cbuffer cbAnimation : register(b2)
 
 Texture2D<float4> AnimationTexture : register(t0); // For GPU skinning
 
-float4x4 GetBoneMatrixFromAnimationTexture(int BoneIndex, int AnimationOffset)
+// CObject3D::EAnimationTextureLayout
+#define ANIMATION_TEXTURE_LAYOUT_MATRIX4X4 0
+
+float4x4 GetBoneMatrixFromAnimationTexture(int BoneIndex, int AnimationOffset, bool bIsPacked)
 {
+	if (bIsPacked)
+	{
+		// 3x4 affine: the first 3 columns of the bone matrix
+		float4 Column0 = AnimationTexture[int2(BoneIndex * 3 + 0, AnimationOffset)];
+		float4 Column1 = AnimationTexture[int2(BoneIndex * 3 + 1, AnimationOffset)];
+		float4 Column2 = AnimationTexture[int2(BoneIndex * 3 + 2, AnimationOffset)];
+		return transpose(float4x4(Column0, Column1, Column2, float4(0, 0, 0, 1)));
+	}
+
 	float4 Row0 = AnimationTexture[int2(BoneIndex * 4 + 0, AnimationOffset)];
 	float4 Row1 = AnimationTexture[int2(BoneIndex * 4 + 1, AnimationOffset)];
 	float4 Row2 = AnimationTexture[int2(BoneIndex * 4 + 2, AnimationOffset)];
@@ -53,8 +65,11 @@ static VS_OUTPUT Internal(in float4x4 WorldMatrix, in VS_INPUT_ANIMATION Input)
 static float4 GetGPUSkinnedPosition(float4 VertexPosition, uint AnimationID, float AnimationTick, uint4 BoneIndex, float4 BoneWeight)
 {
 	static const int KAnimationTextureReservedFirstPixelCount = 2;
-	const int KAnimationCount = AnimationTexture[int2(1, 0)].x;
-	const float4 KAnimationInfo = AnimationTexture[int2(KAnimationTextureReservedFirstPixelCount + AnimationID * 2 + 0, 0)];
+	const float4 KTextureInfo = AnimationTexture[int2(1, 0)];
+	const int KAnimationCount = KTextureInfo.x;
+	const bool bIsPacked = ((int)KTextureInfo.z != ANIMATION_TEXTURE_LAYOUT_MATRIX4X4);
+	const int KInfoPixelCount = (bIsPacked) ? 5 : 2;
+	const float4 KAnimationInfo = AnimationTexture[int2(KAnimationTextureReservedFirstPixelCount + AnimationID * KInfoPixelCount + 0, 0)];
 	int AnimationOffset = KAnimationInfo.x;
 	int AnimationDuration = KAnimationInfo.y;
 
@@ -63,16 +78,16 @@ static float4 GetGPUSkinnedPosition(float4 VertexPosition, uint AnimationID, flo
 	if (iNextTick > AnimationDuration) iNextTick = 0;
 
 	float4x4 CurrTickBone = 
-		GetBoneMatrixFromAnimationTexture(BoneIndex.x, AnimationOffset + iCurrTick) * BoneWeight.x +
-		GetBoneMatrixFromAnimationTexture(BoneIndex.y, AnimationOffset + iCurrTick) * BoneWeight.y +
-		GetBoneMatrixFromAnimationTexture(BoneIndex.z, AnimationOffset + iCurrTick) * BoneWeight.z +
-		GetBoneMatrixFromAnimationTexture(BoneIndex.w, AnimationOffset + iCurrTick) * BoneWeight.w;
+		GetBoneMatrixFromAnimationTexture(BoneIndex.x, AnimationOffset + iCurrTick, bIsPacked) * BoneWeight.x +
+		GetBoneMatrixFromAnimationTexture(BoneIndex.y, AnimationOffset + iCurrTick, bIsPacked) * BoneWeight.y +
+		GetBoneMatrixFromAnimationTexture(BoneIndex.z, AnimationOffset + iCurrTick, bIsPacked) * BoneWeight.z +
+		GetBoneMatrixFromAnimationTexture(BoneIndex.w, AnimationOffset + iCurrTick, bIsPacked) * BoneWeight.w;
 
 	float4x4 NextTickBone = 
-		GetBoneMatrixFromAnimationTexture(BoneIndex.x, AnimationOffset + iNextTick) * BoneWeight.x +
-		GetBoneMatrixFromAnimationTexture(BoneIndex.y, AnimationOffset + iNextTick) * BoneWeight.y +
-		GetBoneMatrixFromAnimationTexture(BoneIndex.z, AnimationOffset + iNextTick) * BoneWeight.z +
-		GetBoneMatrixFromAnimationTexture(BoneIndex.w, AnimationOffset + iNextTick) * BoneWeight.w;
+		GetBoneMatrixFromAnimationTexture(BoneIndex.x, AnimationOffset + iNextTick, bIsPacked) * BoneWeight.x +
+		GetBoneMatrixFromAnimationTexture(BoneIndex.y, AnimationOffset + iNextTick, bIsPacked) * BoneWeight.y +
+		GetBoneMatrixFromAnimationTexture(BoneIndex.z, AnimationOffset + iNextTick, bIsPacked) * BoneWeight.z +
+		GetBoneMatrixFromAnimationTexture(BoneIndex.w, AnimationOffset + iNextTick, bIsPacked) * BoneWeight.w;
 
 	float4 CurrTickPosition = float4(mul(VertexPosition, CurrTickBone).xyz, 1);
 	float4 NextTickPosition = float4(mul(VertexPosition, NextTickBone).xyz, 1);